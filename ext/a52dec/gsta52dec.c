@@ -65,6 +65,9 @@
 #define SAMPLE_TYPE GST_AUDIO_FORMAT_F32
 #endif
 
+#define OUTPUT_FORMATS \
+    "{ " SAMPLE_FORMAT ", " GST_AUDIO_NE(S32) ", " GST_AUDIO_NE(S16) " }"
+
 GST_DEBUG_CATEGORY_STATIC (a52dec_debug);
 #define GST_CAT_DEFAULT (a52dec_debug)
 
@@ -75,8 +78,11 @@ enum
   ARG_DRC,
   ARG_MODE,
   ARG_LFE,
+  ARG_THREADS,
 };
 
+#define DEFAULT_THREADS 1
+
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -87,7 +93,7 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
-        "format = (string) " SAMPLE_FORMAT ", "
+        "format = (string) " OUTPUT_FORMATS ", "
         "layout = (string) interleaved, "
         "rate = (int) [ 4000, 96000 ], " "channels = (int) [ 1, 6 ]")
     );
@@ -97,6 +103,7 @@ G_DEFINE_TYPE (GstA52Dec, gst_a52dec, GST_TYPE_AUDIO_DECODER);
 
 static gboolean gst_a52dec_start (GstAudioDecoder * dec);
 static gboolean gst_a52dec_stop (GstAudioDecoder * dec);
+static void gst_a52dec_flush (GstAudioDecoder * dec, gboolean hard);
 static gboolean gst_a52dec_set_format (GstAudioDecoder * bdec, GstCaps * caps);
 static GstFlowReturn gst_a52dec_parse (GstAudioDecoder * dec,
     GstAdapter * adapter, gint * offset, gint * length);
@@ -109,6 +116,7 @@ static void gst_a52dec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_a52dec_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_a52dec_finalize (GObject * object);
 
 #define GST_TYPE_A52DEC_MODE (gst_a52dec_mode_get_type())
 static GType
@@ -147,9 +155,11 @@ gst_a52dec_class_init (GstA52DecClass * klass)
 
   gobject_class->set_property = gst_a52dec_set_property;
   gobject_class->get_property = gst_a52dec_get_property;
+  gobject_class->finalize = gst_a52dec_finalize;
 
   gstbase_class->start = GST_DEBUG_FUNCPTR (gst_a52dec_start);
   gstbase_class->stop = GST_DEBUG_FUNCPTR (gst_a52dec_stop);
+  gstbase_class->flush = GST_DEBUG_FUNCPTR (gst_a52dec_flush);
   gstbase_class->set_format = GST_DEBUG_FUNCPTR (gst_a52dec_set_format);
   gstbase_class->parse = GST_DEBUG_FUNCPTR (gst_a52dec_parse);
   gstbase_class->handle_frame = GST_DEBUG_FUNCPTR (gst_a52dec_handle_frame);
@@ -185,6 +195,19 @@ gst_a52dec_class_init (GstA52DecClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_LFE,
       g_param_spec_boolean ("lfe", "LFE", "LFE", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstA52Dec::threads
+   *
+   * Number of frames to decode in parallel, each with its own liba52 state.
+   * 1 decodes sequentially, 0 uses one thread per CPU core. Parallel
+   * decoding holds back up to twice this many frames, so it is meant for
+   * offline transcoding rather than live playback. Changes take effect
+   * when the decoder is next started.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Number of frames decoded in parallel (0 = automatic)", 0, 64,
+          DEFAULT_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_static_pad_template (gstelement_class, &sink_factory);
   gst_element_class_add_static_pad_template (gstelement_class, &src_factory);
@@ -227,6 +250,11 @@ gst_a52dec_init (GstA52Dec * a52dec)
 
   a52dec->state = NULL;
   a52dec->samples = NULL;
+  a52dec->threads = DEFAULT_THREADS;
+
+  g_queue_init (&a52dec->pending);
+  g_mutex_init (&a52dec->job_lock);
+  g_cond_init (&a52dec->job_cond);
 
   gst_audio_decoder_set_use_default_pad_acceptcaps (GST_AUDIO_DECODER_CAST
       (a52dec), TRUE);
@@ -240,30 +268,62 @@ gst_a52dec_init (GstA52Dec * a52dec)
       GST_DEBUG_FUNCPTR (gst_a52dec_chain));
 }
 
-static gboolean
-gst_a52dec_start (GstAudioDecoder * dec)
+static a52_state_t *
+gst_a52dec_new_state (GstA52Dec * a52dec)
 {
-  GstA52Dec *a52dec = GST_A52DEC (dec);
   GstA52DecClass *klass;
   static GMutex init_mutex;
-
-  GST_DEBUG_OBJECT (dec, "start");
+  a52_state_t *state;
 
   klass = GST_A52DEC_CLASS (G_OBJECT_GET_CLASS (a52dec));
   g_mutex_lock (&init_mutex);
 #if defined(A52_ACCEL_DETECT)
-  a52dec->state = a52_init ();
+  state = a52_init ();
   /* This line is just to avoid being accused of not using klass */
   a52_accel (klass->a52_cpuflags & A52_ACCEL_DETECT);
 #else
-  a52dec->state = a52_init (klass->a52_cpuflags);
+  state = a52_init (klass->a52_cpuflags);
 #endif
   g_mutex_unlock (&init_mutex);
 
-  if (!a52dec->state) {
-    GST_ELEMENT_ERROR (GST_ELEMENT (a52dec), LIBRARY, INIT, (NULL),
-        ("failed to initialize a52 state"));
-    return FALSE;
+  return state;
+}
+
+static void gst_a52dec_decode_job (gpointer data, gpointer user_data);
+static void gst_a52dec_clear_jobs (GstA52Dec * a52dec);
+
+static gboolean
+gst_a52dec_start (GstAudioDecoder * dec)
+{
+  GstA52Dec *a52dec = GST_A52DEC (dec);
+  guint threads, i;
+
+  GST_DEBUG_OBJECT (dec, "start");
+
+  a52dec->state = gst_a52dec_new_state (a52dec);
+  if (!a52dec->state)
+    goto init_failed;
+
+  GST_OBJECT_LOCK (a52dec);
+  threads = a52dec->threads;
+  GST_OBJECT_UNLOCK (a52dec);
+  if (threads == 0)
+    threads = g_get_num_processors ();
+
+  if (threads > 1) {
+    GST_INFO_OBJECT (dec, "decoding with %u threads", threads);
+
+    a52dec->free_states = g_async_queue_new ();
+    for (i = 0; i < threads; i++) {
+      a52_state_t *state = gst_a52dec_new_state (a52dec);
+
+      if (!state)
+        goto init_failed;
+      g_async_queue_push (a52dec->free_states, state);
+    }
+    a52dec->pool = g_thread_pool_new (gst_a52dec_decode_job, a52dec,
+        threads, FALSE, NULL);
+    a52dec->job_format = GST_AUDIO_FORMAT_UNKNOWN;
   }
 
   a52dec->samples = a52_samples (a52dec->state);
@@ -271,14 +331,26 @@ gst_a52dec_start (GstAudioDecoder * dec)
   a52dec->sample_rate = -1;
   a52dec->stream_channels = A52_CHANNEL;
   a52dec->using_channels = A52_CHANNEL;
+  a52dec->out_channels = A52_CHANNEL;
   a52dec->level = 1;
   a52dec->bias = 0;
   a52dec->flag_update = TRUE;
+  a52dec->out_format = SAMPLE_TYPE;
+  a52dec->out_width = SAMPLE_WIDTH / 8;
 
   /* call upon legacy upstream byte support (e.g. seeking) */
   gst_audio_decoder_set_estimate_rate (dec, TRUE);
 
   return TRUE;
+
+  /* ERRORS */
+init_failed:
+  {
+    GST_ELEMENT_ERROR (GST_ELEMENT (a52dec), LIBRARY, INIT, (NULL),
+        ("failed to initialize a52 state"));
+    gst_a52dec_stop (dec);
+    return FALSE;
+  }
 }
 
 static gboolean
@@ -288,6 +360,21 @@ gst_a52dec_stop (GstAudioDecoder * dec)
 
   GST_DEBUG_OBJECT (dec, "stop");
 
+  if (a52dec->pool) {
+    /* lets queued jobs run to completion before returning */
+    g_thread_pool_free (a52dec->pool, FALSE, TRUE);
+    a52dec->pool = NULL;
+    gst_a52dec_clear_jobs (a52dec);
+  }
+  if (a52dec->free_states) {
+    a52_state_t *state;
+
+    while ((state = g_async_queue_try_pop (a52dec->free_states)))
+      a52_free (state);
+    g_async_queue_unref (a52dec->free_states);
+    a52dec->free_states = NULL;
+  }
+
   a52dec->samples = NULL;
   if (a52dec->state) {
     a52_free (a52dec->state);
@@ -297,6 +384,16 @@ gst_a52dec_stop (GstAudioDecoder * dec)
   return TRUE;
 }
 
+static void
+gst_a52dec_flush (GstAudioDecoder * dec, gboolean hard)
+{
+  GstA52Dec *a52dec = GST_A52DEC (dec);
+
+  /* the base class drops its pending frames, so drop their jobs too */
+  if (a52dec->pool)
+    gst_a52dec_clear_jobs (a52dec);
+}
+
 static GstFlowReturn
 gst_a52dec_parse (GstAudioDecoder * bdec, GstAdapter * adapter,
     gint * _offset, gint * len)
@@ -341,6 +438,120 @@ gst_a52dec_parse (GstAudioDecoder * bdec, GstAdapter * adapter,
   return result;
 }
 
+/* Interleaving of the planar a52_block () output.
+ *
+ * liba52 hands out 256 samples per channel, one channel after the other.
+ * The kernels below gather one output frame at a time from per-channel
+ * source pointers (already in output channel order), so all stores are
+ * sequential. They are instantiated per channel count so the inner loop
+ * has a constant trip count, and per output format so that integer
+ * conversion happens in the same pass.
+ *
+ * The conversions have no branches: a float compare may trap, so GCC does
+ * not if-convert it and a clamp on the float keeps the loop scalar. With
+ * GCC 12 on x86-64 the mono and stereo kernels are vectorised at -O2, the
+ * others are unrolled and only some of them are vectorised at -O3. */
+typedef void (*GstA52DecInterleaveFunc) (gpointer out,
+    const sample_t * const *src);
+
+/* adding and subtracting 1.5 * 2^mantissa bits rounds to the nearest
+ * integer in the current rounding mode, for values well below 2^22 */
+#ifdef LIBA52_DOUBLE
+#define A52DEC_ROUND_MAGIC 6755399441055744.0
+#else
+#define A52DEC_ROUND_MAGIC 12582912.0f
+#endif
+
+static inline gint16
+a52dec_sample_to_s16 (sample_t s)
+{
+  gint32 i;
+
+  /* liba52 output stays far below the range where the rounding stops
+   * working, the clamp is done on the integer */
+  i = (gint32) (s * 32768 + A52DEC_ROUND_MAGIC - A52DEC_ROUND_MAGIC);
+  i = i < G_MAXINT16 ? i : G_MAXINT16;
+  i = i > G_MININT16 ? i : G_MININT16;
+
+  return (gint16) i;
+}
+
+static inline gint32
+a52dec_sample_to_s32 (sample_t s)
+{
+  union
+  {
+    gfloat f;
+    guint32 u;
+  } v;
+  guint32 mag;
+
+  /* clamp the magnitude to the largest float below 1.0 on the bits, which
+   * also maps NaN there. The conversion truncates, for a 32 bit sample that
+   * is below the precision of the float */
+  v.f = (gfloat) s;
+  mag = v.u & 0x7fffffff;
+  mag = mag < 0x3f7fffff ? mag : 0x3f7fffff;
+  v.u = (v.u & 0x80000000) | mag;
+
+  return (gint32) (v.f * 2147483648.0f);
+}
+
+#define a52dec_sample_to_float(s) (s)
+
+#define DEFINE_INTERLEAVE(fmt,otype,chans)                              \
+static void                                                             \
+gst_a52dec_interleave_##fmt##_##chans (gpointer out,                    \
+    const sample_t * const *src)                                        \
+{                                                                       \
+  otype *o = out;                                                       \
+  gint n, c;                                                            \
+                                                                        \
+  for (n = 0; n < 256; n++) {                                           \
+    for (c = 0; c < chans; c++)                                         \
+      o[c] = a52dec_sample_to_##fmt (src[c][n]);                        \
+    o += chans;                                                         \
+  }                                                                     \
+}
+
+#define DEFINE_INTERLEAVE_FORMAT(fmt,otype)                             \
+DEFINE_INTERLEAVE (fmt, otype, 1)                                       \
+DEFINE_INTERLEAVE (fmt, otype, 2)                                       \
+DEFINE_INTERLEAVE (fmt, otype, 3)                                       \
+DEFINE_INTERLEAVE (fmt, otype, 4)                                       \
+DEFINE_INTERLEAVE (fmt, otype, 5)                                       \
+DEFINE_INTERLEAVE (fmt, otype, 6)                                       \
+static const GstA52DecInterleaveFunc interleave_##fmt[6] = {            \
+  gst_a52dec_interleave_##fmt##_1,                                      \
+  gst_a52dec_interleave_##fmt##_2,                                      \
+  gst_a52dec_interleave_##fmt##_3,                                      \
+  gst_a52dec_interleave_##fmt##_4,                                      \
+  gst_a52dec_interleave_##fmt##_5,                                      \
+  gst_a52dec_interleave_##fmt##_6,                                      \
+};
+
+DEFINE_INTERLEAVE_FORMAT (float, sample_t)
+DEFINE_INTERLEAVE_FORMAT (s16, gint16)
+DEFINE_INTERLEAVE_FORMAT (s32, gint32)
+
+#undef DEFINE_INTERLEAVE_FORMAT
+#undef DEFINE_INTERLEAVE
+
+static GstA52DecInterleaveFunc
+gst_a52dec_get_interleave_func (GstAudioFormat format, gint chans)
+{
+  g_return_val_if_fail (chans >= 1 && chans <= 6, NULL);
+
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:
+      return interleave_s16[chans - 1];
+    case GST_AUDIO_FORMAT_S32:
+      return interleave_s32[chans - 1];
+    default:
+      return interleave_float[chans - 1];
+  }
+}
+
 static gint
 gst_a52dec_channels (int flags, GstAudioChannelPosition * pos)
 {
@@ -421,34 +632,85 @@ gst_a52dec_channels (int flags, GstAudioChannelPosition * pos)
   return chans;
 }
 
+/* Pick the output sample format preferred by downstream. The decoder
+ * natively produces SAMPLE_TYPE, the integer formats are only used when
+ * downstream would otherwise need an extra conversion element. */
+static GstAudioFormat
+gst_a52dec_choose_format (GstA52Dec * a52dec)
+{
+  GstAudioFormat format = SAMPLE_TYPE;
+  GstCaps *caps;
+
+  caps = gst_pad_get_allowed_caps (GST_AUDIO_DECODER_SRC_PAD (a52dec));
+  if (caps && gst_caps_get_size (caps) > 0) {
+    GstCaps *copy = gst_caps_copy_nth (caps, 0);
+    GstStructure *structure = gst_caps_get_structure (copy, 0);
+    const gchar *str;
+
+    gst_structure_fixate_field_string (structure, "format", SAMPLE_FORMAT);
+    str = gst_structure_get_string (structure, "format");
+    if (str) {
+      format = gst_audio_format_from_string (str);
+      if (format != GST_AUDIO_FORMAT_S16 && format != GST_AUDIO_FORMAT_S32)
+        format = SAMPLE_TYPE;
+    }
+    gst_caps_unref (copy);
+  }
+  if (caps)
+    gst_caps_unref (caps);
+
+  return format;
+}
+
+/* Fills in the output channel positions and the map from liba52 channel
+ * order to output order for the given channel flags. Returns the number
+ * of channels, 0 for invalid flags. */
+static gint
+gst_a52dec_channel_layout (gint flags, GstAudioChannelPosition * to,
+    gint * reorder_map)
+{
+  GstAudioChannelPosition from[6];
+  gint channels;
+
+  channels = gst_a52dec_channels (flags, from);
+  if (!channels)
+    return 0;
+
+  memcpy (to, from, sizeof (GstAudioChannelPosition) * channels);
+  gst_audio_channel_positions_to_valid_order (to, channels);
+  gst_audio_get_channel_reorder_map (channels, from, to, reorder_map);
+
+  return channels;
+}
+
 static gboolean
-gst_a52dec_reneg (GstA52Dec * a52dec)
+gst_a52dec_reneg (GstA52Dec * a52dec, gint flags, GstAudioFormat format)
 {
   gint channels;
   gboolean result = FALSE;
-  GstAudioChannelPosition from[6], to[6];
+  GstAudioChannelPosition to[6];
   GstAudioInfo info;
 
-  channels = gst_a52dec_channels (a52dec->using_channels, from);
+  channels = gst_a52dec_channel_layout (flags, to,
+      a52dec->channel_reorder_map);
 
   if (!channels)
     goto done;
 
-  GST_INFO_OBJECT (a52dec, "reneg channels:%d rate:%d",
-      channels, a52dec->sample_rate);
-
-  memcpy (to, from, sizeof (GstAudioChannelPosition) * channels);
-  gst_audio_channel_positions_to_valid_order (to, channels);
-  gst_audio_get_channel_reorder_map (channels, from, to,
-      a52dec->channel_reorder_map);
+  GST_INFO_OBJECT (a52dec, "reneg channels:%d rate:%d format:%s",
+      channels, a52dec->sample_rate, gst_audio_format_to_string (format));
 
   gst_audio_info_init (&info);
   gst_audio_info_set_format (&info,
-      SAMPLE_TYPE, a52dec->sample_rate, channels, (channels > 1 ? to : NULL));
+      format, a52dec->sample_rate, channels, (channels > 1 ? to : NULL));
 
   if (!gst_audio_decoder_set_output_format (GST_AUDIO_DECODER (a52dec), &info))
     goto done;
 
+  a52dec->out_channels = flags;
+  a52dec->out_format = format;
+  a52dec->out_width = GST_AUDIO_INFO_WIDTH (&info) / 8;
+
   result = TRUE;
 
 done:
@@ -469,6 +731,245 @@ gst_a52dec_update_streaminfo (GstA52Dec * a52dec)
   gst_tag_list_unref (taglist);
 }
 
+/* Parallel decoding.
+ *
+ * AC-3 frames carry their own exponents and bit allocation, the only state
+ * shared between frames is the IMDCT overlap of the last block. Each job
+ * therefore first decodes the preceding frame on its own liba52 state and
+ * discards the output, then decodes its frame. This doubles the work per
+ * frame but lets any number of frames be decoded at the same time. Jobs
+ * are finished in submission order by the streaming thread. */
+typedef struct
+{
+  GstBuffer *prime;
+  GstBuffer *frame;
+  gint sample_rate;
+  gint flags;
+  GstAudioFormat format;
+  gboolean drc;
+
+  /* filled in by the worker */
+  gboolean done;
+  gint error_block;
+  GstBuffer *outbuf;
+} GstA52DecJob;
+
+static void
+gst_a52dec_job_free (GstA52DecJob * job)
+{
+  if (job->prime)
+    gst_buffer_unref (job->prime);
+  gst_buffer_unref (job->frame);
+  if (job->outbuf)
+    gst_buffer_unref (job->outbuf);
+  g_slice_free (GstA52DecJob, job);
+}
+
+static gboolean
+gst_a52dec_decode_buffer (a52_state_t * state, GstBuffer * buffer,
+    gint * flags, gboolean drc)
+{
+  GstMapInfo map;
+  sample_t level = 1;
+  gboolean ret;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  ret = a52_frame (state, map.data, flags, &level, 0) == 0;
+  gst_buffer_unmap (buffer, &map);
+
+  if (ret && !drc)
+    a52_dynrng (state, NULL, NULL);
+
+  return ret;
+}
+
+static void
+gst_a52dec_decode_job (gpointer data, gpointer user_data)
+{
+  GstA52DecJob *job = data;
+  GstA52Dec *a52dec = user_data;
+  a52_state_t *state;
+  sample_t *samples;
+  GstA52DecInterleaveFunc interleave;
+  GstAudioChannelPosition pos[6];
+  gint reorder_map[6];
+  const sample_t *src[6];
+  GstMapInfo map;
+  gint flags, chans, width, c, i;
+
+  state = g_async_queue_pop (a52dec->free_states);
+  samples = a52_samples (state);
+
+  /* restore the overlap state left behind by the previous frame */
+  if (job->prime) {
+    flags = job->flags | A52_ADJUST_LEVEL;
+    if (gst_a52dec_decode_buffer (state, job->prime, &flags, job->drc)) {
+      for (i = 0; i < 6; i++)
+        if (a52_block (state))
+          break;
+    }
+  }
+
+  flags = job->flags | A52_ADJUST_LEVEL;
+  if (!gst_a52dec_decode_buffer (state, job->frame, &flags, job->drc)) {
+    job->error_block = -1;
+    goto done;
+  }
+
+  job->flags = flags & (A52_CHANNEL_MASK | A52_LFE);
+  chans = gst_a52dec_channel_layout (job->flags, pos, reorder_map);
+  if (!chans) {
+    job->error_block = -1;
+    goto done;
+  }
+
+  interleave = gst_a52dec_get_interleave_func (job->format, chans);
+  for (c = 0; c < chans; c++)
+    src[reorder_map[c]] = samples + c * 256;
+
+  width =
+      GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info (job->format)) / 8;
+  job->outbuf = gst_buffer_new_and_alloc (256 * chans * width * 6);
+
+  gst_buffer_map (job->outbuf, &map, GST_MAP_WRITE);
+  for (i = 0; i < 6; i++) {
+    if (a52_block (state)) {
+      job->error_block = i;
+      break;
+    }
+    interleave (map.data + i * 256 * chans * width, src);
+  }
+  gst_buffer_unmap (job->outbuf, &map);
+
+done:
+  g_async_queue_push (a52dec->free_states, state);
+
+  g_mutex_lock (&a52dec->job_lock);
+  job->done = TRUE;
+  g_cond_broadcast (&a52dec->job_cond);
+  g_mutex_unlock (&a52dec->job_lock);
+}
+
+/* Waits for all queued jobs and discards them */
+static void
+gst_a52dec_clear_jobs (GstA52Dec * a52dec)
+{
+  GstA52DecJob *job;
+
+  g_mutex_lock (&a52dec->job_lock);
+  while ((job = g_queue_pop_head (&a52dec->pending))) {
+    while (!job->done)
+      g_cond_wait (&a52dec->job_cond, &a52dec->job_lock);
+    gst_a52dec_job_free (job);
+  }
+  g_mutex_unlock (&a52dec->job_lock);
+
+  gst_buffer_replace (&a52dec->prev_frame, NULL);
+}
+
+static GstFlowReturn
+gst_a52dec_finish_job (GstA52Dec * a52dec, GstA52DecJob * job)
+{
+  GstAudioDecoder *bdec = GST_AUDIO_DECODER (a52dec);
+  GstAudioInfo *info;
+  GstBuffer *outbuf;
+  GstFlowReturn result = GST_FLOW_OK;
+
+  if (job->error_block == -1) {
+    GST_AUDIO_DECODER_ERROR (a52dec, 1, STREAM, DECODE, (NULL),
+        ("a52_frame error"), result);
+    if (result == GST_FLOW_OK)
+      result = gst_audio_decoder_finish_frame (bdec, NULL, 1);
+    return result;
+  } else if (job->error_block >= 0) {
+    GST_AUDIO_DECODER_ERROR (a52dec, 1, STREAM, DECODE, (NULL),
+        ("error decoding block %d", job->error_block), result);
+    if (result != GST_FLOW_OK)
+      return result;
+  }
+
+  info = gst_audio_decoder_get_audio_info (bdec);
+  if (a52dec->out_channels != job->flags ||
+      a52dec->out_format != job->format ||
+      GST_AUDIO_INFO_RATE (info) != job->sample_rate) {
+    a52dec->sample_rate = job->sample_rate;
+    if (!gst_a52dec_reneg (a52dec, job->flags, job->format)) {
+      GST_ELEMENT_ERROR (a52dec, CORE, NEGOTIATION, (NULL), (NULL));
+      return GST_FLOW_ERROR;
+    }
+  }
+
+  outbuf = job->outbuf;
+  job->outbuf = NULL;
+
+  return gst_audio_decoder_finish_frame (bdec, outbuf, 1);
+}
+
+/* Finishes completed jobs in order. With @wait, blocks until the number of
+ * outstanding jobs is at most @max_pending. */
+static GstFlowReturn
+gst_a52dec_push_jobs (GstA52Dec * a52dec, gboolean wait, guint max_pending)
+{
+  GstA52DecJob *job;
+  GstFlowReturn result = GST_FLOW_OK;
+
+  g_mutex_lock (&a52dec->job_lock);
+  while (result == GST_FLOW_OK && (job = g_queue_peek_head (&a52dec->pending))) {
+    if (!job->done) {
+      if (!wait || a52dec->pending.length <= max_pending)
+        break;
+      g_cond_wait (&a52dec->job_cond, &a52dec->job_lock);
+      continue;
+    }
+    g_queue_pop_head (&a52dec->pending);
+    g_mutex_unlock (&a52dec->job_lock);
+
+    result = gst_a52dec_finish_job (a52dec, job);
+    gst_a52dec_job_free (job);
+
+    g_mutex_lock (&a52dec->job_lock);
+  }
+  g_mutex_unlock (&a52dec->job_lock);
+
+  return result;
+}
+
+static GstFlowReturn
+gst_a52dec_queue_frame (GstA52Dec * a52dec, GstBuffer * buffer, gint flags,
+    gint sample_rate)
+{
+  GstA52DecJob *job;
+  guint max_threads;
+
+  if (a52dec->job_format == GST_AUDIO_FORMAT_UNKNOWN)
+    a52dec->job_format = gst_a52dec_choose_format (a52dec);
+
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT))
+    gst_buffer_replace (&a52dec->prev_frame, NULL);
+
+  job = g_slice_new0 (GstA52DecJob);
+  job->prime = a52dec->prev_frame;
+  job->frame = gst_buffer_ref (buffer);
+  job->sample_rate = sample_rate;
+  job->flags = flags;
+  job->format = a52dec->job_format;
+  GST_OBJECT_LOCK (a52dec);
+  job->drc = a52dec->dynamic_range_compression;
+  GST_OBJECT_UNLOCK (a52dec);
+
+  a52dec->prev_frame = gst_buffer_ref (buffer);
+
+  g_mutex_lock (&a52dec->job_lock);
+  g_queue_push_tail (&a52dec->pending, job);
+  g_mutex_unlock (&a52dec->job_lock);
+
+  g_thread_pool_push (a52dec->pool, job, NULL);
+
+  /* keep at most two frames per thread in flight */
+  max_threads = g_thread_pool_get_max_threads (a52dec->pool);
+  return gst_a52dec_push_jobs (a52dec, TRUE, 2 * max_threads);
+}
+
 static GstFlowReturn
 gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
 {
@@ -481,12 +982,18 @@ gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
   GstFlowReturn result = GST_FLOW_OK;
   GstBuffer *outbuf;
   const gint num_blocks = 6;
+  const sample_t *src[6];
+  GstA52DecInterleaveFunc interleave;
+  gint c, block_size;
 
   a52dec = GST_A52DEC (bdec);
 
-  /* no fancy draining */
-  if (G_UNLIKELY (!buffer))
+  /* no fancy draining, other than waiting for parallel decoding */
+  if (G_UNLIKELY (!buffer)) {
+    if (a52dec->pool)
+      return gst_a52dec_push_jobs (a52dec, TRUE, 0);
     return GST_FLOW_OK;
+  }
 
   /* parsed stuff already, so this should work out fine */
   gst_buffer_map (buffer, &map, GST_MAP_READ);
@@ -575,6 +1082,22 @@ gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
     flags = a52dec->using_channels;
   }
 
+  if (a52dec->pool) {
+    gint out_flags = flags | A52_ADJUST_LEVEL;
+    sample_t level = 1;
+
+    /* resolve the downmix here like the sequential path does, so later frames
+     * request the layout chosen for this one; a52_frame() only parses the
+     * header. A broken frame keeps its flags and fails in its job, in order. */
+    if (!a52_frame (a52dec->state, map.data, &out_flags, &level,
+            a52dec->bias)) {
+      flags = out_flags & (A52_CHANNEL_MASK | A52_LFE);
+      a52dec->using_channels = flags;
+    }
+    gst_buffer_unmap (buffer, &map);
+    return gst_a52dec_queue_frame (a52dec, buffer, flags, sample_rate);
+  }
+
   /* process */
   flags |= A52_ADJUST_LEVEL;
   a52dec->level = 1;
@@ -597,7 +1120,8 @@ gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
     GST_DEBUG_OBJECT (a52dec,
         "a52dec reneg: sample_rate:%d stream_chans:%d using_chans:%d",
         a52dec->sample_rate, a52dec->stream_channels, a52dec->using_channels);
-    if (!gst_a52dec_reneg (a52dec))
+    if (!gst_a52dec_reneg (a52dec, a52dec->using_channels,
+            gst_a52dec_choose_format (a52dec)))
       goto failed_negotiation;
   }
 
@@ -610,10 +1134,14 @@ gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
   if (!chans)
     goto invalid_flags;
 
+  interleave = gst_a52dec_get_interleave_func (a52dec->out_format, chans);
+  for (c = 0; c < chans; c++)
+    src[a52dec->channel_reorder_map[c]] = a52dec->samples + c * 256;
+
   /* handle decoded data;
    * each frame has 6 blocks, one block is 256 samples, ea */
-  outbuf =
-      gst_buffer_new_and_alloc (256 * chans * (SAMPLE_WIDTH / 8) * num_blocks);
+  block_size = 256 * chans * a52dec->out_width;
+  outbuf = gst_buffer_new_and_alloc (block_size * num_blocks);
 
   gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
   {
@@ -629,17 +1157,9 @@ gst_a52dec_handle_frame (GstAudioDecoder * bdec, GstBuffer * buffer)
           goto exit;
         }
       } else {
-        gint n, c;
-        gint *reorder_map = a52dec->channel_reorder_map;
-
-        for (n = 0; n < 256; n++) {
-          for (c = 0; c < chans; c++) {
-            ((sample_t *) ptr)[n * chans + reorder_map[c]] =
-                a52dec->samples[c * 256 + n];
-          }
-        }
+        interleave (ptr, src);
       }
-      ptr += 256 * chans * (SAMPLE_WIDTH / 8);
+      ptr += block_size;
     }
   }
   gst_buffer_unmap (outbuf, &map);
@@ -785,6 +1305,11 @@ gst_a52dec_set_property (GObject * object, guint prop_id, const GValue * value,
       src->request_channels |= g_value_get_boolean (value) ? A52_LFE : 0;
       GST_OBJECT_UNLOCK (src);
       break;
+    case ARG_THREADS:
+      GST_OBJECT_LOCK (src);
+      src->threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -813,12 +1338,28 @@ gst_a52dec_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_boolean (value, src->request_channels & A52_LFE);
       GST_OBJECT_UNLOCK (src);
       break;
+    case ARG_THREADS:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->threads);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_a52dec_finalize (GObject * object)
+{
+  GstA52Dec *a52dec = GST_A52DEC (object);
+
+  g_mutex_clear (&a52dec->job_lock);
+  g_cond_clear (&a52dec->job_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
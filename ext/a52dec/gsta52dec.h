@@ -59,11 +59,27 @@ struct _GstA52Dec {
 
   gint           channel_reorder_map[6];
 
+  /* negotiated output layout and sample format, converted while
+   * interleaving */
+  gint           out_channels;
+  GstAudioFormat out_format;
+  gint           out_width;
+
   sample_t       level;
   sample_t       bias;
   gboolean       dynamic_range_compression;
   sample_t      *samples;
   a52_state_t   *state;
+
+  /* parallel (offline) decoding, see the threads property */
+  guint          threads;
+  GThreadPool   *pool;
+  GAsyncQueue   *free_states;
+  GQueue         pending;
+  GMutex         job_lock;
+  GCond          job_cond;
+  GstBuffer     *prev_frame;
+  GstAudioFormat job_format;
 };
 
 struct _GstA52DecClass {
@@ -87,12 +87,30 @@
 
 #define SAMPLES_PER_SECTOR (CDIO_CD_FRAMESIZE_RAW / sizeof (gint16))
 
-#define DEFAULT_READ_SPEED   -1
+#define DEFAULT_READ_SPEED        -1
+#define DEFAULT_SECTORS_PER_READ  16
+#define DEFAULT_READ_AHEAD        TRUE
 
 enum
 {
   PROP_0 = 0,
-  PROP_READ_SPEED
+  PROP_READ_SPEED,
+  PROP_SECTORS_PER_READ,
+  PROP_READ_AHEAD
+};
+
+/* A run of consecutive sectors read with a single cdio call into a pooled
+ * buffer. The buffer stays mapped for the lifetime of the block, and the
+ * per-sector buffers handed out to the base class wrap that mapping and
+ * keep the block alive, so the buffer only goes back to the pool once
+ * all of its sectors have been consumed downstream. */
+struct _GstCdioCddaBlock
+{
+  gint refcount;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint start;
+  gint n_sectors;
 };
 
 G_DEFINE_TYPE (GstCdioCddaSrc, gst_cdio_cdda_src, GST_TYPE_AUDIO_CD_SRC);
@@ -167,27 +185,144 @@ empty_devices:
 }
 #endif
 
+static GstCdioCddaBlock *
+gst_cdio_cdda_block_ref (GstCdioCddaBlock * block)
+{
+  g_atomic_int_inc (&block->refcount);
+  return block;
+}
+
+static void
+gst_cdio_cdda_block_unref (GstCdioCddaBlock * block)
+{
+  if (g_atomic_int_dec_and_test (&block->refcount)) {
+    gst_buffer_unmap (block->buffer, &block->map);
+    gst_buffer_unref (block->buffer);
+    g_slice_free (GstCdioCddaBlock, block);
+  }
+}
+
+static inline gboolean
+gst_cdio_cdda_block_has_sector (GstCdioCddaBlock * block, gint sector)
+{
+  return block != NULL && sector >= block->start &&
+      sector < block->start + block->n_sectors;
+}
+
+/* Swaps the bytes of all 16-bit samples, four samples at a time. The
+ * constant masks let the compiler turn this into vector shifts. */
+static void
+gst_cdio_cdda_src_swap_samples (guint8 * data, gsize size)
+{
+  gsize i;
+
+  g_assert (size % sizeof (guint64) == 0);
+
+  for (i = 0; i < size; i += sizeof (guint64)) {
+    guint64 v;
+
+    memcpy (&v, data + i, sizeof (v));
+    v = ((v & G_GUINT64_CONSTANT (0x00ff00ff00ff00ff)) << 8) |
+        ((v >> 8) & G_GUINT64_CONSTANT (0x00ff00ff00ff00ff));
+    memcpy (data + i, &v, sizeof (v));
+  }
+}
+
+/* Reads up to sectors-per-read sectors starting at @sector with a single
+ * cdio call. Must not be called concurrently, see read_sector(). */
+static GstCdioCddaBlock *
+gst_cdio_cdda_src_read_block (GstCdioCddaSrc * src, gint sector)
+{
+  GstCdioCddaBlock *block;
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+  gint n_sectors;
+
+  n_sectors = MIN (g_atomic_int_get (&src->sectors_per_read),
+      src->last_sector - sector + 1);
+  if (n_sectors <= 0)
+    return NULL;
+
+  if (gst_buffer_pool_acquire_buffer (src->pool, &buffer, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READWRITE)) {
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+
+  /* the pool may have been configured for a different block size */
+  n_sectors = MIN (n_sectors, map.size / CDIO_CD_FRAMESIZE_RAW);
+
+  if (cdio_read_audio_sectors (src->cdio, map.data, sector, n_sectors) != 0) {
+    GST_DEBUG_OBJECT (src, "read of %d sectors at %d failed", n_sectors,
+        sector);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+
+  if (src->swap_le_be)
+    gst_cdio_cdda_src_swap_samples (map.data,
+        n_sectors * CDIO_CD_FRAMESIZE_RAW);
+
+  GST_LOG_OBJECT (src, "read %d sectors at %d", n_sectors, sector);
+
+  block = g_slice_new (GstCdioCddaBlock);
+  block->refcount = 1;
+  block->buffer = buffer;
+  block->map = map;
+  block->start = sector;
+  block->n_sectors = n_sectors;
+
+  return block;
+}
+
+static gpointer
+gst_cdio_cdda_src_read_ahead_func (gpointer data)
+{
+  GstCdioCddaSrc *src = data;
+
+  g_mutex_lock (&src->lock);
+  while (!src->thread_stop) {
+    GstCdioCddaBlock *block;
+    gint sector;
+
+    if (src->ahead_request < 0) {
+      g_cond_wait (&src->cond, &src->lock);
+      continue;
+    }
+
+    sector = src->ahead_request;
+    g_mutex_unlock (&src->lock);
+
+    block = gst_cdio_cdda_src_read_block (src, sector);
+
+    g_mutex_lock (&src->lock);
+    if (src->ahead)
+      gst_cdio_cdda_block_unref (src->ahead);
+    src->ahead = block;
+    src->ahead_request = -1;
+    g_cond_broadcast (&src->cond);
+  }
+  g_mutex_unlock (&src->lock);
+
+  return NULL;
+}
+
 static GstBuffer *
-gst_cdio_cdda_src_read_sector (GstAudioCdSrc * audiocdsrc, gint sector)
+gst_cdio_cdda_src_read_single_sector (GstCdioCddaSrc * src, gint sector)
 {
-  GstCdioCddaSrc *src;
   guint8 *data;
 
-  src = GST_CDIO_CDDA_SRC (audiocdsrc);
-
   data = g_malloc (CDIO_CD_FRAMESIZE_RAW);
 
   /* can't use pad_alloc because we can't return the GstFlowReturn (FIXME 0.11) */
   if (cdio_read_audio_sector (src->cdio, data, sector) != 0)
     goto read_failed;
 
-  if (src->swap_le_be) {
-    gint16 *pcm_data = (gint16 *) data;
-    gint i;
-
-    for (i = 0; i < SAMPLES_PER_SECTOR; ++i)
-      pcm_data[i] = GUINT16_SWAP_LE_BE (pcm_data[i]);
-  }
+  if (src->swap_le_be)
+    gst_cdio_cdda_src_swap_samples (data, CDIO_CD_FRAMESIZE_RAW);
 
   return gst_buffer_new_wrapped (data, CDIO_CD_FRAMESIZE_RAW);
 
@@ -204,6 +339,109 @@ read_failed:
   }
 }
 
+static GstBuffer *
+gst_cdio_cdda_src_read_sector (GstAudioCdSrc * audiocdsrc, gint sector)
+{
+  GstCdioCddaSrc *src;
+  GstCdioCddaBlock *block;
+
+  src = GST_CDIO_CDDA_SRC (audiocdsrc);
+
+  if (!gst_cdio_cdda_block_has_sector (src->block, sector)) {
+    if (src->block) {
+      gst_cdio_cdda_block_unref (src->block);
+      src->block = NULL;
+    }
+
+    /* never touch the drive while the read-ahead thread is using it */
+    g_mutex_lock (&src->lock);
+    while (src->ahead_request >= 0)
+      g_cond_wait (&src->cond, &src->lock);
+
+    if (gst_cdio_cdda_block_has_sector (src->ahead, sector)) {
+      src->block = src->ahead;
+    } else {
+      if (src->ahead) {
+        GST_DEBUG_OBJECT (src, "discarding read-ahead at sector %d",
+            src->ahead->start);
+        gst_cdio_cdda_block_unref (src->ahead);
+      }
+      src->block = gst_cdio_cdda_src_read_block (src, sector);
+    }
+    src->ahead = NULL;
+
+    if (src->block && src->thread && g_atomic_int_get (&src->read_ahead)) {
+      src->ahead_request = src->block->start + src->block->n_sectors;
+      if (src->ahead_request > src->last_sector)
+        src->ahead_request = -1;
+      g_cond_signal (&src->cond);
+    }
+    g_mutex_unlock (&src->lock);
+
+    /* a batched read can fail on a bad sector anywhere in the batch, retry
+     * just the requested sector to get the same behaviour as before */
+    if (src->block == NULL)
+      return gst_cdio_cdda_src_read_single_sector (src, sector);
+  }
+
+  block = src->block;
+  return gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      block->map.data + (sector - block->start) * CDIO_CD_FRAMESIZE_RAW,
+      CDIO_CD_FRAMESIZE_RAW, 0, CDIO_CD_FRAMESIZE_RAW,
+      gst_cdio_cdda_block_ref (block),
+      (GDestroyNotify) gst_cdio_cdda_block_unref);
+}
+
+static void
+gst_cdio_cdda_src_start_reading (GstCdioCddaSrc * src)
+{
+  GstStructure *config;
+  guint size;
+
+  size = g_atomic_int_get (&src->sectors_per_read) * CDIO_CD_FRAMESIZE_RAW;
+
+  src->pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (src->pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, 2, 0);
+  gst_buffer_pool_set_config (src->pool, config);
+  gst_buffer_pool_set_active (src->pool, TRUE);
+
+  src->ahead_request = -1;
+  src->thread_stop = FALSE;
+  src->thread = g_thread_new ("cdiocddasrc-read-ahead",
+      gst_cdio_cdda_src_read_ahead_func, src);
+}
+
+static void
+gst_cdio_cdda_src_stop_reading (GstCdioCddaSrc * src)
+{
+  if (src->thread) {
+    g_mutex_lock (&src->lock);
+    src->thread_stop = TRUE;
+    g_cond_signal (&src->cond);
+    g_mutex_unlock (&src->lock);
+    g_thread_join (src->thread);
+    src->thread = NULL;
+  }
+
+  if (src->ahead) {
+    gst_cdio_cdda_block_unref (src->ahead);
+    src->ahead = NULL;
+  }
+  if (src->block) {
+    gst_cdio_cdda_block_unref (src->block);
+    src->block = NULL;
+  }
+
+  /* blocks still referenced downstream keep their buffers, those will be
+   * freed instead of released once the pool is inactive */
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+}
+
 static gboolean
 gst_cdio_cdda_src_do_detect_drive_endianness (GstCdioCddaSrc * src, gint from,
     gint to)
@@ -397,6 +635,9 @@ gst_cdio_cdda_src_open (GstAudioCdSrc * audiocdsrc, const gchar * device)
   gst_cdio_cdda_src_detect_drive_endianness (src, first_audio_sector,
       last_audio_sector);
 
+  src->last_sector = last_audio_sector;
+  gst_cdio_cdda_src_start_reading (src);
+
   return TRUE;
 
   /* ERRORS */
@@ -423,6 +664,8 @@ gst_cdio_cdda_src_close (GstAudioCdSrc * audiocdsrc)
 {
   GstCdioCddaSrc *src = GST_CDIO_CDDA_SRC (audiocdsrc);
 
+  gst_cdio_cdda_src_stop_reading (src);
+
   if (src->cdio) {
     cdio_destroy (src->cdio);
     src->cdio = NULL;
@@ -433,7 +676,13 @@ static void
 gst_cdio_cdda_src_init (GstCdioCddaSrc * src)
 {
   src->read_speed = DEFAULT_READ_SPEED; /* don't need atomic access here */
+  src->sectors_per_read = DEFAULT_SECTORS_PER_READ;
+  src->read_ahead = DEFAULT_READ_AHEAD;
   src->cdio = NULL;
+
+  g_mutex_init (&src->lock);
+  g_cond_init (&src->cond);
+  src->ahead_request = -1;
 }
 
 static void
@@ -441,11 +690,16 @@ gst_cdio_cdda_src_finalize (GObject * obj)
 {
   GstCdioCddaSrc *src = GST_CDIO_CDDA_SRC (obj);
 
+  gst_cdio_cdda_src_stop_reading (src);
+
   if (src->cdio) {
     cdio_destroy (src->cdio);
     src->cdio = NULL;
   }
 
+  g_mutex_clear (&src->lock);
+  g_cond_clear (&src->cond);
+
   G_OBJECT_CLASS (gst_cdio_cdda_src_parent_class)->finalize (obj);
 }
 
@@ -473,6 +727,30 @@ gst_cdio_cdda_src_class_init (GstCdioCddaSrcClass * klass)
           "Read from device at the specified speed (-1 = default)", -1, 100,
           DEFAULT_READ_SPEED, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstCdioCddaSrc:sectors-per-read:
+   *
+   * Number of sectors fetched from the drive with a single read. Larger
+   * values mean fewer round trips to the drive. Takes effect the next time
+   * the device is opened.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_SECTORS_PER_READ, g_param_spec_int ("sectors-per-read",
+          "Sectors per read", "Number of sectors to read at once", 1, 64,
+          DEFAULT_SECTORS_PER_READ,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstCdioCddaSrc:read-ahead:
+   *
+   * Read the next block of sectors in a separate thread while the current
+   * one is being processed, so the drive keeps streaming.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_READ_AHEAD,
+      g_param_spec_boolean ("read-ahead", "Read ahead",
+          "Read the next sectors in the background", DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "CD audio source (CDDA)", "Source/File",
       "Read audio from CD using libcdio",
@@ -493,6 +771,12 @@ gst_cdio_cdda_src_set_property (GObject * object, guint prop_id,
       g_atomic_int_set (&src->read_speed, speed);
       break;
     }
+    case PROP_SECTORS_PER_READ:
+      g_atomic_int_set (&src->sectors_per_read, g_value_get_int (value));
+      break;
+    case PROP_READ_AHEAD:
+      g_atomic_int_set (&src->read_ahead, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -513,6 +797,12 @@ gst_cdio_cdda_src_get_property (GObject * object, guint prop_id,
       g_value_set_int (value, speed);
       break;
     }
+    case PROP_SECTORS_PER_READ:
+      g_value_set_int (value, g_atomic_int_get (&src->sectors_per_read));
+      break;
+    case PROP_READ_AHEAD:
+      g_value_set_boolean (value, g_atomic_int_get (&src->read_ahead));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -31,6 +31,7 @@
 
 typedef struct _GstCdioCddaSrc GstCdioCddaSrc;
 typedef struct _GstCdioCddaSrcClass GstCdioCddaSrcClass;
+typedef struct _GstCdioCddaBlock GstCdioCddaBlock;
 
 struct _GstCdioCddaSrc
 {
@@ -41,6 +42,22 @@ struct _GstCdioCddaSrc
   gboolean       swap_le_be;    /* Drive produces samples in other endianness */
 
   CdIo          *cdio;          /* NULL if not open */
+
+  gint           sectors_per_read;  /* ATOMIC */
+  gboolean       read_ahead;        /* ATOMIC */
+
+  /* batched reads, only valid while open */
+  gint           last_sector;
+  GstBufferPool *pool;
+  GstCdioCddaBlock *block;      /* block sectors are currently handed out from */
+
+  /* read-ahead thread, protected by lock */
+  GThread       *thread;
+  GMutex         lock;
+  GCond          cond;
+  gboolean       thread_stop;
+  gint           ahead_request; /* first sector to read ahead, -1 if none */
+  GstCdioCddaBlock *ahead;      /* result of the last read-ahead */
 };
 
 struct _GstCdioCddaSrcClass
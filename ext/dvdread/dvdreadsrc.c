@@ -47,9 +47,35 @@ enum
   ARG_DEVICE,
   ARG_TITLE,
   ARG_CHAPTER,
-  ARG_ANGLE
+  ARG_ANGLE,
+  ARG_READ_AHEAD
 };
 
+#define DEFAULT_READ_AHEAD  4
+
+/* a VOBU is always less than 1024 blocks (see gst_dvd_read_src_read) */
+#define MAX_VOBU_BLOCKS     1024
+#define NAV_SCAN_BLOCKS     32
+#define MAX_NAV_SCAN        2000
+
+/* time map entry of the current title, see build_time_index() */
+typedef struct
+{
+  guint sector;
+  GstClockTime time;
+  gboolean discont;             /* no interpolation from the previous entry */
+} GstDvdReadIndexEntry;
+
+/* result of one read, queued by the read-ahead thread */
+typedef struct
+{
+  gint ret;                     /* GstDvdReadReturn */
+  GstBuffer *buf;
+  GstEvent *clut_event;         /* to be pushed before buf */
+  gint pack;
+  gint chapter;
+} GstDvdReadItem;
+
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -88,6 +114,7 @@ static GstClockTime gst_dvd_read_src_get_time_for_sector (GstDvdReadSrc * src,
     guint sector);
 static gint gst_dvd_read_src_get_sector_from_time (GstDvdReadSrc * src,
     GstClockTime ts);
+static void gst_dvd_read_src_pause_read_ahead (GstDvdReadSrc * src);
 
 static void gst_dvd_read_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -104,6 +131,9 @@ gst_dvd_read_src_finalize (GObject * object)
 
   g_free (src->location);
 
+  g_mutex_clear (&src->ra_lock);
+  g_cond_clear (&src->ra_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -127,6 +157,11 @@ gst_dvd_read_src_init (GstDvdReadSrc * src)
   src->title_lang_event_pending = NULL;
   src->pending_clut_event = NULL;
 
+  src->read_ahead = DEFAULT_READ_AHEAD;
+  g_mutex_init (&src->ra_lock);
+  g_cond_init (&src->ra_cond);
+  g_queue_init (&src->ra_queue);
+
   gst_pad_use_fixed_caps (GST_BASE_SRC_PAD (src));
   gst_pad_set_caps (GST_BASE_SRC_PAD (src),
       gst_static_pad_template_get_caps (&srctemplate));
@@ -163,6 +198,18 @@ gst_dvd_read_src_class_init (GstDvdReadSrcClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_ANGLE,
       g_param_spec_int ("angle", "angle", "angle",
           1, 999, 1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstDvdReadSrc:read-ahead:
+   *
+   * Number of VOBUs to read in advance from a separate thread, so that
+   * data is ready as soon as downstream asks for it. 0 reads each VOBU
+   * on demand from the streaming thread. Takes effect the next time the
+   * element is started.
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), ARG_READ_AHEAD,
+      g_param_spec_int ("read-ahead", "Read ahead",
+          "Number of VOBUs to read in advance (0 = disabled)", 0, 64,
+          DEFAULT_READ_AHEAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_static_pad_template (gstelement_class, &srctemplate);
 
@@ -187,6 +234,79 @@ gst_dvd_read_src_class_init (GstDvdReadSrcClass * klass)
   chapter_format = gst_format_register ("chapter", "DVD chapter");
 }
 
+static gpointer gst_dvd_read_src_read_ahead_func (gpointer data);
+
+static void
+gst_dvd_read_src_start_reading (GstDvdReadSrc * src)
+{
+  GstAllocationParams params;
+  GstStructure *config;
+  gint read_ahead;
+
+  src->nav_scan = g_malloc (NAV_SCAN_BLOCKS * DVD_VIDEO_LB_LEN);
+
+  /* sector aligned, big enough for any VOBU. Buffers are shrunk to the
+   * actual VOBU size, pages beyond that are usually never touched */
+  gst_allocation_params_init (&params);
+  params.align = DVD_VIDEO_LB_LEN - 1;
+
+  src->pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (src->pool);
+  gst_buffer_pool_config_set_params (config, NULL,
+      MAX_VOBU_BLOCKS * DVD_VIDEO_LB_LEN, 0, 0);
+  gst_buffer_pool_config_set_allocator (config, NULL, &params);
+  gst_buffer_pool_set_config (src->pool, config);
+  gst_buffer_pool_set_active (src->pool, TRUE);
+
+  GST_OBJECT_LOCK (src);
+  read_ahead = src->read_ahead;
+  GST_OBJECT_UNLOCK (src);
+
+  if (read_ahead > 0) {
+    src->ra_running = FALSE;
+    src->ra_busy = FALSE;
+    src->ra_done = FALSE;
+    src->ra_quit = FALSE;
+    src->ra_thread = g_thread_new ("dvdreadsrc-read-ahead",
+        gst_dvd_read_src_read_ahead_func, src);
+  }
+}
+
+static void
+gst_dvd_read_src_item_free (GstDvdReadItem * item)
+{
+  if (item->buf)
+    gst_buffer_unref (item->buf);
+  if (item->clut_event)
+    gst_event_unref (item->clut_event);
+  g_slice_free (GstDvdReadItem, item);
+}
+
+static void
+gst_dvd_read_src_stop_reading (GstDvdReadSrc * src)
+{
+  if (src->ra_thread) {
+    gst_dvd_read_src_pause_read_ahead (src);
+
+    g_mutex_lock (&src->ra_lock);
+    src->ra_quit = TRUE;
+    g_cond_broadcast (&src->ra_cond);
+    g_mutex_unlock (&src->ra_lock);
+
+    g_thread_join (src->ra_thread);
+    src->ra_thread = NULL;
+  }
+
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
+  g_free (src->nav_scan);
+  src->nav_scan = NULL;
+}
+
 static gboolean
 gst_dvd_read_src_start (GstBaseSrc * basesrc)
 {
@@ -222,6 +342,11 @@ gst_dvd_read_src_start (GstBaseSrc * basesrc)
 
   src->first_seek = TRUE;
 
+  src->out_pack = src->cur_pack;
+  src->out_chapter = src->chapter;
+
+  gst_dvd_read_src_start_reading (src);
+
   return TRUE;
 
   /* ERRORS */
@@ -259,6 +384,8 @@ gst_dvd_read_src_stop (GstBaseSrc * basesrc)
 {
   GstDvdReadSrc *src = GST_DVD_READ_SRC (basesrc);
 
+  gst_dvd_read_src_stop_reading (src);
+
   if (src->vts_file) {
     ifoClose (src->vts_file);
     src->vts_file = NULL;
@@ -286,14 +413,20 @@ gst_dvd_read_src_stop (GstBaseSrc * basesrc)
     gst_event_unref (src->title_lang_event_pending);
     src->title_lang_event_pending = NULL;
   }
+  g_mutex_lock (&src->ra_lock);
   if (src->pending_clut_event) {
     gst_event_unref (src->pending_clut_event);
     src->pending_clut_event = NULL;
   }
+  g_mutex_unlock (&src->ra_lock);
   if (src->chapter_starts) {
     g_free (src->chapter_starts);
     src->chapter_starts = NULL;
   }
+  if (src->time_index) {
+    g_array_free (src->time_index, TRUE);
+    src->time_index = NULL;
+  }
 
   GST_LOG_OBJECT (src, "closed DVD");
 
@@ -347,6 +480,7 @@ cur_title_get_chapter_bounds (GstDvdReadSrc * src, gint chapter,
 static gboolean
 gst_dvd_read_src_goto_chapter (GstDvdReadSrc * src, gint chapter)
 {
+  GstEvent *clut_event, *old_clut_event;
   gint i;
 
   /* make sure the chapter number is valid for this title */
@@ -387,11 +521,17 @@ gst_dvd_read_src_goto_chapter (GstDvdReadSrc * src, gint chapter)
 
   src->chapter = chapter;
 
-  if (src->pending_clut_event)
-    gst_event_unref (src->pending_clut_event);
-
-  src->pending_clut_event =
+  /* called from the read-ahead thread too, which hands the event on with
+   * the next item it reads */
+  clut_event =
       gst_dvd_read_src_make_clut_change_event (src, src->cur_pgc->palette);
+  g_mutex_lock (&src->ra_lock);
+  old_clut_event = src->pending_clut_event;
+  src->pending_clut_event = clut_event;
+  g_mutex_unlock (&src->ra_lock);
+
+  if (old_clut_event)
+    gst_event_unref (old_clut_event);
 
   return TRUE;
 }
@@ -435,6 +575,72 @@ gst_dvd_read_src_get_chapter_starts (GstDvdReadSrc * src)
   }
 }
 
+static gint
+gst_dvd_read_src_index_entry_compare (gconstpointer a, gconstpointer b)
+{
+  const GstDvdReadIndexEntry *ea = a, *eb = b;
+
+  if (ea->sector < eb->sector)
+    return -1;
+  return ea->sector > eb->sector;
+}
+
+/* Builds a sector => time index for the current title from its time map,
+ * with the start and end of the title as additional anchors. This makes
+ * timestamping each VOBU and time seeks a binary search. */
+static void
+gst_dvd_read_src_build_time_index (GstDvdReadSrc * src)
+{
+  GstDvdReadIndexEntry entry;
+  vts_tmap_t *tmap = NULL;
+  pgc_t *pgc;
+  gint pgn, pgc_id, first_cell, last_cell, tmp;
+  gint64 duration;
+  guint i;
+
+  if (src->time_index)
+    g_array_free (src->time_index, TRUE);
+  src->time_index =
+      g_array_new (FALSE, FALSE, sizeof (GstDvdReadIndexEntry));
+
+  if (src->num_chapters <= 0)
+    return;
+
+  cur_title_get_chapter_pgc (src, 0, &pgn, &pgc_id, &pgc);
+  cur_title_get_chapter_bounds (src, 0, &first_cell, &tmp);
+  cur_title_get_chapter_bounds (src, src->num_chapters - 1, &tmp, &last_cell);
+
+  entry.sector = pgc->cell_playback[first_cell].first_sector;
+  entry.time = 0;
+  entry.discont = FALSE;
+  g_array_append_val (src->time_index, entry);
+
+  /* there is one time map per program chain */
+  if (src->vts_tmapt != NULL && pgc_id <= src->vts_tmapt->nr_of_tmaps)
+    tmap = &src->vts_tmapt->tmap[pgc_id - 1];
+
+  if (tmap != NULL) {
+    for (i = 0; i < tmap->nr_of_entries; i++) {
+      entry.sector = tmap->map_ent[i] & 0x7fffffff;
+      entry.time = (guint64) tmap->tmu * (i + 1) * GST_SECOND;
+      entry.discont = (tmap->map_ent[i] >> 31) != 0;
+      g_array_append_val (src->time_index, entry);
+    }
+  }
+
+  duration = gst_dvd_read_src_convert_timecode (&pgc->playback_time);
+  if (duration > 0 && last_cell > 0) {
+    entry.sector = pgc->cell_playback[last_cell - 1].last_sector;
+    entry.time = duration;
+    entry.discont = FALSE;
+    g_array_append_val (src->time_index, entry);
+  }
+
+  g_array_sort (src->time_index, gst_dvd_read_src_index_entry_compare);
+
+  GST_DEBUG_OBJECT (src, "time index has %u entries", src->time_index->len);
+}
+
 static gboolean
 gst_dvd_read_src_goto_title (GstDvdReadSrc * src, gint title, gint angle)
 {
@@ -606,6 +812,7 @@ gst_dvd_read_src_goto_title (GstDvdReadSrc * src, gint title, gint angle)
   }
 
   gst_dvd_read_src_get_chapter_starts (src);
+  gst_dvd_read_src_build_time_index (src);
 
   return TRUE;
 
@@ -687,56 +894,121 @@ gst_dvd_read_src_is_nav_pack (const guint8 * data, gint lbn, dsi_t * dsi_pack)
   return TRUE;
 }
 
-/* find time for sector from index, returns NONE if there is no exact match */
-static GstClockTime
-gst_dvd_read_src_get_time_for_sector (GstDvdReadSrc * src, guint sector)
+/* Scans for the NAV pack following the one expected at cur_pack, a few
+ * blocks per read. On success cur_pack points at the NAV pack and its
+ * contents have been copied to @nav_block */
+static gboolean
+gst_dvd_read_src_find_nav_pack (GstDvdReadSrc * src, guint8 * nav_block,
+    dsi_t * dsi_pack)
 {
-  gint i, j;
+  gint scanned = 1, len, i;
 
-  if (src->vts_tmapt == NULL || src->vts_tmapt->nr_of_tmaps == 0)
-    return GST_CLOCK_TIME_NONE;
+  GST_LOG_OBJECT (src, "Skipping nav packet @ pack %d", src->cur_pack);
+  src->cur_pack++;
+
+  while (scanned < MAX_NAV_SCAN) {
+    len = DVDReadBlocks (src->dvd_title, src->cur_pack,
+        MIN (NAV_SCAN_BLOCKS, MAX_NAV_SCAN - scanned), src->nav_scan);
+    if (len <= 0)
+      return FALSE;
 
-  for (i = 0; i < src->vts_tmapt->nr_of_tmaps; ++i) {
-    for (j = 0; j < src->vts_tmapt->tmap[i].nr_of_entries; ++j) {
-      if ((src->vts_tmapt->tmap[i].map_ent[j] & 0x7fffffff) == sector)
-        return (guint64) src->vts_tmapt->tmap[i].tmu * (j + 1) * GST_SECOND;
+    for (i = 0; i < len; i++) {
+      const guint8 *block = src->nav_scan + i * DVD_VIDEO_LB_LEN;
+
+      if (gst_dvd_read_src_is_nav_pack (block, src->cur_pack, dsi_pack)) {
+        memcpy (nav_block, block, DVD_VIDEO_LB_LEN);
+        return TRUE;
+      }
+      GST_LOG_OBJECT (src, "Skipping nav packet @ pack %d", src->cur_pack);
+      src->cur_pack++;
     }
+    scanned += len;
+  }
+
+  GST_LOG_OBJECT (src, "No nav packet @ pack %d after %d blocks",
+      src->cur_pack, MAX_NAV_SCAN);
+  return FALSE;
+}
+
+/* returns the index of the last entry at or before @sector, or -1 */
+static gint
+gst_dvd_read_src_index_find_sector (GArray * index, guint sector)
+{
+  const GstDvdReadIndexEntry *entries;
+  gint lo, hi;
+
+  entries = (const GstDvdReadIndexEntry *) index->data;
+  lo = 0;
+  hi = (gint) index->len - 1;
+  while (lo <= hi) {
+    gint mid = (lo + hi) / 2;
+
+    if (entries[mid].sector <= sector)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
   }
 
-  if (sector == 0)
-    return (GstClockTime) 0;
+  return hi;
+}
+
+/* find time for sector from index, interpolating between the surrounding
+ * entries. Returns NONE outside the title or across a discontinuity */
+static GstClockTime
+gst_dvd_read_src_get_time_for_sector (GstDvdReadSrc * src, guint sector)
+{
+  const GstDvdReadIndexEntry *prev, *next;
+  gint i;
+
+  if (src->time_index == NULL || src->time_index->len == 0)
+    return (sector == 0) ? 0 : GST_CLOCK_TIME_NONE;
+
+  i = gst_dvd_read_src_index_find_sector (src->time_index, sector);
+  if (i < 0)
+    return (sector == 0) ? 0 : GST_CLOCK_TIME_NONE;
+
+  prev = &g_array_index (src->time_index, GstDvdReadIndexEntry, i);
+  if (prev->sector == sector)
+    return prev->time;
+
+  if ((guint) i + 1 >= src->time_index->len)
+    return GST_CLOCK_TIME_NONE;
+
+  next = &g_array_index (src->time_index, GstDvdReadIndexEntry, i + 1);
+  if (next->discont || next->time < prev->time)
+    return GST_CLOCK_TIME_NONE;
 
-  return GST_CLOCK_TIME_NONE;
+  return prev->time + gst_util_uint64_scale (next->time - prev->time,
+      sector - prev->sector, next->sector - prev->sector);
 }
 
 /* returns the sector in the index at (or before) the given time, or -1 */
 static gint
 gst_dvd_read_src_get_sector_from_time (GstDvdReadSrc * src, GstClockTime ts)
 {
-  gint sector, j;
+  const GstDvdReadIndexEntry *entries;
+  gint lo, hi;
 
-  if (src->vts_tmapt == NULL || src->vts_tmapt->nr_of_tmaps < src->ttn)
-    return -1;
+  if (src->time_index == NULL || src->time_index->len == 0)
+    return (ts == 0) ? 0 : -1;
 
-  sector = src->vts_tmapt->tmap[src->ttn - 1].map_ent[0] & 0x7fffffff;
+  /* entries are sorted by sector, and VOBU times increase with sectors */
+  entries = (const GstDvdReadIndexEntry *) src->time_index->data;
+  if (ts > entries[src->time_index->len - 1].time)
+    return -1;
 
-  for (j = 0; j < src->vts_tmapt->tmap[src->ttn - 1].nr_of_entries; ++j) {
-    GstClockTime entry_time;
+  lo = 0;
+  hi = (gint) src->time_index->len - 1;
+  while (lo <= hi) {
+    gint mid = (lo + hi) / 2;
 
-    entry_time =
-        (guint64) src->vts_tmapt->tmap[src->ttn - 1].tmu * (j + 1) * GST_SECOND;
-    if (entry_time <= ts) {
-      sector = src->vts_tmapt->tmap[src->ttn - 1].map_ent[j] & 0x7fffffff;
-    }
-    if (entry_time >= ts) {
-      return sector;
-    }
+    if (entries[mid].time <= ts)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
   }
 
-  if (ts == 0)
-    return 0;
-
-  return -1;
+  return entries[MAX (hi, 0)].sector;
 }
 
 typedef enum
@@ -757,7 +1029,6 @@ gst_dvd_read_src_read (GstDvdReadSrc * src, gint angle, gint new_seek,
   dsi_t dsi_pack;
   guint next_vobu, cur_output_size;
   gint len;
-  gint retries;
   gint64 next_time;
   GstMapInfo map;
 
@@ -820,26 +1091,13 @@ again:
   }
 
   /* read NAV packet */
-  retries = 0;
-nav_retry:
-  retries++;
-
   len = DVDReadBlocks (src->dvd_title, src->cur_pack, 1, oneblock);
   if (len != 1)
     goto read_error;
 
-  if (!gst_dvd_read_src_is_nav_pack (oneblock, src->cur_pack, &dsi_pack)) {
-    GST_LOG_OBJECT (src, "Skipping nav packet @ pack %d", src->cur_pack);
-    src->cur_pack++;
-
-    if (retries < 2000) {
-      goto nav_retry;
-    } else {
-      GST_LOG_OBJECT (src, "No nav packet @ pack %d after 2000 blocks",
-          src->cur_pack);
-      goto read_error;
-    }
-  }
+  if (!gst_dvd_read_src_is_nav_pack (oneblock, src->cur_pack, &dsi_pack) &&
+      !gst_dvd_read_src_find_nav_pack (src, oneblock, &dsi_pack))
+    goto read_error;
 
   /* determine where we go next. These values are the ones we
    * mostly care about */
@@ -861,20 +1119,23 @@ nav_retry:
 
   g_assert (cur_output_size < 1024);
 
-  /* create the buffer (TODO: use buffer pool?) */
-  buf =
-      gst_buffer_new_allocate (NULL, cur_output_size * DVD_VIDEO_LB_LEN, NULL);
+  buf = NULL;
+  if (gst_buffer_pool_acquire_buffer (src->pool, &buf, NULL) != GST_FLOW_OK)
+    goto read_error;
 
   GST_LOG_OBJECT (src, "Going to read %u sectors @ pack %d", cur_output_size,
       src->cur_pack);
 
   gst_buffer_map (buf, &map, GST_MAP_WRITE);
-  /* read in and output cursize packs */
-  len =
-      DVDReadBlocks (src->dvd_title, src->cur_pack, cur_output_size, map.data);
+  /* the NAV pack we already have starts the VOBU, read in the rest */
+  memcpy (map.data, oneblock, DVD_VIDEO_LB_LEN);
+  if (cur_output_size > 1) {
+    len = DVDReadBlocks (src->dvd_title, src->cur_pack + 1,
+        cur_output_size - 1, map.data + DVD_VIDEO_LB_LEN);
 
-  if (len != cur_output_size)
-    goto block_read_error;
+    if (len != cur_output_size - 1)
+      goto block_read_error;
+  }
 
   gst_buffer_unmap (buf, &map);
   gst_buffer_resize (buf, 0, cur_output_size * DVD_VIDEO_LB_LEN);
@@ -938,10 +1199,93 @@ gst_dvd_read_descrambler_available (void)
   return res;
 }
 
+static gpointer
+gst_dvd_read_src_read_ahead_func (gpointer data)
+{
+  GstDvdReadSrc *src = data;
+  GstDvdReadItem *item;
+  gint res;
+
+  g_mutex_lock (&src->ra_lock);
+  while (!src->ra_quit) {
+    if (!src->ra_running || src->ra_done ||
+        g_queue_get_length (&src->ra_queue) >= MAX (src->read_ahead, 1)) {
+      g_cond_wait (&src->ra_cond, &src->ra_lock);
+      continue;
+    }
+    src->ra_busy = TRUE;
+    g_mutex_unlock (&src->ra_lock);
+
+    item = g_slice_new0 (GstDvdReadItem);
+    do {
+      res = gst_dvd_read_src_read (src, src->angle, src->change_cell,
+          &item->buf);
+    } while (res == GST_DVD_READ_AGAIN);
+
+    item->ret = res;
+    if (res == GST_DVD_READ_OK)
+      src->change_cell = FALSE;
+    item->pack = src->cur_pack;
+    item->chapter = src->chapter;
+
+    g_mutex_lock (&src->ra_lock);
+    /* set when the read moved on to the next chapter */
+    item->clut_event = src->pending_clut_event;
+    src->pending_clut_event = NULL;
+    src->ra_busy = FALSE;
+    src->ra_done = (res != GST_DVD_READ_OK);
+    g_queue_push_tail (&src->ra_queue, item);
+    g_cond_broadcast (&src->ra_cond);
+  }
+  g_mutex_unlock (&src->ra_lock);
+
+  return NULL;
+}
+
+/* Stops the read-ahead thread from reading and drops everything it read
+ * so far. Must be called before changing the read position. */
+static void
+gst_dvd_read_src_pause_read_ahead (GstDvdReadSrc * src)
+{
+  GstDvdReadItem *item;
+
+  if (src->ra_thread == NULL)
+    return;
+
+  g_mutex_lock (&src->ra_lock);
+  src->ra_running = FALSE;
+  while (src->ra_busy)
+    g_cond_wait (&src->ra_cond, &src->ra_lock);
+  while ((item = g_queue_pop_head (&src->ra_queue)))
+    gst_dvd_read_src_item_free (item);
+  src->ra_done = FALSE;
+  g_mutex_unlock (&src->ra_lock);
+}
+
+static GstDvdReadItem *
+gst_dvd_read_src_pop_item (GstDvdReadSrc * src)
+{
+  GstDvdReadItem *item = NULL;
+
+  g_mutex_lock (&src->ra_lock);
+  if (!src->ra_running) {
+    src->ra_running = TRUE;
+    g_cond_broadcast (&src->ra_cond);
+  }
+  while (g_queue_is_empty (&src->ra_queue) && !src->ra_done)
+    g_cond_wait (&src->ra_cond, &src->ra_lock);
+  item = g_queue_pop_head (&src->ra_queue);
+  g_cond_broadcast (&src->ra_cond);
+  g_mutex_unlock (&src->ra_lock);
+
+  return item;
+}
+
 static GstFlowReturn
 gst_dvd_read_src_create (GstPushSrc * pushsrc, GstBuffer ** p_buf)
 {
   GstDvdReadSrc *src = GST_DVD_READ_SRC (pushsrc);
+  GstEvent *clut_event;
   GstPad *srcpad;
   gint res;
 
@@ -961,11 +1305,14 @@ gst_dvd_read_src_create (GstPushSrc * pushsrc, GstBuffer ** p_buf)
   }
 
   if (src->new_seek) {
+    gst_dvd_read_src_pause_read_ahead (src);
     gst_dvd_read_src_goto_title (src, src->title, src->angle);
     gst_dvd_read_src_goto_chapter (src, src->chapter);
 
     src->new_seek = FALSE;
     src->change_cell = TRUE;
+    src->out_pack = src->cur_pack;
+    src->out_chapter = src->chapter;
   }
 
   if (src->title_lang_event_pending) {
@@ -973,15 +1320,47 @@ gst_dvd_read_src_create (GstPushSrc * pushsrc, GstBuffer ** p_buf)
     src->title_lang_event_pending = NULL;
   }
 
-  if (src->pending_clut_event) {
-    gst_pad_push_event (srcpad, src->pending_clut_event);
+  /* with read-ahead the CLUT comes with the first item of its chapter, the
+   * items queued before belong to the previous one */
+  if (src->ra_thread == NULL) {
+    g_mutex_lock (&src->ra_lock);
+    clut_event = src->pending_clut_event;
     src->pending_clut_event = NULL;
+    g_mutex_unlock (&src->ra_lock);
+    if (clut_event)
+      gst_pad_push_event (srcpad, clut_event);
   }
 
   /* read it in */
-  do {
-    res = gst_dvd_read_src_read (src, src->angle, src->change_cell, p_buf);
-  } while (res == GST_DVD_READ_AGAIN);
+  if (src->ra_thread) {
+    GstDvdReadItem *item;
+
+    item = gst_dvd_read_src_pop_item (src);
+    if (item == NULL)
+      return GST_FLOW_EOS;
+
+    if (item->clut_event) {
+      gst_pad_push_event (srcpad, item->clut_event);
+      item->clut_event = NULL;
+    }
+    res = item->ret;
+    if (res == GST_DVD_READ_OK) {
+      *p_buf = item->buf;
+      item->buf = NULL;
+    }
+    src->out_pack = item->pack;
+    src->out_chapter = item->chapter;
+    gst_dvd_read_src_item_free (item);
+  } else {
+    do {
+      res = gst_dvd_read_src_read (src, src->angle, src->change_cell, p_buf);
+    } while (res == GST_DVD_READ_AGAIN);
+
+    if (res == GST_DVD_READ_OK)
+      src->change_cell = FALSE;
+    src->out_pack = src->cur_pack;
+    src->out_chapter = src->chapter;
+  }
 
   switch (res) {
     case GST_DVD_READ_ERROR:{
@@ -1000,7 +1379,6 @@ gst_dvd_read_src_create (GstPushSrc * pushsrc, GstBuffer ** p_buf)
       return GST_FLOW_EOS;
     }
     case GST_DVD_READ_OK:{
-      src->change_cell = FALSE;
       return GST_FLOW_OK;
     }
     default:
@@ -1057,6 +1435,9 @@ gst_dvd_read_src_set_property (GObject * object, guint prop_id,
         src->angle = src->uri_angle - 1;
       }
       break;
+    case ARG_READ_AHEAD:
+      src->read_ahead = g_value_get_int (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1086,6 +1467,9 @@ gst_dvd_read_src_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_ANGLE:
       g_value_set_int (value, src->uri_angle);
       break;
+    case ARG_READ_AHEAD:
+      g_value_set_int (value, src->read_ahead);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1251,6 +1635,9 @@ gst_dvd_read_src_do_seek (GstBaseSrc * basesrc, GstSegment * s)
     return TRUE;
   }
 
+  /* the read-ahead thread must not read while we move the position */
+  gst_dvd_read_src_pause_read_ahead (src);
+
   if (s->format == sector_format || s->format == GST_FORMAT_BYTES
       || s->format == GST_FORMAT_TIME) {
     guint old;
@@ -1322,6 +1709,8 @@ gst_dvd_read_src_do_seek (GstBaseSrc * basesrc, GstSegment * s)
     g_return_val_if_reached (FALSE);
   }
 
+  src->out_pack = src->cur_pack;
+  src->out_chapter = src->chapter;
   src->need_newsegment = TRUE;
   return TRUE;
 }
@@ -1445,16 +1834,16 @@ gst_dvd_read_src_do_position_query (GstDvdReadSrc * src, GstQuery * query)
 
   switch (format) {
     case GST_FORMAT_BYTES:{
-      val = (gint64) src->cur_pack * DVD_VIDEO_LB_LEN;
+      val = (gint64) src->out_pack * DVD_VIDEO_LB_LEN;
       break;
     }
     default:{
       if (format == sector_format) {
-        val = src->cur_pack;
+        val = src->out_pack;
       } else if (format == title_format) {
         val = src->title;
       } else if (format == chapter_format) {
-        val = src->chapter;
+        val = src->out_chapter;
       } else if (format == angle_format) {
         val = src->angle;
       } else {
@@ -79,6 +79,7 @@ struct _GstDvdReadSrc {
   gint             num_angles;
 
   GstClockTime    *chapter_starts;  /* start time of chapters within title   */
+  GArray          *time_index;      /* GstDvdReadIndexEntry, sorted by sector */
 
   /* which program chain to watch (based on title and chapter number) */
   pgc_t           *cur_pgc;
@@ -87,7 +88,25 @@ struct _GstDvdReadSrc {
 
   gboolean         need_newsegment;
   GstEvent        *title_lang_event_pending;
-  GstEvent        *pending_clut_event;
+  GstEvent        *pending_clut_event; /* protected by ra_lock */
+
+  /* position of the data handed out last, reported in position queries */
+  gint             out_pack;
+  gint             out_chapter;
+
+  /* VOBU read-ahead */
+  gint             read_ahead;      /* max. queued VOBUs, 0 = disabled */
+  GstBufferPool   *pool;
+  guint8          *nav_scan;        /* scratch blocks for NAV pack search */
+
+  GThread         *ra_thread;
+  GMutex           ra_lock;
+  GCond            ra_cond;
+  GQueue           ra_queue;        /* GstDvdReadItem, protected by ra_lock */
+  gboolean         ra_running;      /* worker may read */
+  gboolean         ra_busy;         /* worker is reading from the disc */
+  gboolean         ra_done;         /* worker hit EOS or an error */
+  gboolean         ra_quit;
 };
 
 struct _GstDvdReadSrcClass {
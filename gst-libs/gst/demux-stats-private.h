@@ -0,0 +1,77 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_DEMUX_STATS_PRIVATE_H__
+#define __GST_DEMUX_STATS_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Counters behind the "stats" property of the demuxers, every demuxer uses
+ * the ones that apply to it. They are updated from the streaming thread
+ * without taking the object lock. The byte counters wrap at 4 GB on 32 bit
+ * platforms, the descramble time is kept in microseconds so that it only
+ * wraps there after about 71 minutes of descrambling. */
+typedef struct {
+  volatile gint   packets_parsed;   /* packets parsed without errors      */
+  volatile gint   packet_errors;    /* packets with parse errors          */
+  volatile gint   packets_dropped;  /* unknown stream or before the seek  */
+  volatile gint   payloads_queued;  /* media objects or fragments queued  */
+  volatile gint   payloads_dropped; /* incomplete or out of segment       */
+  volatile gint   descrambled;      /* blocks descrambled                 */
+  volatile gsize  descramble_time;  /* time spent descrambling, in us     */
+  volatile gsize  bytes_copied;     /* payload bytes copied               */
+  volatile gsize  bytes_shared;     /* payload bytes passed as sub-buffer */
+  volatile gint   index_hits;       /* seeks resolved with the index      */
+  volatile gint   index_misses;     /* seeks that had to estimate         */
+  volatile gint   pull_calls;       /* gst_pad_pull_range() calls         */
+
+  /* the nanoseconds not yet in descramble_time, streaming thread only */
+  GstClockTime    descramble_rest;
+} GstDemuxStats;
+
+/* @demux is anything with a GstDemuxStats called stats */
+#define GST_DEMUX_STATS_INC(demux,counter) \
+    g_atomic_int_inc (&(demux)->stats.counter)
+#define GST_DEMUX_STATS_ADD(demux,counter,val) \
+    g_atomic_pointer_add (&(demux)->stats.counter, (val))
+
+#define GST_DEMUX_STATS_GET_UINT(demux,counter) \
+    ((guint) g_atomic_int_get (&(demux)->stats.counter))
+#define GST_DEMUX_STATS_GET_UINT64(demux,counter) \
+    ((guint64) (gsize) g_atomic_pointer_get (&(demux)->stats.counter))
+/* in nanoseconds, like the other times */
+#define GST_DEMUX_STATS_GET_DESCRAMBLE_TIME(demux) \
+    (GST_DEMUX_STATS_GET_UINT64 (demux, descramble_time) * GST_USECOND)
+
+/* adds the time since @start, from gst_util_get_timestamp(), to the
+ * descramble time and counts a descrambled block */
+static inline void
+gst_demux_stats_add_descramble (GstDemuxStats * stats, GstClockTime start)
+{
+  stats->descramble_rest += gst_util_get_timestamp () - start;
+  g_atomic_pointer_add (&stats->descramble_time,
+      (gsize) (stats->descramble_rest / GST_USECOND));
+  stats->descramble_rest %= GST_USECOND;
+  g_atomic_int_inc (&stats->descrambled);
+}
+
+G_END_DECLS
+
+#endif /* __GST_DEMUX_STATS_PRIVATE_H__ */
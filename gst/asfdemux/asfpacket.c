@@ -203,6 +203,7 @@ gst_asf_payload_queue_for_stream_forward (GstASFDemux * demux,
 
     gst_buffer_replace (&prev->buf, NULL);
     g_array_remove_index (stream->payloads, idx_last);
+    GST_DEMUX_STATS_INC (demux, payloads_dropped);
 
     /* there's data missing, so there's a discontinuity now */
     GST_BUFFER_FLAG_SET (payload->buf, GST_BUFFER_FLAG_DISCONT);
@@ -227,6 +228,7 @@ gst_asf_payload_queue_for_stream_forward (GstASFDemux * demux,
       last = &g_array_index (stream->payloads, AsfPayload, idx_last);
       gst_buffer_replace (&last->buf, NULL);
       g_array_remove_index (stream->payloads, idx_last);
+      GST_DEMUX_STATS_INC (demux, payloads_dropped);
     }
 
     /* Mark discontinuity (should be done via stream->discont anyway though) */
@@ -254,6 +256,7 @@ gst_asf_payload_queue_for_stream_reverse (GstASFDemux * demux,
       }
     } else {
       gst_buffer_unref (payload->buf);
+      GST_DEMUX_STATS_INC (demux, payloads_dropped);
     }
   }
 }
@@ -266,6 +269,8 @@ gst_asf_payload_queue_for_stream (GstASFDemux * demux, AsfPayload * payload,
   GST_DEBUG_OBJECT (demux, "Got payload for stream %d ts:%" GST_TIME_FORMAT,
       stream->id, GST_TIME_ARGS (payload->ts));
 
+  GST_DEMUX_STATS_INC (demux, payloads_queued);
+
   if (GST_ASF_DEMUX_IS_REVERSE_PLAYBACK (demux->segment)) {
     gst_asf_payload_queue_for_stream_reverse (demux, payload, stream);
   } else {
@@ -447,10 +452,13 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
     if (payload.rep_data_len >= 8) {
       payload.mo_size = GST_READ_UINT32_LE (payload.rep_data);
       payload.ts = GST_READ_UINT32_LE (payload.rep_data + 4) * GST_MSECOND;
-      if (G_UNLIKELY (payload.ts < demux->preroll))
-        payload.ts = 0;
-      else
-        payload.ts -= demux->preroll;
+      /* in low-latency mode the offset is removed with first_ts only */
+      if (G_LIKELY (!GST_ASF_DEMUX_IS_LOW_LATENCY (demux))) {
+        if (G_UNLIKELY (payload.ts < demux->preroll))
+          payload.ts = 0;
+        else
+          payload.ts -= demux->preroll;
+      }
       asf_payload_parse_replicated_data_extensions (stream, &payload);
 
       GST_LOG_OBJECT (demux, "media object size   : %u", payload.mo_size);
@@ -479,6 +487,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
       payload.buf = asf_packet_create_payload_buffer (packet, p_data, p_size,
           payload_len);
       payload.buf_filled = payload_len;
+      GST_DEMUX_STATS_ADD (demux, bytes_shared, payload_len);
       gst_asf_payload_queue_for_stream (demux, &payload, stream);
     } else if (GST_ASF_DEMUX_IS_REVERSE_PLAYBACK (demux->segment)) {
       /* Handle fragmented payloads for reverse playback */
@@ -492,6 +501,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
         gst_buffer_fill (prev->buf, payload.mo_offset,
             payload_data, payload_len);
         prev->buf_filled += payload_len;
+        GST_DEMUX_STATS_ADD (demux, bytes_copied, payload_len);
         if (payload.keyframe && payload.mo_offset == 0) {
           stream->reverse_kf_ready = TRUE;
 
@@ -508,6 +518,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
         gst_buffer_fill (payload.buf, payload.mo_offset,
             payload_data, payload_len);
         payload.buf_filled = payload.mo_size - (payload.mo_offset);
+        GST_DEMUX_STATS_ADD (demux, bytes_copied, payload_len);
         gst_asf_payload_queue_for_stream (demux, &payload, stream);
       }
       *p_data += payload_len;
@@ -532,6 +543,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
               || payload.mo_offset + payload_len >
               gst_buffer_get_size (prev->buf)) {
             GST_WARNING_OBJECT (demux, "Offset doesn't match previous data?!");
+            GST_DEMUX_STATS_INC (demux, payloads_dropped);
           } else {
             /* we assume fragments are payloaded with increasing mo_offset */
             if (payload.mo_offset != prev->buf_filled) {
@@ -543,12 +555,14 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
                 payload_data, payload_len);
             prev->buf_filled =
                 MAX (prev->buf_filled, payload.mo_offset + payload_len);
+            GST_DEMUX_STATS_ADD (demux, bytes_copied, payload_len);
             GST_LOG_OBJECT (demux, "Merged media object fragments, size now %u",
                 prev->buf_filled);
           }
         } else {
           GST_DEBUG_OBJECT (demux, "n-th payload fragment, but don't have "
               "any previous fragment, ignoring payload");
+          GST_DEMUX_STATS_INC (demux, payloads_dropped);
         }
       } else {
         GST_LOG_OBJECT (demux, "allocating buffer of size %u for fragmented "
@@ -556,6 +570,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
         payload.buf = gst_buffer_new_allocate (NULL, payload.mo_size, NULL);
         gst_buffer_fill (payload.buf, 0, payload_data, payload_len);
         payload.buf_filled = payload_len;
+        GST_DEMUX_STATS_ADD (demux, bytes_copied, payload_len);
 
         gst_asf_payload_queue_for_stream (demux, &payload, stream);
       }
@@ -573,10 +588,12 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
     *p_size -= payload_len;
 
     ts = payload.mo_offset * GST_MSECOND;
-    if (G_UNLIKELY (ts < demux->preroll))
-      ts = 0;
-    else
-      ts -= demux->preroll;
+    if (G_LIKELY (!GST_ASF_DEMUX_IS_LOW_LATENCY (demux))) {
+      if (G_UNLIKELY (ts < demux->preroll))
+        ts = 0;
+      else
+        ts -= demux->preroll;
+    }
     ts_delta = payload.rep_data[0] * GST_MSECOND;
 
     for (num = 0; payload_len > 0; ++num) {
@@ -599,6 +616,7 @@ gst_asf_demux_parse_payload (GstASFDemux * demux, AsfPacket * packet,
         payload.buf = asf_packet_create_payload_buffer (packet,
             &payload_data, &payload_len, sub_payload_len);
         payload.buf_filled = sub_payload_len;
+        GST_DEMUX_STATS_ADD (demux, bytes_shared, sub_payload_len);
 
         payload.ts = ts;
         if (G_LIKELY (ts_delta))
@@ -804,5 +822,11 @@ gst_asf_demux_parse_packet (GstASFDemux * demux, GstBuffer * buf)
 
 done:
   gst_buffer_unmap (buf, &map);
+
+  if (G_LIKELY (ret == GST_ASF_DEMUX_PARSE_PACKET_ERROR_NONE))
+    GST_DEMUX_STATS_INC (demux, packets_parsed);
+  else
+    GST_DEMUX_STATS_INC (demux, packet_errors);
+
   return ret;
 }
@@ -79,6 +79,19 @@ GST_STATIC_PAD_TEMPLATE ("video_%u",
 
 GST_DEBUG_CATEGORY (asfdemux_dbg);
 
+#define DEFAULT_LOW_LATENCY FALSE
+
+enum
+{
+  PROP_0,
+  PROP_STATS,
+  PROP_LOW_LATENCY
+};
+
+static void gst_asf_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_asf_demux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static GstStateChangeReturn gst_asf_demux_change_state (GstElement * element,
     GstStateChange transition);
 static gboolean gst_asf_demux_element_send_event (GstElement * element,
@@ -120,10 +133,42 @@ G_DEFINE_TYPE (GstASFDemux, gst_asf_demux, GST_TYPE_ELEMENT);
 static void
 gst_asf_demux_class_init (GstASFDemuxClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
 
+  gobject_class = (GObjectClass *) klass;
   gstelement_class = (GstElementClass *) klass;
 
+  gobject_class->set_property = gst_asf_demux_set_property;
+  gobject_class->get_property = gst_asf_demux_get_property;
+
+  /**
+   * GstASFDemux:stats:
+   *
+   * Counters of the parsing hot path since the element last went to READY:
+   * packets parsed, payloads queued and dropped, descrambling, payload
+   * bytes copied versus passed on as sub-buffers, index lookups and pull
+   * calls. Reading them does not block the streaming thread.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Parsing statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstASFDemux:low-latency:
+   *
+   * For broadcast (live) streams, activate the streams as soon as every
+   * stream has a first payload and push payloads right away instead of
+   * queueing up the preroll announced in the header. The preroll is then
+   * neither subtracted from the timestamps nor reported as latency. Has no
+   * effect on files.
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low latency",
+          "Do not preroll broadcast streams", DEFAULT_LOW_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class, "ASF Demuxer",
       "Codec/Demuxer",
       "Demultiplexes ASF Streams", "Owen Fraser-Green <owen@discobabe.net>");
@@ -319,10 +364,79 @@ gst_asf_demux_init (GstASFDemux * demux)
       GST_DEBUG_FUNCPTR (gst_asf_demux_activate_mode));
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
+  demux->low_latency = DEFAULT_LOW_LATENCY;
+
   /* set initial state */
   gst_asf_demux_reset (demux, FALSE);
 }
 
+static GstStructure *
+gst_asf_demux_get_stats (GstASFDemux * demux)
+{
+  return gst_structure_new ("application/x-asf-demux-stats",
+      "packets-parsed", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, packets_parsed),
+      "packet-errors", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, packet_errors),
+      "payloads-queued", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, payloads_queued),
+      "payloads-dropped", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, payloads_dropped),
+      "descrambled", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, descrambled),
+      "descramble-time", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_DESCRAMBLE_TIME (demux),
+      "bytes-copied", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_UINT64 (demux, bytes_copied),
+      "bytes-shared", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_UINT64 (demux, bytes_shared),
+      "index-hits", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, index_hits),
+      "index-misses", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, index_misses),
+      "pull-calls", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (demux, pull_calls), NULL);
+}
+
+static void
+gst_asf_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstASFDemux *demux = GST_ASF_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (demux);
+      demux->low_latency = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_asf_demux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstASFDemux *demux = GST_ASF_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_asf_demux_get_stats (demux));
+      break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_boolean (value, demux->low_latency);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_asf_demux_activate (GstPad * sinkpad, GstObject * parent)
 {
@@ -496,8 +610,10 @@ gst_asf_demux_seek_index_lookup (GstASFDemux * demux, guint * packet,
   if (eos)
     *eos = FALSE;
 
-  if (G_UNLIKELY (demux->sidx_num_entries == 0 || demux->sidx_interval == 0))
+  if (G_UNLIKELY (demux->sidx_num_entries == 0 || demux->sidx_interval == 0)) {
+    GST_DEMUX_STATS_INC (demux, index_misses);
     return FALSE;
+  }
 
   idx = (guint) ((seek_time + demux->preroll) / demux->sidx_interval);
 
@@ -509,6 +625,7 @@ gst_asf_demux_seek_index_lookup (GstASFDemux * demux, guint * packet,
       /* If we get here, we're asking for next keyframe after the last one. There isn't one. */
       if (eos)
         *eos = TRUE;
+      GST_DEMUX_STATS_INC (demux, index_misses);
       return FALSE;
     }
     for (idx2 = idx + 1; idx2 < demux->sidx_num_entries; ++idx2) {
@@ -522,9 +639,11 @@ gst_asf_demux_seek_index_lookup (GstASFDemux * demux, guint * packet,
   if (G_UNLIKELY (idx >= demux->sidx_num_entries)) {
     if (eos)
       *eos = TRUE;
+    GST_DEMUX_STATS_INC (demux, index_misses);
     return FALSE;
   }
 
+  GST_DEMUX_STATS_INC (demux, index_hits);
   *packet = demux->sidx_entries[idx].packet;
   if (speed)
     *speed = demux->sidx_entries[idx].count;
@@ -1037,6 +1156,7 @@ gst_asf_demux_pull_data (GstASFDemux * demux, guint64 offset, guint size,
   GST_LOG_OBJECT (demux, "pulling buffer at %" G_GUINT64_FORMAT "+%u",
       offset, size);
 
+  GST_DEMUX_STATS_INC (demux, pull_calls);
   flow = gst_pad_pull_range (demux->sinkpad, offset, size, p_buf);
 
   if (G_LIKELY (p_flow))
@@ -1558,7 +1678,18 @@ gst_asf_demux_check_activate_streams (GstASFDemux * demux, gboolean force)
   if (demux->activated_streams)
     return TRUE;
 
-  if (!all_streams_prerolled (demux) && !force) {
+  if (GST_ASF_DEMUX_IS_LOW_LATENCY (demux)) {
+    /* the first payload of every stream is enough to lock on to the
+     * timestamps, first_ts of a single stream would shift the others */
+    for (i = 0; i < demux->num_streams; ++i) {
+      if (demux->stream[i].payloads->len == 0)
+        break;
+    }
+    if (i < demux->num_streams && !force) {
+      GST_DEBUG_OBJECT (demux, "not all streams with data yet");
+      return FALSE;
+    }
+  } else if (!all_streams_prerolled (demux) && !force) {
     GST_DEBUG_OBJECT (demux, "not all streams with data beyond preroll yet");
     return FALSE;
   }
@@ -3743,7 +3874,10 @@ gst_asf_demux_process_file (GstASFDemux * demux, guint8 * data, guint64 size)
   demux->preroll = preroll * GST_MSECOND;
 
   /* initial latency */
-  demux->latency = demux->preroll;
+  if (GST_ASF_DEMUX_IS_LOW_LATENCY (demux))
+    demux->latency = 0;
+  else
+    demux->latency = demux->preroll;
 
   if (demux->play_time == 0)
     demux->seekable = FALSE;
@@ -4546,6 +4680,7 @@ gst_asf_demux_descramble_buffer (GstASFDemux * demux, AsfStream * stream,
   GstBuffer *descrambled_buffer;
   GstBuffer *scrambled_buffer;
   GstBuffer *sub_buffer;
+  GstClockTime start;
   guint offset;
   guint off;
   guint row;
@@ -4560,6 +4695,8 @@ gst_asf_demux_descramble_buffer (GstASFDemux * demux, AsfStream * stream,
       stream->ds_packet_size * stream->span)
     return;
 
+  start = gst_util_get_timestamp ();
+
   for (offset = 0; offset < gst_buffer_get_size (scrambled_buffer);
       offset += stream->ds_chunk_size) {
     off = offset / stream->ds_chunk_size;
@@ -4595,6 +4732,8 @@ gst_asf_demux_descramble_buffer (GstASFDemux * demux, AsfStream * stream,
 
   gst_buffer_unref (scrambled_buffer);
   *p_buffer = descrambled_buffer;
+
+  gst_demux_stats_add_descramble (&demux->stats, start);
 }
 
 static gboolean
@@ -4821,6 +4960,7 @@ gst_asf_demux_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_NULL_TO_READY:{
       gst_segment_init (&demux->segment, GST_FORMAT_TIME);
+      memset (&demux->stats, 0, sizeof (demux->stats));
       demux->need_newsegment = TRUE;
       demux->segment_running = FALSE;
       demux->keyunit_sync = FALSE;
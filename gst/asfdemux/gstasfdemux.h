@@ -24,6 +24,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstflowcombiner.h>
+#include <gst/demux-stats-private.h>
 
 #include "asfheaders.h"
 
@@ -152,6 +153,10 @@ typedef enum {
 
 #define GST_ASF_DEMUX_IS_REVERSE_PLAYBACK(seg) (seg.rate < 0.0? TRUE:FALSE)
 
+/* broadcast streams in low-latency mode are pushed without prerolling */
+#define GST_ASF_DEMUX_IS_LOW_LATENCY(demux) \
+    ((demux)->low_latency && (demux)->broadcast)
+
 #define GST_ASF_DEMUX_NUM_VIDEO_PADS   16
 #define GST_ASF_DEMUX_NUM_AUDIO_PADS   32
 #define GST_ASF_DEMUX_NUM_STREAMS      32
@@ -223,6 +228,7 @@ struct _GstASFDemux {
   gboolean             segment_running;  /* if we've started the current segment    */
   gboolean             streaming;        /* TRUE if we are operating chain-based    */
   GstClockTime         latency;
+  gboolean             low_latency;      /* "low-latency" property                  */
 
   /* for debugging only */
   gchar               *objpath;
@@ -242,6 +248,8 @@ struct _GstASFDemux {
   GstASF3DMode asf_3D_mode;
 
   gboolean saw_file_header;
+
+  GstDemuxStats stats;
 };
 
 struct _GstASFDemuxClass {
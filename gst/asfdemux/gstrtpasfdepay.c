@@ -101,7 +101,6 @@ gst_rtp_asf_depay_class_init (GstRtpAsfDepayClass * klass)
 static void
 gst_rtp_asf_depay_init (GstRtpAsfDepay * depay)
 {
-  depay->adapter = gst_adapter_new ();
 }
 
 static void
@@ -111,7 +110,7 @@ gst_rtp_asf_depay_finalize (GObject * object)
 
   depay = GST_RTP_ASF_DEPAY (object);
 
-  g_object_unref (depay->adapter);
+  gst_buffer_replace (&depay->packet, NULL);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -239,41 +238,28 @@ field_size (guint8 field)
   }
 }
 
-/* Set the padding field to te correct value as the spec
- * says it should be se to 0 in the rtp packets
+/* Set the padding field to the correct value as the spec says it should be
+ * set to 0 in the rtp packets. @data contains @plen bytes of the packet and
+ * has room for the complete packet, the padding is cleared as well.
  */
-static GstBuffer *
-gst_rtp_asf_depay_update_padding (GstRtpAsfDepay * depayload, GstBuffer * buf)
+static void
+gst_rtp_asf_depay_write_padding (GstRtpAsfDepay * depayload, guint8 * data,
+    guint plen)
 {
-  GstBuffer *result;
-  GstMapInfo map;
-  guint8 *data;
-  gint offset = 0;
+  guint offset = 0;
   guint8 aux;
   guint8 seq_type;
   guint8 pad_type;
   guint8 pkt_type;
-  gsize plen, padding;
-
-  plen = gst_buffer_get_size (buf);
-  if (plen == depayload->packet_size)
-    return buf;
+  guint padding;
 
   padding = depayload->packet_size - plen;
 
-  GST_LOG_OBJECT (depayload,
-      "padding buffer size %" G_GSIZE_FORMAT " to packet size %d", plen,
+  GST_LOG_OBJECT (depayload, "padding buffer size %u to packet size %u", plen,
       depayload->packet_size);
 
-  result = gst_buffer_new_and_alloc (depayload->packet_size);
-
-  gst_buffer_map (result, &map, GST_MAP_READ);
-  data = map.data;
   memset (data + plen, 0, padding);
 
-  gst_buffer_extract (buf, 0, data, plen);
-  gst_buffer_unref (buf);
-
   aux = data[offset++];
   if (aux & 0x80) {
     guint8 err_len = 0;
@@ -281,8 +267,7 @@ gst_rtp_asf_depay_update_padding (GstRtpAsfDepay * depayload, GstBuffer * buf)
       GST_WARNING_OBJECT (depayload, "Error correction length type should be "
           "set to 0");
       /* this packet doesn't follow the spec */
-      gst_buffer_unmap (result, &map);
-      return result;
+      return;
     }
     err_len = aux & 0x0F;
     offset += err_len;
@@ -297,6 +282,11 @@ gst_rtp_asf_depay_update_padding (GstRtpAsfDepay * depayload, GstBuffer * buf)
   offset += field_size (pkt_type);      /* skip packet length */
   offset += field_size (seq_type);      /* skip sequence field */
 
+  if (offset + field_size (pad_type) > plen) {
+    GST_WARNING_OBJECT (depayload, "packet too small for its header");
+    return;
+  }
+
   /* write padding */
   switch (pad_type) {
       /* DWORD */
@@ -319,9 +309,82 @@ gst_rtp_asf_depay_update_padding (GstRtpAsfDepay * depayload, GstBuffer * buf)
     default:
       break;
   }
-  gst_buffer_unmap (result, &map);
+}
+
+/* Copy a complete packet that is smaller than the packet size into a buffer
+ * of the packet size and pad it */
+static GstBuffer *
+gst_rtp_asf_depay_pad_packet (GstRtpAsfDepay * depay, const guint8 * data,
+    guint len)
+{
+  GstBuffer *outbuf;
+  GstMapInfo map;
+
+  outbuf = gst_buffer_new_and_alloc (depay->packet_size);
+  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+  memcpy (map.data, data, len);
+  gst_rtp_asf_depay_write_padding (depay, map.data, len);
+  gst_buffer_unmap (outbuf, &map);
+
+  return outbuf;
+}
+
+static void
+gst_rtp_asf_depay_reset_packet (GstRtpAsfDepay * depay)
+{
+  gst_buffer_replace (&depay->packet, NULL);
+  depay->packet_fill = 0;
+}
+
+/* Copy a fragment of a packet at @offset into the packet being reassembled.
+ * Returns the complete packet after the last fragment. */
+static GstBuffer *
+gst_rtp_asf_depay_collect_fragment (GstRtpAsfDepay * depay, guint offset,
+    const guint8 * data, guint len, gboolean last)
+{
+  GstBuffer *outbuf;
+  GstMapInfo map;
+
+  if (offset != depay->packet_fill) {
+    if (depay->packet_fill) {
+      GST_WARNING_OBJECT (depay, "Offset doesn't match previous data?!");
+      GST_DEBUG_OBJECT (depay, "clearing for re-sync");
+      gst_rtp_asf_depay_reset_packet (depay);
+    } else
+      GST_DEBUG_OBJECT (depay, "waiting for start of packet");
+    return NULL;
+  }
+
+  if (depay->packet_fill + len > depay->packet_size) {
+    GST_WARNING_OBJECT (depay, "fragments exceed the packet size %u",
+        depay->packet_size);
+    gst_rtp_asf_depay_reset_packet (depay);
+    return NULL;
+  }
+
+  /* fragments are copied directly to their place in the packet */
+  GST_LOG_OBJECT (depay, "collecting fragment");
+  if (depay->packet == NULL)
+    depay->packet = gst_buffer_new_and_alloc (depay->packet_size);
+
+  gst_buffer_fill (depay->packet, depay->packet_fill, data, len);
+  depay->packet_fill += len;
+
+  /* RTP marker bit M is set if this is last fragment */
+  if (!last)
+    return NULL;
+
+  GST_LOG_OBJECT (depay, "last fragment, assembling packet");
+  outbuf = depay->packet;
+  if (depay->packet_fill < depay->packet_size) {
+    gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+    gst_rtp_asf_depay_write_padding (depay, map.data, depay->packet_fill);
+    gst_buffer_unmap (outbuf, &map);
+  }
+  depay->packet = NULL;
+  depay->packet_fill = 0;
 
-  return result;
+  return outbuf;
 }
 
 /* Docs: 'RTSP Protocol PDF' document from http://sdp.ppona.com/ (page 8) */
@@ -332,6 +395,7 @@ gst_rtp_asf_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   GstRtpAsfDepay *depay;
   const guint8 *payload;
   GstBuffer *outbuf;
+  GstBufferList *list;
   gboolean S, L, R, D, I;
   guint payload_len, hdr_len, offset;
   guint len_offs;
@@ -343,7 +407,7 @@ gst_rtp_asf_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   /* flush remaining data on discont */
   if (GST_BUFFER_IS_DISCONT (buf)) {
     GST_LOG_OBJECT (depay, "got DISCONT");
-    gst_adapter_clear (depay->adapter);
+    gst_rtp_asf_depay_reset_packet (depay);
     depay->discont = TRUE;
   }
 
@@ -354,6 +418,9 @@ gst_rtp_asf_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
   payload = gst_rtp_buffer_get_payload (&rtpbuf);
   offset = 0;
 
+  /* all packets completed by this RTP packet are pushed at once */
+  list = gst_buffer_list_new ();
+
   GST_LOG_OBJECT (depay, "got payload len of %u", payload_len);
 
   do {
@@ -438,59 +505,35 @@ gst_rtp_asf_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
         packet_len, payload_len, depay->packet_size);
 
     if (!L) {
-      guint available;
-      GstBuffer *sub;
-
       /* Fragmented packet handling */
-      outbuf = NULL;
-
-      if (len_offs == (available = gst_adapter_available (depay->adapter))) {
-        /* fragment aligns with what we have, add it */
-        GST_LOG_OBJECT (depay, "collecting fragment");
-        sub =
-            gst_rtp_buffer_get_payload_subbuffer (&rtpbuf, offset, packet_len);
-        gst_adapter_push (depay->adapter, sub);
-        /* RTP marker bit M is set if this is last fragment */
-        if (gst_rtp_buffer_get_marker (&rtpbuf)) {
-          GST_LOG_OBJECT (depay, "last fragment, assembling packet");
-          outbuf =
-              gst_adapter_take_buffer (depay->adapter, available + packet_len);
-        }
-      } else {
-        if (available) {
-          GST_WARNING_OBJECT (depay, "Offset doesn't match previous data?!");
-          GST_DEBUG_OBJECT (depay, "clearing for re-sync");
-          gst_adapter_clear (depay->adapter);
-        } else
-          GST_DEBUG_OBJECT (depay, "waiting for start of packet");
-      }
+      outbuf = gst_rtp_asf_depay_collect_fragment (depay, len_offs, payload,
+          packet_len, gst_rtp_buffer_get_marker (&rtpbuf));
+    } else if (packet_len < depay->packet_size) {
+      GST_LOG_OBJECT (depay, "collecting packet, padding");
+      outbuf = gst_rtp_asf_depay_pad_packet (depay, payload, packet_len);
     } else {
       GST_LOG_OBJECT (depay, "collecting packet");
       outbuf =
           gst_rtp_buffer_get_payload_subbuffer (&rtpbuf, offset, packet_len);
     }
 
-    /* If we haven't completed a full ASF packet, return */
-    if (!outbuf)
-      return NULL;
-
-    outbuf = gst_rtp_asf_depay_update_padding (depay, outbuf);
+    if (outbuf) {
+      if (!S)
+        GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
 
-    if (!S)
-      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
-
-    if (depay->discont) {
-      GST_LOG_OBJECT (depay, "setting DISCONT");
-      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
-      depay->discont = FALSE;
-    }
+      if (depay->discont) {
+        GST_LOG_OBJECT (depay, "setting DISCONT");
+        GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+        depay->discont = FALSE;
+      }
 
-    GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
+      GST_BUFFER_TIMESTAMP (outbuf) = timestamp;
 
-    gst_rtp_base_depayload_push (depayload, outbuf);
+      gst_buffer_list_add (list, outbuf);
 
-    /* only apply the timestamp to the first buffer of this packet */
-    timestamp = -1;
+      /* only apply the timestamp to the first buffer of this packet */
+      timestamp = -1;
+    }
 
     /* skip packet data */
     payload += packet_len;
@@ -498,17 +541,22 @@ gst_rtp_asf_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
     payload_len -= packet_len;
   } while (payload_len > 0);
 
+done:
   gst_rtp_buffer_unmap (&rtpbuf);
 
+  if (gst_buffer_list_length (list) > 0)
+    gst_rtp_base_depayload_push_list (depayload, list);
+  else
+    gst_buffer_list_unref (list);
+
   return NULL;
 
 /* ERRORS */
 too_small:
   {
-    gst_rtp_buffer_unmap (&rtpbuf);
     GST_WARNING_OBJECT (depayload, "Payload too small, expected at least 4 "
         "bytes for header, but got only %d bytes", payload_len);
-    return NULL;
+    goto done;
   }
 }
 
@@ -522,7 +570,7 @@ gst_rtp_asf_depay_change_state (GstElement * element, GstStateChange trans)
 
   switch (trans) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
-      gst_adapter_clear (depay->adapter);
+      gst_rtp_asf_depay_reset_packet (depay);
       depay->discont = TRUE;
       break;
     default:
@@ -533,7 +581,7 @@ gst_rtp_asf_depay_change_state (GstElement * element, GstStateChange trans)
 
   switch (trans) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_adapter_clear (depay->adapter);
+      gst_rtp_asf_depay_reset_packet (depay);
       break;
     default:
       break;
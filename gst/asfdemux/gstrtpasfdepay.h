@@ -22,7 +22,6 @@
 #define __GST_RTP_ASF_DEPAY_H__
 
 #include <gst/gst.h>
-#include <gst/base/gstadapter.h>
 
 #include <gst/rtp/gstrtpbasedepayload.h>
 
@@ -48,7 +47,8 @@ struct _GstRtpAsfDepay
 
   guint packet_size;
 
-  GstAdapter *adapter;
+  GstBuffer  *packet;       /* fragmented packet being reassembled */
+  guint       packet_fill;  /* bytes of the packet collected so far */
   gboolean    discont;
 };
 
@@ -0,0 +1,304 @@
+/* GStreamer demuxer statistics tracer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:tracer-demuxstats
+ * @short_description: log the statistics of demuxers
+ *
+ * A tracing module that samples the "stats" property of elements, such as
+ * asfdemux and rmdemux, while they push data. The counters are kept by the
+ * elements themselves with atomic operations, so they are cheap enough to
+ * stay enabled in production where debug logging is not.
+ *
+ * |[
+ * GST_TRACERS="demuxstats(interval=500)" GST_DEBUG="GST_TRACER:7" \
+ *     gst-launch-1.0 filesrc location=file.asf ! decodebin ! fakesink
+ * ]|
+ *
+ * The interval is given in milliseconds and defaults to one second. Every
+ * element is also sampled once when it goes from PAUSED to READY.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstdemuxstats.h"
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+
+GST_DEBUG_CATEGORY_STATIC (gst_demux_stats_debug);
+#define GST_CAT_DEFAULT gst_demux_stats_debug
+
+#define DEFAULT_INTERVAL GST_SECOND
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_demux_stats_debug, "demuxstats", 0, \
+        "demuxer statistics tracer");
+#define gst_demux_stats_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstDemuxStatsTracer, gst_demux_stats_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GQuark sample_quark;
+static GstTracerRecord *tr_stats;
+
+/* kept for every element that pushed data while tracing. They are never
+ * freed, only reused, so that the cache of a thread can't point to freed
+ * memory. */
+typedef struct
+{
+  /* the element, NULL once it is gone */
+  gpointer element;
+  gboolean has_stats;
+  /* the interval that was sampled last */
+  volatile gint slot;
+} ElementSample;
+
+/* the sample of the element that a thread pushed from last */
+typedef struct
+{
+  gpointer element;
+  ElementSample *sample;
+} SampleCache;
+
+static GPrivate sample_cache = G_PRIVATE_INIT (g_free);
+
+static GMutex free_samples_lock;
+static GSList *free_samples;
+
+static void
+release_sample (ElementSample * sample)
+{
+  g_atomic_pointer_set (&sample->element, NULL);
+
+  g_mutex_lock (&free_samples_lock);
+  free_samples = g_slist_prepend (free_samples, sample);
+  g_mutex_unlock (&free_samples_lock);
+}
+
+/* slow path, the qdata is only looked up for another element than the one
+ * the thread pushed from last */
+static ElementSample *
+lookup_sample (SampleCache * cache, GstElement * element)
+{
+  ElementSample *sample;
+
+  while (!(sample = g_object_get_qdata (G_OBJECT (element), sample_quark))) {
+    GParamSpec *pspec;
+
+    g_mutex_lock (&free_samples_lock);
+    if (free_samples) {
+      sample = free_samples->data;
+      free_samples = g_slist_delete_link (free_samples, free_samples);
+    }
+    g_mutex_unlock (&free_samples_lock);
+    if (sample == NULL)
+      sample = g_new0 (ElementSample, 1);
+
+    pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+        "stats");
+    sample->has_stats = pspec != NULL && (pspec->flags & G_PARAM_READABLE)
+        && pspec->value_type == GST_TYPE_STRUCTURE;
+    sample->slot = -1;
+    g_atomic_pointer_set (&sample->element, element);
+
+    /* another thread may have been first */
+    if (!g_object_replace_qdata (G_OBJECT (element), sample_quark, NULL,
+            sample, (GDestroyNotify) release_sample, NULL))
+      release_sample (sample);
+  }
+
+  cache->element = element;
+  cache->sample = sample;
+
+  return sample;
+}
+
+static ElementSample *
+get_sample (GstElement * element)
+{
+  SampleCache *cache = g_private_get (&sample_cache);
+
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (SampleCache, 1);
+    g_private_set (&sample_cache, cache);
+  }
+
+  /* the element may be gone and another one have its address, then the
+   * sample was released or is the one of the new element */
+  if (G_LIKELY (cache->element == element && cache->sample != NULL &&
+          g_atomic_pointer_get (&cache->sample->element) == element))
+    return cache->sample;
+
+  return lookup_sample (cache, element);
+}
+
+/* returns TRUE if the stats of @sample are due for logging, only one
+ * thread gets TRUE for an interval */
+static gboolean
+check_sample (GstDemuxStatsTracer * self, ElementSample * sample,
+    GstClockTime ts)
+{
+  gint slot, last;
+
+  if (!sample->has_stats)
+    return FALSE;
+
+  slot = (gint) (ts / self->interval);
+  last = g_atomic_int_get (&sample->slot);
+
+  return slot != last &&
+      g_atomic_int_compare_and_exchange (&sample->slot, last, slot);
+}
+
+static void
+log_stats (GstClockTime ts, GstElement * element)
+{
+  GstStructure *stats = NULL;
+  gchar *name, *str;
+
+  g_object_get (element, "stats", &stats, NULL);
+  if (stats == NULL)
+    return;
+
+  name = gst_object_get_name (GST_OBJECT_CAST (element));
+  str = gst_structure_to_string (stats);
+  gst_tracer_record_log (tr_stats, (guint64) ts, name, str);
+
+  g_free (str);
+  g_free (name);
+  gst_structure_free (stats);
+}
+
+static void
+sample_pad_parent (GstDemuxStatsTracer * self, GstClockTime ts, GstPad * pad)
+{
+  GstObject *parent = GST_OBJECT_PARENT (pad);
+
+  if (parent == NULL || !GST_IS_ELEMENT (parent))
+    return;
+
+  if (check_sample (self, get_sample (GST_ELEMENT_CAST (parent)), ts))
+    log_stats (ts, GST_ELEMENT_CAST (parent));
+}
+
+static void
+do_push_buffer_pre (GstDemuxStatsTracer * self, GstClockTime ts,
+    GstPad * pad, GstBuffer * buffer)
+{
+  sample_pad_parent (self, ts, pad);
+}
+
+static void
+do_push_buffer_list_pre (GstDemuxStatsTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  sample_pad_parent (self, ts, pad);
+}
+
+static void
+do_element_change_state_post (GstDemuxStatsTracer * self, GstClockTime ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  ElementSample *sample;
+
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY)
+    return;
+
+  /* NULL if it never pushed anything */
+  sample = g_object_get_qdata (G_OBJECT (element), sample_quark);
+  if (sample != NULL && sample->has_stats)
+    log_stats (ts, element);
+}
+
+static void
+gst_demux_stats_tracer_constructed (GObject * object)
+{
+  GstDemuxStatsTracer *self = GST_DEMUX_STATS_TRACER (object);
+  gchar *params = NULL, *tmp;
+  GstStructure *s;
+  gint interval;
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  g_object_get (self, "params", &params, NULL);
+  if (params == NULL)
+    return;
+
+  tmp = g_strdup_printf ("demuxstats,%s", params);
+  s = gst_structure_from_string (tmp, NULL);
+  if (s == NULL) {
+    GST_WARNING_OBJECT (self, "can't parse parameters '%s'", params);
+  } else {
+    if (gst_structure_get_int (s, "interval", &interval) && interval > 0)
+      self->interval = interval * GST_MSECOND;
+    gst_structure_free (s);
+  }
+
+  g_free (tmp);
+  g_free (params);
+}
+
+static void
+gst_demux_stats_tracer_class_init (GstDemuxStatsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_demux_stats_tracer_constructed;
+
+  sample_quark = g_quark_from_static_string ("GstDemuxStatsTracer.sample");
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_stats = gst_tracer_record_new ("demuxstats.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time of the sample",
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+              GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "stats", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "the stats property of the element",
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+  GST_OBJECT_FLAG_SET (tr_stats, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+}
+
+static void
+gst_demux_stats_tracer_init (GstDemuxStatsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  self->interval = DEFAULT_INTERVAL;
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
+
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
@@ -0,0 +1,64 @@
+/* GStreamer demuxer statistics tracer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_DEMUX_STATS_H__
+#define __GST_DEMUX_STATS_H__
+
+#include <gst/gst.h>
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_DEMUX_STATS_TRACER \
+  (gst_demux_stats_tracer_get_type())
+#define GST_DEMUX_STATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_DEMUX_STATS_TRACER,GstDemuxStatsTracer))
+#define GST_DEMUX_STATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_DEMUX_STATS_TRACER,GstDemuxStatsTracerClass))
+#define GST_IS_DEMUX_STATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_DEMUX_STATS_TRACER))
+#define GST_IS_DEMUX_STATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_DEMUX_STATS_TRACER))
+
+typedef struct _GstDemuxStatsTracer GstDemuxStatsTracer;
+typedef struct _GstDemuxStatsTracerClass GstDemuxStatsTracerClass;
+
+/**
+ * GstDemuxStatsTracer:
+ *
+ * Logs the "stats" structure of every element that has one, at most once
+ * per interval while it pushes data and once when it stops.
+ */
+struct _GstDemuxStatsTracer {
+  GstTracer     parent;
+
+  GstClockTime  interval;
+};
+
+struct _GstDemuxStatsTracerClass {
+  GstTracerClass parent_class;
+};
+
+GType gst_demux_stats_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
+
+#endif /* __GST_DEMUX_STATS_H__ */
@@ -87,17 +87,41 @@ static const guint32 default_clut[16] = {
 typedef struct RLE_state
 {
   gint id;
-  gint aligned;
-  gint offset[2];
+  /* Read position of each field, counted in nibbles */
+  guint pos[2];
+
+  const guint8 *data;
+  guint size;
+
+  guint8 *target;
+
+  /* Line of the frame drawn while decoding, or NULL */
+  guint32 *pixel_target;
   gint hl_left;
   gint hl_right;
 
-  guchar *target;
-
-  guchar next;
+  /* Pixels in output byte order, 0 for fully transparent colours */
+  guint32 pixels[4];
+  guint32 hl_pixels[4];
 }
 RLE_state;
 
+/* Length in nibbles of the RLE code starting with a given byte:
+ *   4 .. f       1 nibble
+ *   1x .. 3x     2 nibbles
+ *   04x .. 0fx   3 nibbles
+ *   00xx         4 nibbles
+ */
+#define N16(n) n, n, n, n, n, n, n, n, n, n, n, n, n, n, n, n
+static const guint8 rle_code_nibbles[256] = {
+  4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+  N16 (2), N16 (2), N16 (2),
+  N16 (1), N16 (1), N16 (1), N16 (1), N16 (1), N16 (1),
+  N16 (1), N16 (1), N16 (1), N16 (1), N16 (1), N16 (1)
+};
+
+#undef N16
+
 static void
 gst_dvd_sub_dec_class_init (GstDvdSubDecClass * klass)
 {
@@ -159,6 +183,12 @@ gst_dvd_sub_dec_init (GstDvdSubDec * dec)
 
   dec->buf_dirty = TRUE;
   dec->use_ARGB = FALSE;
+
+  dec->index_map = NULL;
+  dec->index_alloc = 0;
+  dec->index_dirty = TRUE;
+  dec->last_buf = NULL;
+  dec->hl_dirty = FALSE;
 }
 
 static void
@@ -172,6 +202,9 @@ gst_dvd_sub_dec_finalize (GObject * gobject)
     dec->partialbuf = NULL;
   }
 
+  gst_buffer_replace (&dec->last_buf, NULL);
+  g_free (dec->index_map);
+
   G_OBJECT_CLASS (parent_class)->finalize (gobject);
 }
 
@@ -315,6 +348,7 @@ gst_dvd_sub_dec_parse_subpic (GstDvdSubDec * dec)
         GST_DEBUG_OBJECT (dec, "SPU SET_SIZE left %d, top %d, right %d, "
             "bottom %d", dec->left, dec->top, dec->right, dec->bottom);
 
+        dec->index_dirty = TRUE;
         dec->buf_dirty = TRUE;
         buf += 7;
         break;
@@ -326,6 +360,7 @@ gst_dvd_sub_dec_parse_subpic (GstDvdSubDec * dec)
         GST_DEBUG_OBJECT (dec, "Offset1 %d, Offset2 %d",
             dec->offset[0], dec->offset[1]);
 
+        dec->index_dirty = TRUE;
         dec->buf_dirty = TRUE;
         buf += 5;
         break;
@@ -384,19 +419,6 @@ gst_dvd_sub_dec_parse_subpic (GstDvdSubDec * dec)
   }
 }
 
-static inline int
-gst_get_nibble (guchar * buffer, RLE_state * state)
-{
-  if (state->aligned) {
-    state->next = buffer[state->offset[state->id]++];
-    state->aligned = 0;
-    return state->next >> 4;
-  } else {
-    state->aligned = 1;
-    return state->next & 0xf;
-  }
-}
-
 /* Premultiply the current lookup table into the "target" cache */
 static void
 gst_setup_palette (GstDvdSubDec * dec)
@@ -449,51 +471,138 @@ gst_setup_palette (GstDvdSubDec * dec)
   }
 }
 
-static inline guint
-gst_get_rle_code (guchar * buffer, RLE_state * state)
+/* Returns the next 32 bits of the current field, starting at the current
+ * nibble. Reads past the end of the packet return zero bits, which decode
+ * as "fill to the end of the line". */
+static inline guint32
+gst_peek_rle_bits (const RLE_state * state)
 {
-  gint code;
-
-  code = gst_get_nibble (buffer, state);
-  if (code < 0x4) {             /* 4 .. f */
-    code = (code << 4) | gst_get_nibble (buffer, state);
-    if (code < 0x10) {          /* 1x .. 3x */
-      code = (code << 4) | gst_get_nibble (buffer, state);
-      if (code < 0x40) {        /* 04x .. 0fx */
-        code = (code << 4) | gst_get_nibble (buffer, state);
-      }
+  guint pos = state->pos[state->id];
+  guint offset = pos >> 1;
+  guint32 bits;
+
+  if (G_LIKELY (offset + 4 <= state->size)) {
+    bits = GST_READ_UINT32_BE (state->data + offset);
+  } else {
+    guint i;
+
+    bits = 0;
+    for (i = 0; i < 4; i++) {
+      bits <<= 8;
+      if (offset + i < state->size)
+        bits |= state->data[offset + i];
     }
   }
-  return code;
+
+  return bits << ((pos & 1) * 4);
+}
+
+static inline guint
+gst_get_rle_code (RLE_state * state)
+{
+  guint32 bits;
+  guint nibbles;
+
+  bits = gst_peek_rle_bits (state);
+  nibbles = rle_code_nibbles[bits >> 24];
+  state->pos[state->id] += nibbles;
+
+  return bits >> (32 - 4 * nibbles);
+}
+
+/* Packs a pixel in A, Y/R, U/G, V/B byte order */
+static inline guint32
+gst_pack_pixel (guint8 a, guint8 y_r, guint8 u_g, guint8 v_b)
+{
+  guint8 pixel[4] = { a, y_r, u_g, v_b };
+  guint32 packed;
+
+  memcpy (&packed, pixel, sizeof (packed));
+
+  return packed;
+}
+
+/* Fully transparent colours map to the clear pixel */
+static inline guint32
+gst_pack_colour (const Color_val * c, guint32 clear)
+{
+  if (c->A == 0)
+    return clear;
+
+  return gst_pack_pixel (c->A, c->Y_R, c->U_G, c->V_B);
 }
 
-#define DRAW_RUN(target,len,c)                  \
+static inline guint32
+gst_get_clear_pixel (GstDvdSubDec * dec)
+{
+  if (dec->use_ARGB)
+    return gst_pack_pixel (0, 0, 0, 0);
+  else
+    return gst_pack_pixel (0, 16, 128, 128);
+}
+
+#define DRAW_RUN(target,len,pixel)              \
 G_STMT_START {                                  \
-  gint i = 0;                                   \
-  if ((c)->A) {                                 \
-    for (i = 0; i < (len); i++) {               \
-      *(target)++ = (c)->A;                     \
-      *(target)++ = (c)->Y_R;                   \
-      *(target)++ = (c)->U_G;                   \
-      *(target)++ = (c)->V_B;                   \
-    }                                           \
-  } else {                                      \
-    (target) += 4 * (len);                      \
+  gint i;                                       \
+  if (pixel) {                                  \
+    for (i = 0; i < (len); i++)                 \
+      (target)[i] = (pixel);                    \
   }                                             \
+  (target) += (len);                            \
 } G_STMT_END
 
+/* Draws a run of @length pixels starting at @x on the cleared frame and
+ * returns the position after it */
+static inline guint32 *
+gst_draw_rle_run (RLE_state * state, guint32 * target, gint x, gint length,
+    gint colourid)
+{
+  guint32 pixel = state->pixels[colourid];
+
+  /* Check if this run of colour touches the highlight region */
+  if ((x <= state->hl_right) && (x + length) >= state->hl_left) {
+    gint run;
+
+    /* Draw to the left of the highlight */
+    if (x <= state->hl_left) {
+      run = MIN (length, state->hl_left - x + 1);
+
+      DRAW_RUN (target, run, pixel);
+      length -= run;
+      x += run;
+    }
+
+    /* Draw across the highlight region */
+    if (x <= state->hl_right) {
+      guint32 hl_pixel = state->hl_pixels[colourid];
+
+      run = MIN (length, state->hl_right - x + 1);
+
+      DRAW_RUN (target, run, hl_pixel);
+      length -= run;
+      x += run;
+    }
+  }
+
+  /* Draw the rest of the run */
+  if (length > 0)
+    DRAW_RUN (target, length, pixel);
+
+  return target;
+}
+
 /* 
- * This function steps over each run-length segment, drawing 
- * into the YUVA/ARGB buffers as it goes. UV are composited and then output
- * at half width/height
+ * This function steps over each run-length segment, filling in the
+ * colour indices of one line of the subpicture and drawing it into the
+ * YUVA/ARGB buffer if there is one.
  */
 static void
-gst_draw_rle_line (GstDvdSubDec * dec, guchar * buffer, RLE_state * state)
+gst_draw_rle_line (GstDvdSubDec * dec, RLE_state * state)
 {
   gint length, colourid;
   guint code;
   gint x, right;
-  guchar *target;
+  guint8 *target;
 
   target = state->target;
 
@@ -501,85 +610,50 @@ gst_draw_rle_line (GstDvdSubDec * dec, guchar * buffer, RLE_state * state)
   right = dec->right + 1;
 
   while (x < right) {
-    gboolean in_hl;
-    const Color_val *colour_entry;
-
-    code = gst_get_rle_code (buffer, state);
+    code = gst_get_rle_code (state);
     length = code >> 2;
     colourid = code & 3;
-    if (dec->use_ARGB)
-      colour_entry = dec->palette_cache_rgb + colourid;
-    else
-      colour_entry = dec->palette_cache_yuv + colourid;
 
     /* Length = 0 implies fill to the end of the line */
     /* Restrict the colour run to the end of the line */
     if (length == 0 || x + length > right)
       length = right - x;
 
-    /* Check if this run of colour touches the highlight region */
-    in_hl = ((x <= state->hl_right) && (x + length) >= state->hl_left);
-    if (in_hl) {
-      gint run;
-
-      /* Draw to the left of the highlight */
-      if (x <= state->hl_left) {
-        run = MIN (length, state->hl_left - x + 1);
-
-        DRAW_RUN (target, run, colour_entry);
-        length -= run;
-        x += run;
-      }
-
-      /* Draw across the highlight region */
-      if (x <= state->hl_right) {
-        const Color_val *hl_colour;
-        if (dec->use_ARGB)
-          hl_colour = dec->hl_palette_cache_rgb + colourid;
-        else
-          hl_colour = dec->hl_palette_cache_yuv + colourid;
-
-        run = MIN (length, state->hl_right - x + 1);
-
-        DRAW_RUN (target, run, hl_colour);
-        length -= run;
-        x += run;
-      }
-    }
-
-    /* Draw the rest of the run */
-    if (length > 0) {
-      DRAW_RUN (target, length, colour_entry);
-      x += length;
-    }
+    memset (target, colourid, length);
+    target += length;
+    if (state->pixel_target)
+      state->pixel_target = gst_draw_rle_run (state, state->pixel_target, x,
+          length, colourid);
+    x += length;
   }
 }
 
 /*
- * Decode the RLE subtitle image and blend with the current
- * frame buffer.
+ * Decode the RLE subtitle image into the colour index map. This only
+ * needs to happen once per subpicture, palette and highlight changes
+ * are applied when compositing. If @frame is not NULL and already
+ * cleared, the image is drawn onto it at the same time and TRUE is
+ * returned.
  */
-static void
-gst_dvd_sub_dec_merge_title (GstDvdSubDec * dec, GstVideoFrame * frame)
+static gboolean
+gst_dvd_sub_dec_decode_index (GstDvdSubDec * dec, GstVideoFrame * frame)
 {
   gint y;
-  gint Y_stride;
-  guchar *buffer = dec->partialmap.data;
-  gint hl_top, hl_bottom;
   gint last_y;
+  gint width, height;
+  gint hl_top, hl_bottom;
+  gint Y_stride = 0;
+  gint i;
+  guint8 *Y_data = NULL;
   RLE_state state;
-  guint8 *Y_data;
-
-  GST_DEBUG_OBJECT (dec, "Merging subtitle on frame");
 
-  Y_data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
-  Y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  GST_DEBUG_OBJECT (dec, "Decoding subpicture");
 
   state.id = 0;
-  state.aligned = 1;
-  state.next = 0;
-  state.offset[0] = dec->offset[0];
-  state.offset[1] = dec->offset[1];
+  state.pos[0] = 2 * dec->offset[0];
+  state.pos[1] = 2 * dec->offset[1];
+  state.data = dec->partialmap.data;
+  state.size = dec->partialmap.size;
 
   /* center the image when display rectangle exceeds the video width */
   if (dec->in_width <= dec->right) {
@@ -625,6 +699,40 @@ gst_dvd_sub_dec_merge_title (GstDvdSubDec * dec, GstVideoFrame * frame)
         dec->top, dec->in_height - 1);
   }
 
+  last_y = MIN (dec->bottom, dec->in_height);
+  width = MAX (dec->right - dec->left + 1, 0);
+  height = MAX (last_y - dec->top + 1, 0);
+
+  if (width * height > dec->index_alloc) {
+    g_free (dec->index_map);
+    dec->index_map = g_malloc (width * height);
+    dec->index_alloc = width * height;
+  }
+  dec->index_width = width;
+  dec->index_rows = 0;
+  dec->index_dirty = FALSE;
+
+  if (width == 0)
+    return FALSE;
+
+  /* Only draw when the display area fits in the frame */
+  if (frame && dec->left >= 0 && dec->right < GST_VIDEO_FRAME_WIDTH (frame)) {
+    Y_data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+    Y_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+
+    for (i = 0; i < 4; i++) {
+      if (dec->use_ARGB) {
+        state.pixels[i] = gst_pack_colour (dec->palette_cache_rgb + i, 0);
+        state.hl_pixels[i] = gst_pack_colour (dec->hl_palette_cache_rgb + i,
+            0);
+      } else {
+        state.pixels[i] = gst_pack_colour (dec->palette_cache_yuv + i, 0);
+        state.hl_pixels[i] = gst_pack_colour (dec->hl_palette_cache_yuv + i,
+            0);
+      }
+    }
+  }
+
   if (dec->current_button) {
     hl_top = dec->hl_top;
     hl_bottom = dec->hl_bottom;
@@ -632,13 +740,18 @@ gst_dvd_sub_dec_merge_title (GstDvdSubDec * dec, GstVideoFrame * frame)
     hl_top = -1;
     hl_bottom = -1;
   }
-  last_y = MIN (dec->bottom, dec->in_height);
 
   y = dec->top;
-  state.target = Y_data + 4 * dec->left + (y * Y_stride);
+  state.target = dec->index_map;
+
+  /* Now decode scanlines until we hit last_y or end of RLE data */
+  for (; (((gint) (state.pos[1] >> 1) < dec->data_size + 2) && (y <= last_y));
+      y++) {
+    if (Y_data && y < GST_VIDEO_FRAME_HEIGHT (frame))
+      state.pixel_target = (guint32 *) (Y_data + (y * Y_stride)) + dec->left;
+    else
+      state.pixel_target = NULL;
 
-  /* Now draw scanlines until we hit last_y or end of RLE data */
-  for (; ((state.offset[1] < dec->data_size + 2) && (y <= last_y)); y++) {
     /* Set up to draw the highlight if we're in the right scanlines */
     if (y > hl_bottom || y < hl_top) {
       state.hl_left = -1;
@@ -647,15 +760,112 @@ gst_dvd_sub_dec_merge_title (GstDvdSubDec * dec, GstVideoFrame * frame)
       state.hl_left = dec->hl_left;
       state.hl_right = dec->hl_right;
     }
-    gst_draw_rle_line (dec, buffer, &state);
+    gst_draw_rle_line (dec, &state);
 
-    state.target += Y_stride;
+    state.target += width;
+    dec->index_rows++;
 
     /* Realign the RLE state for the next line */
-    if (!state.aligned)
-      gst_get_nibble (buffer, &state);
+    state.pos[state.id] = (state.pos[state.id] + 1) & ~1;
     state.id = !state.id;
   }
+
+  return Y_data != NULL;
+}
+
+static inline void
+gst_composite_line (guint32 * target, const guint8 * index, gint len,
+    const guint32 * pixels)
+{
+  gint i;
+
+  for (i = 0; i < len; i++)
+    target[i] = pixels[index[i]];
+}
+
+/*
+ * Map the colour indices in the given rectangle (inclusive) of the
+ * subpicture to output pixels, using the highlight palette inside the
+ * current button area.
+ */
+static void
+gst_dvd_sub_dec_composite (GstDvdSubDec * dec, GstVideoFrame * frame,
+    gint left, gint top, gint right, gint bottom)
+{
+  guint32 pixels[4], hl_pixels[4];
+  guint32 clear;
+  guint8 *data;
+  gint stride;
+  gint hl_left, hl_top, hl_right, hl_bottom;
+  gint i, y;
+
+  left = MAX (left, dec->left);
+  right = MIN (right, dec->left + dec->index_width - 1);
+  right = MIN (right, GST_VIDEO_FRAME_WIDTH (frame) - 1);
+  top = MAX (top, dec->top);
+  bottom = MIN (bottom, dec->top + dec->index_rows - 1);
+  bottom = MIN (bottom, GST_VIDEO_FRAME_HEIGHT (frame) - 1);
+  if (left > right || top > bottom)
+    return;
+
+  clear = gst_get_clear_pixel (dec);
+  for (i = 0; i < 4; i++) {
+    if (dec->use_ARGB) {
+      pixels[i] = gst_pack_colour (dec->palette_cache_rgb + i, clear);
+      hl_pixels[i] = gst_pack_colour (dec->hl_palette_cache_rgb + i, clear);
+    } else {
+      pixels[i] = gst_pack_colour (dec->palette_cache_yuv + i, clear);
+      hl_pixels[i] = gst_pack_colour (dec->hl_palette_cache_yuv + i, clear);
+    }
+  }
+
+  /* The first highlighted pixel is the one after sx */
+  if (dec->current_button) {
+    hl_left = MAX (dec->hl_left + 1, left);
+    hl_right = MIN (dec->hl_right, right);
+    hl_top = dec->hl_top;
+    hl_bottom = dec->hl_bottom;
+  } else {
+    hl_left = hl_top = 0;
+    hl_right = hl_bottom = -1;
+  }
+
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+
+  for (y = top; y <= bottom; y++) {
+    guint32 *target = (guint32 *) (data + y * stride) + left;
+    const guint8 *index = dec->index_map +
+        (y - dec->top) * dec->index_width + (left - dec->left);
+
+    if (y < hl_top || y > hl_bottom || hl_left > hl_right) {
+      gst_composite_line (target, index, right - left + 1, pixels);
+      continue;
+    }
+
+    /* left of, across and right of the highlight */
+    gst_composite_line (target, index, hl_left - left, pixels);
+    gst_composite_line (target + (hl_left - left), index + (hl_left - left),
+        hl_right - hl_left + 1, hl_pixels);
+    gst_composite_line (target + (hl_right + 1 - left),
+        index + (hl_right + 1 - left), right - hl_right, pixels);
+  }
+}
+
+/*
+ * Render the subtitle image onto the current, cleared, frame buffer. A new
+ * subpicture is drawn while decoding, otherwise the index map is
+ * composited.
+ */
+static void
+gst_dvd_sub_dec_merge_title (GstDvdSubDec * dec, GstVideoFrame * frame)
+{
+  GST_DEBUG_OBJECT (dec, "Merging subtitle on frame");
+
+  if (dec->index_dirty && gst_dvd_sub_dec_decode_index (dec, frame))
+    return;
+
+  gst_dvd_sub_dec_composite (dec, frame, 0, 0, G_MAXINT, G_MAXINT);
 }
 
 static void
@@ -678,6 +888,8 @@ gst_send_subtitle_frame (GstDvdSubDec * dec, GstClockTime end_ts)
   GstBuffer *out_buf;
   GstVideoFrame frame;
   guint8 *data;
+  gint stride;
+  guint32 clear;
   gint x, y;
   static GstAllocationParams params = { 0, 3, 0, 0, };
 
@@ -685,47 +897,61 @@ gst_send_subtitle_frame (GstDvdSubDec * dec, GstClockTime end_ts)
   g_assert (dec->next_ts <= end_ts);
 
   /* Check if we need to redraw the output buffer */
-  if (!dec->buf_dirty) {
+  if (!dec->buf_dirty && !dec->hl_dirty) {
     flow = GST_FLOW_OK;
     goto out;
   }
 
-  out_buf =
-      gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&dec->info), &params);
-  gst_video_frame_map (&frame, &dec->info, out_buf, GST_MAP_READWRITE);
+  if (!dec->buf_dirty && dec->last_buf && !dec->index_dirty) {
+    /* Only the button highlight changed, so start from the previous frame
+     * and re-composite the old and new highlight areas */
+    GST_LOG_OBJECT (dec, "Redrawing highlight only");
 
-  data = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+    out_buf = gst_buffer_copy_deep (dec->last_buf);
+    gst_video_frame_map (&frame, &dec->info, out_buf, GST_MAP_READWRITE);
 
-  /* Clear the buffer */
-  /* FIXME - move this into the buffer rendering code */
-  for (y = 0; y < dec->in_height; y++) {
-    guchar *line = data + 4 * dec->in_width * y;
+    if (dec->last_hl_valid)
+      gst_dvd_sub_dec_composite (dec, &frame, dec->last_hl_left,
+          dec->last_hl_top, dec->last_hl_right, dec->last_hl_bottom);
+    if (dec->current_button)
+      gst_dvd_sub_dec_composite (dec, &frame, dec->hl_left, dec->hl_top,
+          dec->hl_right, dec->hl_bottom);
+  } else {
+    out_buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&dec->info),
+        &params);
+    gst_video_frame_map (&frame, &dec->info, out_buf, GST_MAP_READWRITE);
 
-    for (x = 0; x < dec->in_width; x++) {
-      line[0] = 0;              /* A */
-      if (!dec->use_ARGB) {
-        line[1] = 16;           /* Y */
-        line[2] = 128;          /* U */
-        line[3] = 128;          /* V */
-      } else {
-        line[1] = 0;            /* R */
-        line[2] = 0;            /* G */
-        line[3] = 0;            /* B */
-      }
+    data = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+    stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    /* Clear the buffer */
+    /* FIXME - move this into the buffer rendering code */
+    clear = gst_get_clear_pixel (dec);
+    for (y = 0; y < dec->in_height; y++) {
+      guint32 *line = (guint32 *) (data + stride * y);
 
-      line += 4;
+      for (x = 0; x < dec->in_width; x++)
+        line[x] = clear;
     }
-  }
 
-  /* FIXME: do we really want to honour the forced_display flag
-   * for subtitles streans? */
-  if (dec->visible || dec->forced_display) {
-    gst_dvd_sub_dec_merge_title (dec, &frame);
+    /* FIXME: do we really want to honour the forced_display flag
+     * for subtitles streans? */
+    if (dec->visible || dec->forced_display) {
+      gst_dvd_sub_dec_merge_title (dec, &frame);
+    }
   }
 
   gst_video_frame_unmap (&frame);
 
   dec->buf_dirty = FALSE;
+  dec->hl_dirty = FALSE;
+
+  dec->last_hl_valid = dec->current_button != 0;
+  dec->last_hl_left = dec->hl_left;
+  dec->last_hl_top = dec->hl_top;
+  dec->last_hl_right = dec->hl_right;
+  dec->last_hl_bottom = dec->hl_bottom;
+  gst_buffer_replace (&dec->last_buf, out_buf);
 
   GST_BUFFER_TIMESTAMP (out_buf) = dec->next_ts;
   if (GST_CLOCK_TIME_IS_VALID (dec->next_event_ts)) {
@@ -851,6 +1077,7 @@ gst_dvd_sub_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       dec->visible = FALSE;
 
       dec->have_title = TRUE;
+      dec->index_dirty = TRUE;
       dec->next_event_ts = GST_BUFFER_TIMESTAMP (dec->partialbuf);
 
       if (!GST_CLOCK_TIME_IS_VALID (dec->next_event_ts))
@@ -916,7 +1143,15 @@ gst_dvd_sub_dec_sink_setcaps (GstPad * pad, GstCaps * caps)
   GST_DEBUG_OBJECT (dec, "setting caps downstream to %" GST_PTR_FORMAT,
       out_caps);
   if (gst_pad_set_caps (dec->srcpad, out_caps)) {
+    gint old_width = GST_VIDEO_INFO_WIDTH (&dec->info);
+    gint old_height = GST_VIDEO_INFO_HEIGHT (&dec->info);
+
     gst_video_info_from_caps (&dec->info, out_caps);
+    gst_buffer_replace (&dec->last_buf, NULL);
+    /* the display area is centred and clipped against the frame size */
+    if (GST_VIDEO_INFO_WIDTH (&dec->info) != old_width ||
+        GST_VIDEO_INFO_HEIGHT (&dec->info) != old_height)
+      dec->index_dirty = TRUE;
   } else {
     GST_WARNING_OBJECT (dec, "failed setting downstream caps");
     gst_caps_unref (out_caps);
@@ -1025,6 +1260,7 @@ gst_dvd_sub_dec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* Turn off forced highlight display */
       dec->forced_display = 0;
       dec->current_button = 0;
+      gst_buffer_replace (&dec->last_buf, NULL);
 
       if (dec->partialbuf) {
         gst_buffer_unmap (dec->partialbuf, &dec->partialmap);
@@ -1093,7 +1329,7 @@ gst_dvd_sub_dec_handle_dvd_event (GstDvdSubDec * dec, GstEvent * event)
         "palette 0x%x", sx, sy, ex, ey, palette);
     gst_setup_palette (dec);
 
-    dec->buf_dirty = TRUE;
+    dec->hl_dirty = TRUE;
   } else if (strcmp (event_name, "dvd-spu-clut-change") == 0) {
     /* Take a copy of the colour table */
     gchar name[16];
@@ -1120,7 +1356,7 @@ gst_dvd_sub_dec_handle_dvd_event (GstDvdSubDec * dec, GstEvent * event)
     dec->current_button = 0;
 
     GST_LOG_OBJECT (dec, "Clearing button state");
-    dec->buf_dirty = TRUE;
+    dec->hl_dirty = TRUE;
   } else if (strcmp (event_name, "dvd-spu-still-frame") == 0) {
     /* Handle a still frame */
     GST_LOG_OBJECT (dec, "Received still frame notification");
@@ -92,6 +92,18 @@ struct _GstDvdSubDec
   GstClockTime next_event_ts;
 
   gboolean buf_dirty;
+
+  /* Colour indices of the decoded subpicture, one byte per pixel */
+  guint8 *index_map;
+  gint index_alloc;
+  gint index_width, index_rows;
+  gboolean index_dirty;
+
+  /* Last frame sent, so highlight changes only redraw the button areas */
+  GstBuffer *last_buf;
+  gboolean hl_dirty;
+  gboolean last_hl_valid;
+  gint last_hl_left, last_hl_top, last_hl_right, last_hl_bottom;
 };
 
 struct _GstDvdSubDecClass
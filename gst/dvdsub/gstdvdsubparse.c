@@ -110,6 +110,7 @@ gst_dvd_sub_parse_init (GstDvdSubParse * parse)
 
   /* remainder */
   parse->adapter = gst_adapter_new ();
+  parse->merge = TRUE;
   gst_dvd_sub_parse_reset (parse);
 }
 
@@ -152,6 +153,24 @@ gst_dvd_sub_parse_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return ret;
 }
 
+/* Downstream that answers the allocation query deals with the buffers as it
+ * gets them, so the fragments of a packet are passed on as they are. Anyone
+ * else, like dvdsubdec, maps the packets and gets them in one memory. */
+static void
+gst_dvd_sub_parse_check_downstream (GstDvdSubParse * parse)
+{
+  GstCaps *caps;
+  GstQuery *query;
+
+  caps = gst_static_pad_template_get_caps (&src_template);
+  query = gst_query_new_allocation (caps, FALSE);
+  parse->merge = !gst_pad_peer_query (parse->srcpad, query);
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  GST_DEBUG_OBJECT (parse, "%s the packet fragments",
+      parse->merge ? "merging" : "not merging");
+}
 
 static GstFlowReturn
 gst_dvd_sub_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
@@ -166,42 +185,61 @@ gst_dvd_sub_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GST_LOG_OBJECT (parse, "%" G_GSIZE_FORMAT " bytes, ts: %" GST_TIME_FORMAT,
       gst_buffer_get_size (buf), GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buf)));
 
-  gst_adapter_push (adapter, buf);
-
-  if (!parse->needed) {
-    guint8 data[2];
+  /* normally, we expect only the first fragment to carry a timestamp */
+  if (parse->needed && GST_BUFFER_TIMESTAMP_IS_VALID (buf))
+    GST_WARNING_OBJECT (parse, "Received more timestamps than expected.");
 
-    gst_adapter_copy (adapter, data, 0, 2);
-    parse->needed = GST_READ_UINT16_BE (data);
-  }
+  gst_adapter_push (adapter, buf);
 
-  if (GST_BUFFER_TIMESTAMP_IS_VALID (buf)) {
-    if (GST_CLOCK_TIME_IS_VALID (parse->stamp))
-      /* normally, we expect only the first fragment to carry a timestamp */
-      GST_WARNING_OBJECT (parse, "Received more timestamps than expected.");
-    else
-      parse->stamp = GST_BUFFER_TIMESTAMP (buf);
-  }
+  if (gst_pad_check_reconfigure (parse->srcpad))
+    gst_dvd_sub_parse_check_downstream (parse);
 
-  if (parse->needed) {
+  /* send along all complete packets */
+  while (ret == GST_FLOW_OK) {
     guint av;
 
     av = gst_adapter_available (adapter);
-    if (av >= parse->needed) {
-      if (av > parse->needed) {
-        /* normally, we expect several fragment, boundary aligned */
-        GST_WARNING_OBJECT (parse, "Unexpected: needed %d, "
-            "but more (%d) is available.", parse->needed, av);
-      }
-      outbuf = gst_adapter_take_buffer (adapter, parse->needed);
-      /* decorate buffer */
-      GST_BUFFER_TIMESTAMP (outbuf) = parse->stamp;
-      /* reset state */
-      parse->stamp = GST_CLOCK_TIME_NONE;
-      parse->needed = 0;
-      /* and send along */
-      ret = gst_pad_push (parse->srcpad, outbuf);
+
+    if (!parse->needed) {
+      guint8 data[2];
+      guint64 distance;
+
+      if (av < 2)
+        break;
+
+      gst_adapter_copy (adapter, data, 0, 2);
+      parse->needed = GST_READ_UINT16_BE (data);
+      if (!parse->needed)
+        break;
+
+      /* the packet takes the timestamp of the fragment it starts in, unless
+       * it starts in the middle of one after another packet */
+      parse->stamp = gst_adapter_prev_pts (adapter, &distance);
+      if (distance > 0)
+        parse->stamp = GST_CLOCK_TIME_NONE;
     }
+
+    if (av < parse->needed)
+      break;
+
+    if (av > parse->needed) {
+      GST_LOG_OBJECT (parse, "needed %d, but more (%d) is available",
+          parse->needed, av);
+    }
+
+    /* a packet within one fragment is never copied */
+    if (parse->merge)
+      outbuf = gst_adapter_take_buffer (adapter, parse->needed);
+    else
+      outbuf = gst_adapter_take_buffer_fast (adapter, parse->needed);
+    outbuf = gst_buffer_make_writable (outbuf);
+    /* decorate buffer */
+    GST_BUFFER_TIMESTAMP (outbuf) = parse->stamp;
+    /* reset state */
+    parse->stamp = GST_CLOCK_TIME_NONE;
+    parse->needed = 0;
+    /* and send along */
+    ret = gst_pad_push (parse->srcpad, outbuf);
   }
 
   return ret;
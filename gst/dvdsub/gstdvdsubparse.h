@@ -51,6 +51,7 @@ struct _GstDvdSubParse {
   GstAdapter   *adapter;   /* buffer incoming data                   */
   GstClockTime  stamp;     /* timestamp of current packet            */
   guint         needed;    /* size of current packet to be assembled */
+  gboolean      merge;     /* downstream needs packets in one memory */
 };
 
 struct _GstDvdSubParseClass {
@@ -24,6 +24,9 @@
 
 #define MAX_RULE_LENGTH	2048
 
+/* rulebooks of the sessions, shared by all of them */
+#define MAX_CACHED_RULEBOOKS 64
+
 /* define to enable some more debug */
 #undef DEBUG
 
@@ -86,6 +89,8 @@ gst_asm_operator_eval (GstASMOp optype, gfloat left, gfloat right)
   return result;
 }
 
+#ifdef TEST
+/* the tree walking evaluation that the compiled code replaces, to compare */
 static gfloat
 gst_asm_node_evaluate (GstASMNode * node, GHashTable * vars)
 {
@@ -125,6 +130,7 @@ gst_asm_node_evaluate (GstASMNode * node, GHashTable * vars)
   }
   return result;
 }
+#endif
 
 #define IS_SPACE(p) (((p) == ' ') || ((p) == '\n') || \
                      ((p) == '\r') || ((p) == '\t'))
@@ -467,7 +473,7 @@ gst_asm_scan_parse_operand (GstASMScan * scan)
     case GST_ASM_TOKEN_FLOAT:
       node = gst_asm_node_new ();
       node->type = GST_ASM_NODE_FLOAT;
-      node->data.floatval = atoi (scan->val);
+      node->data.floatval = (gfloat) atof (scan->val);
       break;
     case GST_ASM_TOKEN_LPAREN:
       gst_asm_scan_next_token (scan);
@@ -578,6 +584,7 @@ gst_asm_scan_parse_rule (GstASMScan * scan)
   return rule;
 }
 
+#ifdef TEST
 static gboolean
 gst_asm_rule_evaluate (GstASMRule * rule, GHashTable * vars)
 {
@@ -590,6 +597,157 @@ gst_asm_rule_evaluate (GstASMRule * rule, GHashTable * vars)
 
   return res;
 }
+#endif
+
+typedef struct
+{
+  GArray *code;
+  GPtrArray *var_names;
+
+  guint depth;
+  guint max_depth;
+} GstASMCompiler;
+
+static void
+gst_asm_compiler_emit (GstASMCompiler * comp, GstASMInstrType type,
+    GstASMInstr * instr)
+{
+  instr->type = type;
+  g_array_append_val (comp->code, *instr);
+
+  switch (type) {
+    case GST_ASM_INSTR_PUSH:
+    case GST_ASM_INSTR_LOAD:
+      comp->depth++;
+      comp->max_depth = MAX (comp->max_depth, comp->depth);
+      break;
+    case GST_ASM_INSTR_OPERATOR:
+      /* pops two values and pushes the result */
+      comp->depth--;
+      break;
+    case GST_ASM_INSTR_RETURN:
+      comp->depth = 0;
+      break;
+  }
+}
+
+static guint
+gst_asm_compiler_get_slot (GstASMCompiler * comp, const gchar * name)
+{
+  guint i;
+
+  for (i = 0; i < comp->var_names->len; i++) {
+    if (!strcmp (g_ptr_array_index (comp->var_names, i), name))
+      return i;
+  }
+  g_ptr_array_add (comp->var_names, g_strdup (name));
+
+  return i;
+}
+
+/* leaves the value of @node on the stack, like gst_asm_node_evaluate()
+ * returns it */
+static void
+gst_asm_node_compile (GstASMNode * node, GstASMCompiler * comp)
+{
+  GstASMInstr instr;
+
+  if (node == NULL) {
+    instr.data.value = 0.0;
+    gst_asm_compiler_emit (comp, GST_ASM_INSTR_PUSH, &instr);
+    return;
+  }
+
+  switch (node->type) {
+    case GST_ASM_NODE_VARIABLE:
+      instr.data.slot = gst_asm_compiler_get_slot (comp, node->data.varname);
+      gst_asm_compiler_emit (comp, GST_ASM_INSTR_LOAD, &instr);
+      break;
+    case GST_ASM_NODE_INTEGER:
+      instr.data.value = (gfloat) node->data.intval;
+      gst_asm_compiler_emit (comp, GST_ASM_INSTR_PUSH, &instr);
+      break;
+    case GST_ASM_NODE_FLOAT:
+      instr.data.value = node->data.floatval;
+      gst_asm_compiler_emit (comp, GST_ASM_INSTR_PUSH, &instr);
+      break;
+    case GST_ASM_NODE_OPERATOR:
+      gst_asm_node_compile (node->left, comp);
+      gst_asm_node_compile (node->right, comp);
+      instr.data.optype = node->data.optype;
+      gst_asm_compiler_emit (comp, GST_ASM_INSTR_OPERATOR, &instr);
+      break;
+    default:
+      instr.data.value = 0.0;
+      gst_asm_compiler_emit (comp, GST_ASM_INSTR_PUSH, &instr);
+      break;
+  }
+}
+
+/* lowers the conditions of all rules to one piece of stack code, with the
+ * variables resolved to slots */
+static void
+gst_asm_rule_book_compile (GstASMRuleBook * book)
+{
+  GstASMCompiler comp;
+  GstASMInstr instr;
+  GList *walk;
+  guint i;
+
+  comp.code = g_array_new (FALSE, FALSE, sizeof (GstASMInstr));
+  comp.var_names = g_ptr_array_new ();
+  comp.depth = 0;
+  comp.max_depth = 0;
+
+  book->rule_start = g_new (guint, book->n_rules);
+
+  for (walk = book->rules, i = 0; walk; walk = g_list_next (walk), i++) {
+    GstASMRule *rule = (GstASMRule *) walk->data;
+
+    book->rule_start[i] = comp.code->len;
+    if (rule->root) {
+      gst_asm_node_compile (rule->root, &comp);
+    } else {
+      /* no condition, always matches */
+      instr.data.value = 1.0;
+      gst_asm_compiler_emit (&comp, GST_ASM_INSTR_PUSH, &instr);
+    }
+    gst_asm_compiler_emit (&comp, GST_ASM_INSTR_RETURN, &instr);
+  }
+
+  book->n_vars = comp.var_names->len;
+  g_ptr_array_add (comp.var_names, NULL);
+  book->var_names = (gchar **) g_ptr_array_free (comp.var_names, FALSE);
+
+  book->stack_size = comp.max_depth;
+  book->code = (GstASMInstr *) g_array_free (comp.code, FALSE);
+}
+
+static gboolean
+gst_asm_rule_book_run (GstASMRuleBook * book, guint rule,
+    const gfloat * values, gfloat * stack)
+{
+  const GstASMInstr *instr;
+  guint sp = 0;
+
+  for (instr = &book->code[book->rule_start[rule]];; instr++) {
+    switch (instr->type) {
+      case GST_ASM_INSTR_PUSH:
+        stack[sp++] = instr->data.value;
+        break;
+      case GST_ASM_INSTR_LOAD:
+        stack[sp++] = values[instr->data.slot];
+        break;
+      case GST_ASM_INSTR_OPERATOR:
+        sp--;
+        stack[sp - 1] = gst_asm_operator_eval (instr->data.optype,
+            stack[sp - 1], stack[sp]);
+        break;
+      case GST_ASM_INSTR_RETURN:
+        return (gboolean) stack[0];
+    }
+  }
+}
 
 GstASMRuleBook *
 gst_asm_rule_book_new (const gchar * rulebook)
@@ -600,7 +758,8 @@ gst_asm_rule_book_new (const gchar * rulebook)
   GstASMToken token;
 
   book = g_new0 (GstASMRuleBook, 1);
-  book->rulebook = rulebook;
+  book->rulebook = g_strdup (rulebook);
+  book->refcount = 1;
 
   scan = gst_asm_scan_new (book->rulebook);
   gst_asm_scan_next_token (scan);
@@ -616,6 +775,47 @@ gst_asm_rule_book_new (const gchar * rulebook)
 
   gst_asm_scan_free (scan);
 
+  gst_asm_rule_book_compile (book);
+
+  return book;
+}
+
+static GMutex cache_lock;
+static GHashTable *cache;
+
+/* returns a rulebook for @rulebook that is shared with everyone that asked
+ * for the same one. Release it with gst_asm_rule_book_free(). */
+GstASMRuleBook *
+gst_asm_rule_book_new_cached (const gchar * rulebook)
+{
+  GstASMRuleBook *book;
+
+  g_mutex_lock (&cache_lock);
+  if (cache == NULL)
+    cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+        (GDestroyNotify) gst_asm_rule_book_free);
+
+  book = g_hash_table_lookup (cache, rulebook);
+  if (book == NULL) {
+    /* servers only use a few different rulebooks, so there is no need to
+     * keep track of which ones are used most */
+    if (g_hash_table_size (cache) >= MAX_CACHED_RULEBOOKS)
+      g_hash_table_remove_all (cache);
+
+    book = gst_asm_rule_book_new (rulebook);
+    g_hash_table_insert (cache, book->rulebook, book);
+  }
+  gst_asm_rule_book_ref (book);
+  g_mutex_unlock (&cache_lock);
+
+  return book;
+}
+
+GstASMRuleBook *
+gst_asm_rule_book_ref (GstASMRuleBook * book)
+{
+  g_atomic_int_inc (&book->refcount);
+
   return book;
 }
 
@@ -624,23 +824,98 @@ gst_asm_rule_book_free (GstASMRuleBook * book)
 {
   GList *walk;
 
+  if (!g_atomic_int_dec_and_test (&book->refcount))
+    return;
+
   for (walk = book->rules; walk; walk = g_list_next (walk)) {
     GstASMRule *rule = (GstASMRule *) walk->data;
 
     gst_asm_rule_free (rule);
   }
   g_list_free (book->rules);
+  g_free (book->code);
+  g_free (book->rule_start);
+  g_strfreev (book->var_names);
+  g_free (book->rulebook);
   g_free (book);
 }
 
+/* returns the slot of the variable @name in the values passed to
+ * gst_asm_rule_book_match_values(), or -1 if no rule uses it */
+gint
+gst_asm_rule_book_get_var_slot (GstASMRuleBook * book, const gchar * name)
+{
+  guint i;
+
+  for (i = 0; i < book->n_vars; i++) {
+    if (!strcmp (book->var_names[i], name))
+      return i;
+  }
+  return -1;
+}
+
 gint
 gst_asm_rule_book_match (GstASMRuleBook * book, GHashTable * vars,
     gint * rulematches)
+{
+  gfloat values_static[8] = { 0.0, }, *values;
+  guint i;
+  gint n;
+
+  values = book->n_vars <= G_N_ELEMENTS (values_static) ? values_static :
+      g_new (gfloat, book->n_vars);
+
+  for (i = 0; i < book->n_vars; i++) {
+    const gchar *val = g_hash_table_lookup (vars, book->var_names[i]);
+
+    values[i] = val ? (gfloat) atof (val) : 0.0;
+  }
+
+  n = gst_asm_rule_book_match_values (book, values, rulematches);
+
+  if (values != values_static)
+    g_free (values);
+
+  return n;
+}
+
+/* like gst_asm_rule_book_match() with the values of the variables given by
+ * slot, for evaluating the same rulebook many times */
+gint
+gst_asm_rule_book_match_values (GstASMRuleBook * book, const gfloat * values,
+    gint * rulematches)
+{
+  gfloat stack_static[32], *stack;
+  guint i;
+  gint n = 0;
+
+  stack = book->stack_size <= G_N_ELEMENTS (stack_static) ? stack_static :
+      g_new (gfloat, book->stack_size);
+
+  for (i = 0; i < book->n_rules && n < MAX_RULEMATCHES; i++) {
+    if (gst_asm_rule_book_run (book, i, values, stack))
+      rulematches[n++] = i;
+  }
+
+  if (stack != stack_static)
+    g_free (stack);
+
+  return n;
+}
+
+#ifdef TEST
+#define N_BANDWIDTHS 64
+#define N_ITERATIONS 200000
+
+static gint
+gst_asm_rule_book_match_tree (GstASMRuleBook * book, GHashTable * vars,
+    gint * rulematches)
 {
   GList *walk;
   gint i, n = 0;
 
-  for (walk = book->rules, i = 0; walk; walk = g_list_next (walk), i++) {
+  for (walk = book->rules, i = 0; walk && n < MAX_RULEMATCHES;
+      walk = g_list_next (walk), i++) {
     GstASMRule *rule = (GstASMRule *) walk->data;
 
     if (gst_asm_rule_evaluate (rule, vars)) {
@@ -650,7 +925,74 @@ gst_asm_rule_book_match (GstASMRuleBook * book, GHashTable * vars,
   return n;
 }
 
-#ifdef TEST
+/* checks that the compiled code matches the same rules as the trees and
+ * times both, for a sweep over the bandwidth */
+static void
+benchmark (const gchar * rules, GHashTable * vars)
+{
+  GstASMRuleBook *book, *cached;
+  gint tree_match[MAX_RULEMATCHES], code_match[MAX_RULEMATCHES];
+  gchar *strs[N_BANDWIDTHS];
+  gfloat values[N_BANDWIDTHS][4] = { {0.0,}, };
+  gint64 start, tree_time, hash_time, values_time;
+  gint i, n, slot, sum = 0;
+
+  book = gst_asm_rule_book_new_cached (rules);
+  cached = gst_asm_rule_book_new_cached (rules);
+  g_assert (book == cached);
+  gst_asm_rule_book_free (cached);
+
+  /* other variables are not set and stay 0 */
+  slot = gst_asm_rule_book_get_var_slot (book, "Bandwidth");
+  g_assert (book->n_vars <= G_N_ELEMENTS (values[0]));
+
+  for (i = 0; i < N_BANDWIDTHS; i++) {
+    gint bandwidth = i * 300000 / N_BANDWIDTHS;
+
+    strs[i] = g_strdup_printf ("%d", bandwidth);
+    if (slot >= 0)
+      values[i][slot] = bandwidth;
+
+    g_hash_table_insert (vars, (gchar *) "Bandwidth", strs[i]);
+    n = gst_asm_rule_book_match_tree (book, vars, tree_match);
+    g_assert (gst_asm_rule_book_match (book, vars, code_match) == n);
+    g_assert (!memcmp (tree_match, code_match, n * sizeof (gint)));
+    g_assert (gst_asm_rule_book_match_values (book, values[i],
+            code_match) == n);
+    g_assert (!memcmp (tree_match, code_match, n * sizeof (gint)));
+  }
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ITERATIONS; i++) {
+    g_hash_table_insert (vars, (gchar *) "Bandwidth", strs[i % N_BANDWIDTHS]);
+    sum += gst_asm_rule_book_match_tree (book, vars, tree_match);
+  }
+  tree_time = g_get_monotonic_time () - start;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ITERATIONS; i++) {
+    g_hash_table_insert (vars, (gchar *) "Bandwidth", strs[i % N_BANDWIDTHS]);
+    sum += gst_asm_rule_book_match (book, vars, code_match);
+  }
+  hash_time = g_get_monotonic_time () - start;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ITERATIONS; i++)
+    sum += gst_asm_rule_book_match_values (book, values[i % N_BANDWIDTHS],
+        code_match);
+  values_time = g_get_monotonic_time () - start;
+
+  g_print ("%u rules: tree %.1f ns, compiled %.1f ns, by slot %.1f ns per "
+      "match (%d)\n", book->n_rules, tree_time * 1000.0 / N_ITERATIONS,
+      hash_time * 1000.0 / N_ITERATIONS, values_time * 1000.0 / N_ITERATIONS,
+      sum);
+
+  g_hash_table_insert (vars, (gchar *) "Bandwidth", (gchar *) "300000");
+  for (i = 0; i < N_BANDWIDTHS; i++)
+    g_free (strs[i]);
+  gst_asm_rule_book_free (book);
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -705,6 +1047,10 @@ main (gint argc, gchar * argv[])
     g_print ("rule %d matched\n", rulematch[i]);
   }
 
+  benchmark (rules1, vars);
+  benchmark (rules2, vars);
+  benchmark (rules3, vars);
+
   g_hash_table_destroy (vars);
 
   return 0;
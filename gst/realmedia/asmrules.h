@@ -27,6 +27,7 @@ G_BEGIN_DECLS
 #define MAX_RULEMATCHES 16
 
 typedef struct _GstASMNode GstASMNode;
+typedef struct _GstASMInstr GstASMInstr;
 typedef struct _GstASMRule GstASMRule;
 typedef struct _GstASMRuleBook GstASMRuleBook;
 
@@ -92,24 +93,61 @@ struct _GstASMNode {
   GstASMNode     *right;
 };
 
+typedef enum {
+  GST_ASM_INSTR_PUSH,
+  GST_ASM_INSTR_LOAD,
+  GST_ASM_INSTR_OPERATOR,
+  GST_ASM_INSTR_RETURN
+} GstASMInstrType;
+
+/* one step of the stack code that the conditions are compiled to */
+struct _GstASMInstr {
+  GstASMInstrType type;
+
+  union {
+    gfloat   value;
+    guint    slot;
+    GstASMOp optype;
+  } data;
+};
+
 struct _GstASMRule {
   GstASMNode *root;
   GHashTable *props;
 };
 
 struct _GstASMRuleBook {
-  const gchar *rulebook;
+  gchar       *rulebook;
 
   guint        n_rules;
   GList       *rules;
+
+  /* the conditions of all rules, compiled */
+  GstASMInstr *code;
+  guint       *rule_start;      /* where the code of each rule starts */
+  guint        stack_size;
+
+  /* the variables, a value for each slot is passed to the code */
+  gchar      **var_names;
+  guint        n_vars;
+
+  gint         refcount;
 };
 
 G_END_DECLS
 
 GstASMRuleBook*   gst_asm_rule_book_new     (const gchar *rulebook);
+GstASMRuleBook*   gst_asm_rule_book_new_cached (const gchar *rulebook);
+GstASMRuleBook*   gst_asm_rule_book_ref     (GstASMRuleBook *book);
 void              gst_asm_rule_book_free    (GstASMRuleBook *book);
 
+gint              gst_asm_rule_book_get_var_slot (GstASMRuleBook *book,
+                                             const gchar *name);
+
 gint              gst_asm_rule_book_match   (GstASMRuleBook *book, GHashTable *vars, 
 		                             gint *rulematches);
+gint              gst_asm_rule_book_match_values (GstASMRuleBook *book,
+                                             const gfloat *values,
+                                             gint *rulematches);
 
 #endif /* __GST_ASM_RULES_H__ */
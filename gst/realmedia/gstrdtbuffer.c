@@ -49,10 +49,66 @@ gst_rdt_buffer_get_packet_count (GstBuffer * buffer)
   return count;
 }
 
+/* parse the fields of the data packet header at @data so that the accessors
+ * don't have to map the buffer again */
+static gboolean
+read_data_header (GstRDTPacket * packet, const guint8 * data)
+{
+  gboolean length_included_flag;
+  gboolean need_reliable_flag;
+  guint8 asm_rule_number;
+  guint header;
+
+  length_included_flag = (data[0] & 0x80) == 0x80;
+  need_reliable_flag = (data[0] & 0x40) == 0x40;
+  packet->stream_id = (data[0] & 0x3e) >> 1;
+
+  /* read seq_no */
+  packet->seq = GST_READ_UINT16_BE (&data[1]);
+
+  /* skip seq_no and header bits */
+  header = 3;
+
+  if (length_included_flag) {
+    /* skip length */
+    header += 2;
+  }
+  /* flags and asm_rule_number, followed by the timestamp */
+  if (header + 5 > packet->length)
+    return FALSE;
+
+  packet->flags = data[header];
+  asm_rule_number = (data[header] & 0x3f);
+  packet->timestamp = GST_READ_UINT32_BE (&data[header + 1]);
+  header += 5;
+
+  if (packet->stream_id == 31) {
+    /* stream_id_expansion */
+    if (header + 2 > packet->length)
+      return FALSE;
+    packet->stream_id = GST_READ_UINT16_BE (&data[header]);
+    header += 2;
+  }
+  if (need_reliable_flag) {
+    /* skip total_reliable */
+    header += 2;
+  }
+  if (asm_rule_number == 63) {
+    /* skip asm_rule_number_expansion */
+    header += 2;
+  }
+  if (header > packet->length)
+    return FALSE;
+
+  packet->data_offset = header;
+
+  return TRUE;
+}
+
+/* reads the header at the current offset from the mapping of the walk */
 static gboolean
 read_packet_header (GstRDTPacket * packet)
 {
-  GstMapInfo map;
   guint8 *data;
   gsize size;
   guint offset;
@@ -60,11 +116,10 @@ read_packet_header (GstRDTPacket * packet)
   guint length_offset;
 
   g_return_val_if_fail (packet != NULL, FALSE);
-  g_return_val_if_fail (GST_IS_BUFFER (packet->buffer), FALSE);
+  g_return_val_if_fail (packet->map.data != NULL, FALSE);
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
-  data = map.data;
-  size = map.size;
+  data = packet->map.data;
+  size = packet->map.size;
 
   offset = packet->offset;
 
@@ -163,29 +218,32 @@ read_packet_header (GstRDTPacket * packet)
     packet->length = length;
   } else if (length_offset != -1) {
     /* we can read the length from an offset */
-    packet->length = GST_READ_UINT16_BE (&data[length_offset]);
+    if (offset + length_offset + 2 > size)
+      goto invalid_length;
+    packet->length = GST_READ_UINT16_BE (&data[offset + length_offset]);
   } else {
     /* length is remainder of packet */
     packet->length = size - offset;
   }
-  gst_buffer_unmap (packet->buffer, &map);
 
   /* the length should be smaller than the remaining size */
   if (packet->length + offset > size)
     goto invalid_length;
 
+  if (GST_RDT_IS_DATA_TYPE (packet->type)
+      && !read_data_header (packet, &data[offset]))
+    goto invalid_length;
+
   return TRUE;
 
   /* ERRORS */
 packet_end:
   {
-    gst_buffer_unmap (packet->buffer, &map);
     return FALSE;
   }
 unknown_packet:
   {
     packet->type = GST_RDT_TYPE_INVALID;
-    gst_buffer_unmap (packet->buffer, &map);
     return FALSE;
   }
 invalid_length:
@@ -196,6 +254,9 @@ invalid_length:
   }
 }
 
+/* The buffer is mapped once for the walk over its packets. It is unmapped
+ * when there are no more packets, a walk that stops before that has to end
+ * with gst_rdt_packet_unmap(). */
 gboolean
 gst_rdt_buffer_get_first_packet (GstBuffer * buffer, GstRDTPacket * packet)
 {
@@ -206,10 +267,16 @@ gst_rdt_buffer_get_first_packet (GstBuffer * buffer, GstRDTPacket * packet)
   packet->buffer = buffer;
   packet->offset = 0;
   packet->type = GST_RDT_TYPE_INVALID;
-  memset (&packet->map, 0, sizeof (GstMapInfo));
 
-  if (!read_packet_header (packet))
+  if (!gst_buffer_map (buffer, &packet->map, GST_MAP_READ)) {
+    memset (&packet->map, 0, sizeof (GstMapInfo));
     return FALSE;
+  }
+
+  if (!read_packet_header (packet)) {
+    gst_rdt_packet_unmap (packet);
+    return FALSE;
+  }
 
   return TRUE;
 }
@@ -239,10 +306,25 @@ gst_rdt_packet_move_to_next (GstRDTPacket * packet)
 end:
   {
     packet->type = GST_RDT_TYPE_INVALID;
+    gst_rdt_packet_unmap (packet);
     return FALSE;
   }
 }
 
+/* ends the walk over the packets of the buffer, does nothing when it ended
+ * already */
+void
+gst_rdt_packet_unmap (GstRDTPacket * packet)
+{
+  g_return_if_fail (packet != NULL);
+
+  if (packet->map.data == NULL)
+    return;
+
+  gst_buffer_unmap (packet->buffer, &packet->map);
+  packet->map.data = NULL;
+}
+
 GstRDTType
 gst_rdt_packet_get_type (GstRDTPacket * packet)
 {
@@ -285,82 +367,78 @@ gst_rdt_buffer_compare_seqnum (guint16 seqnum1, guint16 seqnum2)
   return (gint16) (seqnum2 - seqnum1);
 }
 
-guint16
-gst_rdt_packet_data_get_seq (GstRDTPacket * packet)
+/* makes an ACK packet for the @n_seqs data packets of @stream_id up to and
+ * including @last_seq. Bit i of @lost, most significant bit first, is set when
+ * packet @last_seq - @n_seqs + 1 + i was not received. The lost_high flag is
+ * set to tell the server that the set bits are the missing packets. */
+GstBuffer *
+gst_rdt_buffer_new_ack (guint16 stream_id, guint16 last_seq, guint16 n_seqs,
+    const guint8 * lost)
 {
+  GstBuffer *buffer;
   GstMapInfo map;
-  guint header;
-  guint16 result;
-
-  g_return_val_if_fail (packet != NULL, FALSE);
-  g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), FALSE);
+  guint n_bytes, length;
+
+  n_bytes = (n_seqs + 7) / 8;
+  length = 11 + n_bytes;
+
+  buffer = gst_buffer_new_allocate (NULL, length, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  /* length_included_flag and lost_high */
+  map.data[0] = 0xc0;
+  GST_WRITE_UINT16_BE (&map.data[1], GST_RDT_TYPE_ACK);
+  GST_WRITE_UINT16_BE (&map.data[3], length);
+  GST_WRITE_UINT16_BE (&map.data[5], stream_id);
+  GST_WRITE_UINT16_BE (&map.data[7], last_seq);
+  GST_WRITE_UINT16_BE (&map.data[9], n_seqs);
+  memcpy (&map.data[11], lost, n_bytes);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
+/* makes a latency report, @server_out_time is the timestamp of the last data
+ * packet we received */
+GstBuffer *
+gst_rdt_buffer_new_latency_report (guint32 server_out_time)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
 
-  /* skip header bits */
-  header = packet->offset + 1;
+  buffer = gst_buffer_new_allocate (NULL, 9, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  /* length_included_flag */
+  map.data[0] = 0x80;
+  GST_WRITE_UINT16_BE (&map.data[1], GST_RDT_TYPE_LATENCY);
+  GST_WRITE_UINT16_BE (&map.data[3], 9);
+  GST_WRITE_UINT32_BE (&map.data[5], server_out_time);
+  gst_buffer_unmap (buffer, &map);
 
-  /* read seq_no */
-  result = GST_READ_UINT16_BE (&map.data[header]);
+  return buffer;
+}
 
-  gst_buffer_unmap (packet->buffer, &map);
+guint16
+gst_rdt_packet_data_get_seq (GstRDTPacket * packet)
+{
+  g_return_val_if_fail (packet != NULL, FALSE);
+  g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), FALSE);
 
-  return result;
+  return packet->seq;
 }
 
+/* the payload is in the mapping of the walk, it stays valid until the walk
+ * ends */
 guint8 *
 gst_rdt_packet_data_map (GstRDTPacket * packet, guint * size)
 {
-  GstMapInfo map;
-  guint header;
-  gboolean length_included_flag;
-  gboolean need_reliable_flag;
-  guint8 stream_id;
-  guint8 asm_rule_number;
-
   g_return_val_if_fail (packet != NULL, NULL);
-  g_return_val_if_fail (packet->map.data == NULL, NULL);
+  g_return_val_if_fail (packet->map.data != NULL, NULL);
   g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), NULL);
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
-
-  header = packet->offset;
-
-  length_included_flag = (map.data[header] & 0x80) == 0x80;
-  need_reliable_flag = (map.data[header] & 0x40) == 0x40;
-  stream_id = (map.data[header] & 0x3e) >> 1;
-
-  /* skip seq_no and header bits */
-  header += 3;
-
-  if (length_included_flag) {
-    /* skip length */
-    header += 2;
-  }
-  asm_rule_number = (map.data[header] & 0x3f);
-
-  /* skip timestamp and asm_rule_number */
-  header += 5;
-
-  if (stream_id == 0x1f) {
-    /* skip stream_id_expansion */
-    header += 2;
-  }
-  if (need_reliable_flag) {
-    /* skip total_reliable */
-    header += 2;
-  }
-  if (asm_rule_number == 63) {
-    /* skip asm_rule_number_expansion */
-    header += 2;
-  }
-
   if (size)
-    *size = packet->length - (header - packet->offset);
+    *size = packet->length - packet->data_offset;
 
-  packet->map = map;
-
-  return &map.data[header];
+  return &packet->map.data[packet->offset + packet->data_offset];
 }
 
 gboolean
@@ -369,109 +447,33 @@ gst_rdt_packet_data_unmap (GstRDTPacket * packet)
   g_return_val_if_fail (packet != NULL, FALSE);
   g_return_val_if_fail (packet->map.data != NULL, FALSE);
 
-  gst_buffer_unmap (packet->buffer, &packet->map);
-  packet->map.data = NULL;
-
+  /* nothing to do, the walk keeps the buffer mapped */
   return TRUE;
 }
 
 guint16
 gst_rdt_packet_data_get_stream_id (GstRDTPacket * packet)
 {
-  GstMapInfo map;
-  guint16 result;
-  guint header;
-  gboolean length_included_flag;
-
   g_return_val_if_fail (packet != NULL, 0);
   g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), 0);
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
-
-  header = packet->offset;
-
-  length_included_flag = (map.data[header] & 0x80) == 0x80;
-  result = (map.data[header] & 0x3e) >> 1;
-  if (result == 31) {
-    /* skip seq_no and header bits */
-    header += 3;
-
-    if (length_included_flag) {
-      /* skip length */
-      header += 2;
-    }
-    /* skip asm_rule_number and timestamp */
-    header += 5;
-
-    /* stream_id_expansion */
-    result = GST_READ_UINT16_BE (&map.data[header]);
-  }
-  gst_buffer_unmap (packet->buffer, &map);
-
-  return result;
+  return packet->stream_id;
 }
 
 guint32
 gst_rdt_packet_data_get_timestamp (GstRDTPacket * packet)
 {
-  GstMapInfo map;
-  guint header;
-  gboolean length_included_flag;
-  guint32 result;
-
   g_return_val_if_fail (packet != NULL, 0);
   g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), 0);
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
-
-  header = packet->offset;
-
-  length_included_flag = (map.data[header] & 0x80) == 0x80;
-
-  /* skip seq_no and header bits */
-  header += 3;
-
-  if (length_included_flag) {
-    /* skip length */
-    header += 2;
-  }
-  /* skip asm_rule_number */
-  header += 1;
-
-  /* get timestamp */
-  result = GST_READ_UINT32_BE (&map.data[header]);
-  gst_buffer_unmap (packet->buffer, &map);
-
-  return result;
+  return packet->timestamp;
 }
 
 guint8
 gst_rdt_packet_data_get_flags (GstRDTPacket * packet)
 {
-  GstMapInfo map;
-  guint8 result;
-  guint header;
-  gboolean length_included_flag;
-
   g_return_val_if_fail (packet != NULL, 0);
   g_return_val_if_fail (GST_RDT_IS_DATA_TYPE (packet->type), 0);
 
-  gst_buffer_map (packet->buffer, &map, GST_MAP_READ);
-
-  header = packet->offset;
-
-  length_included_flag = (map.data[header] & 0x80) == 0x80;
-
-  /* skip seq_no and header bits */
-  header += 3;
-
-  if (length_included_flag) {
-    /* skip length */
-    header += 2;
-  }
-  /* get flags */
-  result = map.data[header];
-  gst_buffer_unmap (packet->buffer, &map);
-
-  return result;
+  return packet->flags;
 }
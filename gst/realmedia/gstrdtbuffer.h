@@ -86,7 +86,14 @@ struct _GstRDTPacket
   /*< private >*/
   GstRDTType   type;         /* type of current packet */
   guint16      length;       /* length of current packet in bytes */
-  GstMapInfo   map;          /* last mapped data */
+  GstMapInfo   map;          /* @buffer, mapped during the walk */
+
+  /* data packet header, parsed when moving to the packet */
+  guint16      seq;
+  guint16      stream_id;
+  guint32      timestamp;
+  guint8       flags;
+  guint16      data_offset;  /* offset of the payload in the packet */
 };
 
 /* validate buffers */
@@ -97,6 +104,7 @@ gboolean        gst_rdt_buffer_validate           (GstBuffer *buffer);
 guint           gst_rdt_buffer_get_packet_count   (GstBuffer *buffer);
 gboolean        gst_rdt_buffer_get_first_packet   (GstBuffer *buffer, GstRDTPacket *packet);
 gboolean        gst_rdt_packet_move_to_next       (GstRDTPacket *packet);
+void            gst_rdt_packet_unmap              (GstRDTPacket *packet);
 
 /* working with packets */
 GstRDTType      gst_rdt_packet_get_type           (GstRDTPacket *packet);
@@ -116,6 +124,11 @@ guint8          gst_rdt_packet_data_get_flags     (GstRDTPacket * packet);
 /* utils */
 gint            gst_rdt_buffer_compare_seqnum     (guint16 seqnum1, guint16 seqnum2);
 
+/* making packets */
+GstBuffer*      gst_rdt_buffer_new_ack            (guint16 stream_id, guint16 last_seq,
+                                                   guint16 n_seqs, const guint8 *lost);
+GstBuffer*      gst_rdt_buffer_new_latency_report (guint32 server_out_time);
+
 G_END_DECLS
 
 #endif /* __GST_RDTBUFFER_H__ */
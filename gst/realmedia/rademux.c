@@ -59,6 +59,10 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 GST_DEBUG_CATEGORY_STATIC (real_audio_demux_debug);
 #define GST_CAT_DEFAULT real_audio_demux_debug
 
+/* how much data to pull at once in pull mode, rounded down to whole
+ * packets */
+#define DATA_BLOCK_SIZE (64 * 1024)
+
 #define gst_real_audio_demux_parent_class parent_class
 G_DEFINE_TYPE (GstRealAudioDemux, gst_real_audio_demux, GST_TYPE_ELEMENT);
 
@@ -131,6 +135,7 @@ gst_real_audio_demux_reset (GstRealAudioDemux * demux)
   demux->ra_version = 0;
   demux->data_offset = 0;
   demux->packet_size = 0;
+  demux->block_size = 0;
 
   demux->sample_rate = 0;
   demux->sample_width = 0;
@@ -321,6 +326,7 @@ gst_real_audio_demux_parse_header (GstRealAudioDemux * demux)
   GstCaps *caps = NULL;
   GstEvent *event;
   gchar *stream_id;
+  guint32 interleaver = 0;
   guint avail;
 
   g_assert (demux->ra_version == 4 || demux->ra_version == 3);
@@ -363,6 +369,7 @@ gst_real_audio_demux_parse_header (GstRealAudioDemux * demux)
       demux->sample_rate = GST_READ_UINT16_BE (data + 42);
       demux->sample_width = GST_READ_UINT16_BE (data + 46);
       demux->channels = GST_READ_UINT16_BE (data + 48);
+      interleaver = GST_READ_UINT32_LE (data + 51);
       demux->fourcc = GST_READ_UINT32_LE (data + 56);
       demux->pending_tags = gst_rm_utils_read_tags (data + 63,
           demux->data_offset - 63, gst_rm_utils_read_string8);
@@ -393,6 +400,15 @@ gst_real_audio_demux_parse_header (GstRealAudioDemux * demux)
   GST_INFO_OBJECT (demux, "fourcc       = '%" GST_FOURCC_FORMAT "' (%08X)",
       GST_FOURCC_ARGS (demux->fourcc), demux->fourcc);
 
+  /* interleaved data can only be decoded from the start of a block of
+   * height packets */
+  demux->block_size = demux->packet_size;
+  if (interleaver != 0 && interleaver != GST_MAKE_FOURCC ('I', 'n', 't', '0')
+      && demux->height > 1 && demux->packet_size <= G_MAXUINT / demux->height)
+    demux->block_size = demux->packet_size * demux->height;
+  GST_INFO_OBJECT (demux, "interleaver  = '%" GST_FOURCC_FORMAT "', "
+      "block_size = %u", GST_FOURCC_ARGS (interleaver), demux->block_size);
+
   switch (demux->fourcc) {
     case GST_RM_AUD_14_4:
       caps = gst_caps_new_simple ("audio/x-pn-realaudio", "raversion",
@@ -531,10 +547,38 @@ broken_file:
 
 }
 
+/* returns the offset of the block that contains @ts and its timestamp. The
+ * packets are CBR, so the byte rate gives the offset. */
+static guint64
+gst_real_audio_demux_get_block_offset (GstRealAudioDemux * demux,
+    GstClockTime ts, GstClockTime * block_ts)
+{
+  guint64 offset;
+
+  offset = gst_util_uint64_scale (ts, demux->byterate_num,
+      demux->byterate_denom * GST_SECOND);
+  if (demux->block_size > 0) {
+    offset -= offset % demux->block_size;
+
+    /* don't go past the last complete block */
+    if (demux->upstream_size > demux->data_offset + demux->block_size &&
+        offset + demux->data_offset + demux->block_size >
+        demux->upstream_size) {
+      offset = demux->upstream_size - demux->data_offset - demux->block_size;
+      offset -= offset % demux->block_size;
+    }
+  }
+  offset += demux->data_offset;
+
+  *block_ts = gst_real_demux_get_timestamp_from_offset (demux, offset);
+  return offset;
+}
+
 static GstFlowReturn
 gst_real_audio_demux_parse_data (GstRealAudioDemux * demux)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstBufferList *list = NULL;
+  gboolean pull_mode;
   guint avail, unit_size;
 
   avail = gst_adapter_available (demux->adapter);
@@ -546,38 +590,57 @@ gst_real_audio_demux_parse_data (GstRealAudioDemux * demux)
 
   GST_LOG_OBJECT (demux, "available = %u, unit_size = %u", avail, unit_size);
 
-  while (ret == GST_FLOW_OK && unit_size > 0 && avail >= unit_size) {
+  /* in pull mode, the data in the adapter ends at the read offset */
+  pull_mode = GST_PAD_MODE (demux->sinkpad) == GST_PAD_MODE_PULL;
+
+  while (unit_size > 0 && avail >= unit_size) {
     GstClockTime ts;
     GstBuffer *buf;
+    guint64 offset;
 
+    offset = pull_mode ? demux->offset - avail : demux->offset;
+
+    /* sub-buffers of what we pulled, if the packet is in one piece */
     buf = gst_adapter_take_buffer (demux->adapter, unit_size);
     avail -= unit_size;
 
-    if (demux->need_newsegment) {
-      gst_pad_push_event (demux->srcpad,
-          gst_event_new_segment (&demux->segment));
-      demux->need_newsegment = FALSE;
-    }
+    if (list == NULL) {
+      if (demux->need_newsegment) {
+        gst_pad_push_event (demux->srcpad,
+            gst_event_new_segment (&demux->segment));
+        demux->need_newsegment = FALSE;
+      }
 
-    if (demux->pending_tags) {
-      gst_pad_push_event (demux->srcpad,
-          gst_event_new_tag (demux->pending_tags));
-      demux->pending_tags = NULL;
+      if (demux->pending_tags) {
+        gst_pad_push_event (demux->srcpad,
+            gst_event_new_tag (demux->pending_tags));
+        demux->pending_tags = NULL;
+      }
+
+      list = gst_buffer_list_new_sized (avail / unit_size + 1);
     }
 
     if (demux->fourcc == GST_RM_AUD_DNET) {
       buf = gst_rm_utils_descramble_dnet_buffer (buf);
     }
 
-    ts = gst_real_demux_get_timestamp_from_offset (demux, demux->offset);
+    ts = gst_real_demux_get_timestamp_from_offset (demux, offset);
     GST_BUFFER_TIMESTAMP (buf) = ts;
 
     demux->segment.position = ts;
 
-    ret = gst_pad_push (demux->srcpad, buf);
+    gst_buffer_list_add (list, buf);
+
+    /* the rest is beyond the end of the segment */
+    if (demux->segment.stop != -1 && GST_CLOCK_TIME_IS_VALID (ts) &&
+        ts > demux->segment.stop)
+      break;
   }
 
-  return ret;
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  return gst_pad_push_list (demux->srcpad, list);
 }
 
 static GstFlowReturn
@@ -627,7 +690,7 @@ gst_real_audio_demux_loop (GstRealAudioDemux * demux)
 {
   GstFlowReturn ret;
   GstBuffer *buf;
-  guint bytes_needed;
+  guint bytes_needed, size;
 
   /* check how much data we need */
   switch (demux->state) {
@@ -642,9 +705,10 @@ gst_real_audio_demux_loop (GstRealAudioDemux * demux)
     case REAL_AUDIO_DEMUX_STATE_DATA:
       if (demux->packet_size > 0) {
         /* TODO: should probably take into account width/height as well? */
-        bytes_needed = demux->packet_size;
+        bytes_needed = MAX (DATA_BLOCK_SIZE -
+            DATA_BLOCK_SIZE % demux->packet_size, demux->packet_size);
       } else {
-        bytes_needed = 1024;
+        bytes_needed = DATA_BLOCK_SIZE;
       }
       break;
     default:
@@ -661,18 +725,30 @@ gst_real_audio_demux_loop (GstRealAudioDemux * demux)
   buf = NULL;
   ret = gst_pad_pull_range (demux->sinkpad, demux->offset, bytes_needed, &buf);
 
+  if (ret == GST_FLOW_EOS && demux->state == REAL_AUDIO_DEMUX_STATE_DATA)
+    goto eos;
   if (ret != GST_FLOW_OK)
     goto pull_range_error;
 
-  if (gst_buffer_get_size (buf) != bytes_needed)
+  size = gst_buffer_get_size (buf);
+  /* only the data may end early, the headers are needed in full */
+  if (size != bytes_needed && demux->state != REAL_AUDIO_DEMUX_STATE_DATA)
     goto pull_range_short_read;
 
+  /* TODO: increase this in chain function too (for timestamps)? */
+  demux->offset += size;
+
   ret = gst_real_audio_demux_handle_buffer (demux, buf);
   if (ret != GST_FLOW_OK)
     goto handle_flow_error;
 
-  /* TODO: increase this in chain function too (for timestamps)? */
-  demux->offset += bytes_needed;
+  if (size < bytes_needed) {
+    GST_DEBUG_OBJECT (demux, "short read of %u bytes at the end, dropping "
+        "%" G_GSIZE_FORMAT " bytes of incomplete packet", size,
+        gst_adapter_available (demux->adapter));
+    gst_adapter_clear (demux->adapter);
+    goto eos;
+  }
 
   /* check for the end of the segment */
   if (demux->segment.stop != -1 && demux->segment.position != -1 &&
@@ -702,8 +778,7 @@ pull_range_error:
 pull_range_short_read:
   {
     GST_WARNING_OBJECT (demux, "pull range short read: wanted %u bytes, but "
-        "got only %" G_GSIZE_FORMAT " bytes", bytes_needed,
-        gst_buffer_get_size (buf));
+        "got only %u bytes", bytes_needed, size);
     gst_buffer_unref (buf);
     goto eos;
   }
@@ -777,6 +852,7 @@ gst_real_audio_demux_handle_seek (GstRealAudioDemux * demux, GstEvent * event)
   gboolean flush, update;
   gdouble rate;
   guint64 seek_pos;
+  GstClockTime seek_ts;
   gint64 cur, stop;
 
   if (!demux->seekable)
@@ -813,14 +889,18 @@ gst_real_audio_demux_handle_seek (GstRealAudioDemux * demux, GstEvent * event)
 
   GST_DEBUG_OBJECT (demux, "segment: %" GST_SEGMENT_FORMAT, &demux->segment);
 
-  seek_pos = gst_util_uint64_scale (demux->segment.start,
-      demux->byterate_num, demux->byterate_denom * GST_SECOND);
-  if (demux->packet_size > 0) {
-    seek_pos -= seek_pos % demux->packet_size;
-  }
-  seek_pos += demux->data_offset;
+  /* start at the interleave block, so the decoder can start right away */
+  seek_pos = gst_real_audio_demux_get_block_offset (demux,
+      demux->segment.start, &seek_ts);
+
+  GST_DEBUG_OBJECT (demux, "seek_pos = %" G_GUINT64_FORMAT ", block at %"
+      GST_TIME_FORMAT, seek_pos, GST_TIME_ARGS (seek_ts));
 
-  GST_DEBUG_OBJECT (demux, "seek_pos = %" G_GUINT64_FORMAT, seek_pos);
+  if ((flags & GST_SEEK_FLAG_KEY_UNIT) != 0 && GST_CLOCK_TIME_IS_VALID (seek_ts)
+      && cur_type != GST_SEEK_TYPE_NONE) {
+    demux->segment.start = demux->segment.time = seek_ts;
+    demux->segment.position = seek_ts;
+  }
 
   /* stop flushing */
   gst_pad_push_event (demux->sinkpad, gst_event_new_flush_stop (TRUE));
@@ -828,6 +908,8 @@ gst_real_audio_demux_handle_seek (GstRealAudioDemux * demux, GstEvent * event)
 
   demux->offset = seek_pos;
   demux->need_newsegment = TRUE;
+  /* the rest of the block that was pulled last */
+  gst_adapter_clear (demux->adapter);
 
   /* notify start of new segment */
   if (demux->segment.flags & GST_SEEK_FLAG_SEGMENT) {
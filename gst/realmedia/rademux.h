@@ -65,6 +65,7 @@ struct _GstRealAudioDemux {
   guint                    leaf_size;
   guint                    height;
   guint                    flavour;
+  guint                    block_size;      /* seeks go to multiples of this */
 
   guint                    sample_rate;
   guint                    sample_width;
@@ -274,11 +274,9 @@ create_segment_event (GstRDTDepay * depay, gboolean update,
   return gst_event_new_segment (&segment);
 }
 
-static GstFlowReturn
-gst_rdt_depay_push (GstRDTDepay * rdtdepay, GstBuffer * buffer)
+static void
+gst_rdt_depay_check_newsegment (GstRDTDepay * rdtdepay)
 {
-  GstFlowReturn ret;
-
   if (rdtdepay->need_newsegment) {
     GstEvent *event;
 
@@ -287,6 +285,14 @@ gst_rdt_depay_push (GstRDTDepay * rdtdepay, GstBuffer * buffer)
 
     rdtdepay->need_newsegment = FALSE;
   }
+}
+
+static GstFlowReturn
+gst_rdt_depay_push (GstRDTDepay * rdtdepay, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+
+  gst_rdt_depay_check_newsegment (rdtdepay);
 
   if (rdtdepay->discont) {
     GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
@@ -297,15 +303,16 @@ gst_rdt_depay_push (GstRDTDepay * rdtdepay, GstBuffer * buffer)
   return ret;
 }
 
-static GstFlowReturn
+/* Writes the 12 byte RealMedia packet header for @packet into @header and
+ * returns a buffer sharing the payload memory of the RDT buffer, or NULL
+ * when the packet is dropped. */
+static GstBuffer *
 gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
-    GstRDTPacket * packet)
+    GstRDTPacket * packet, guint8 * header)
 {
-  GstFlowReturn ret;
   GstBuffer *outbuf;
-  GstMapInfo outmap;
-  guint8 *data, *outdata;
-  guint size;
+  guint8 *data;
+  guint size, offset;
   guint16 stream_id;
   guint32 timestamp;
   gint gap;
@@ -313,11 +320,10 @@ gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
   guint8 flags;
   guint16 outflags;
 
-  /* get pointers to the packet data */
+  /* find the payload in the packet */
   data = gst_rdt_packet_data_map (packet, &size);
-
-  outbuf = gst_buffer_new_and_alloc (12 + size);
-  GST_BUFFER_TIMESTAMP (outbuf) = outtime;
+  offset = data - packet->map.data;
+  gst_rdt_packet_data_unmap (packet);
 
   GST_DEBUG_OBJECT (rdtdepay, "have size %u", size);
 
@@ -366,31 +372,32 @@ gst_rdt_depay_handle_data (GstRDTDepay * rdtdepay, GstClockTime outtime,
   else
     outflags = 0;
 
-  gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
-  outdata = outmap.data;
-  GST_WRITE_UINT16_BE (outdata + 0, 0); /* version   */
-  GST_WRITE_UINT16_BE (outdata + 2, size + 12); /* length    */
-  GST_WRITE_UINT16_BE (outdata + 4, stream_id); /* stream    */
-  GST_WRITE_UINT32_BE (outdata + 6, timestamp); /* timestamp */
-  GST_WRITE_UINT16_BE (outdata + 10, outflags); /* flags     */
-  memcpy (outdata + 12, data, size);
-  gst_buffer_unmap (outbuf, &outmap);
-  gst_buffer_resize (outbuf, 0, 12 + size);
+  GST_WRITE_UINT16_BE (header + 0, 0);  /* version   */
+  GST_WRITE_UINT16_BE (header + 2, size + 12);  /* length    */
+  GST_WRITE_UINT16_BE (header + 4, stream_id);  /* stream    */
+  GST_WRITE_UINT32_BE (header + 6, timestamp);  /* timestamp */
+  GST_WRITE_UINT16_BE (header + 10, outflags);  /* flags     */
 
-  gst_rdt_packet_data_unmap (packet);
+  /* the payload is not copied, the header is prepended by the caller */
+  outbuf = gst_buffer_copy_region (packet->buffer, GST_BUFFER_COPY_MEMORY,
+      offset, size);
+  GST_BUFFER_TIMESTAMP (outbuf) = outtime;
 
-  GST_DEBUG_OBJECT (rdtdepay, "Pushing packet, outtime %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (outtime));
+  if (rdtdepay->discont) {
+    GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    rdtdepay->discont = FALSE;
+  }
 
-  ret = gst_rdt_depay_push (rdtdepay, outbuf);
+  GST_DEBUG_OBJECT (rdtdepay, "Have packet, outtime %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (outtime));
 
-  return ret;
+  return outbuf;
 
   /* ERRORS */
 dropping:
   {
     GST_WARNING_OBJECT (rdtdepay, "%d <= 100, dropping old packet", gap);
-    return GST_FLOW_OK;
+    return NULL;
   }
 }
 
@@ -402,6 +409,10 @@ gst_rdt_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GstClockTime timestamp;
   gboolean more;
   GstRDTPacket packet;
+  GstBufferList *list;
+  GstMemory *headers;
+  GstMapInfo hmap;
+  guint n_packets, i, len;
 
   rdtdepay = GST_RDT_DEPAY (parent);
 
@@ -428,6 +439,17 @@ gst_rdt_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GST_LOG_OBJECT (rdtdepay, "received buffer timestamp %" GST_TIME_FORMAT,
       GST_TIME_ARGS (timestamp));
 
+  n_packets = gst_rdt_buffer_get_packet_count (buf);
+  if (n_packets == 0)
+    goto done;
+
+  /* the RealMedia headers of all packets go into one block of memory, every
+   * output buffer gets a 12 byte slice of it in front of its payload */
+  headers = gst_allocator_alloc (NULL, 12 * n_packets, NULL);
+  gst_memory_map (headers, &hmap, GST_MAP_WRITE);
+
+  list = gst_buffer_list_new_sized (n_packets);
+
   /* data is in RDT format. */
   more = gst_rdt_buffer_get_first_packet (buf, &packet);
   while (more) {
@@ -437,8 +459,14 @@ gst_rdt_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     GST_DEBUG_OBJECT (rdtdepay, "Have packet of type %04x", type);
 
     if (GST_RDT_IS_DATA_TYPE (type)) {
+      GstBuffer *outbuf;
+
       GST_DEBUG_OBJECT (rdtdepay, "We have a data packet");
-      ret = gst_rdt_depay_handle_data (rdtdepay, timestamp, &packet);
+      len = gst_buffer_list_length (list);
+      outbuf = gst_rdt_depay_handle_data (rdtdepay, timestamp, &packet,
+          hmap.data + 12 * len);
+      if (outbuf)
+        gst_buffer_list_add (list, outbuf);
     } else {
       switch (type) {
         default:
@@ -446,12 +474,27 @@ gst_rdt_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
           break;
       }
     }
-    if (ret != GST_FLOW_OK)
-      break;
-
     more = gst_rdt_packet_move_to_next (&packet);
   }
+  gst_memory_unmap (headers, &hmap);
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++) {
+    GstBuffer *outbuf = gst_buffer_list_get (list, i);
+
+    gst_buffer_prepend_memory (outbuf, gst_memory_share (headers, 12 * i, 12));
+  }
+  gst_memory_unref (headers);
+
+  if (len > 0) {
+    GST_DEBUG_OBJECT (rdtdepay, "Pushing %u packets", len);
+    gst_rdt_depay_check_newsegment (rdtdepay);
+    ret = gst_pad_push_list (rdtdepay->srcpad, list);
+  } else {
+    gst_buffer_list_unref (list);
+  }
 
+done:
   gst_buffer_unref (buf);
 
   return ret;
@@ -25,8 +25,9 @@
 GST_DEBUG_CATEGORY_STATIC (rdt_jitter_buffer_debug);
 #define GST_CAT_DEFAULT rdt_jitter_buffer_debug
 
-#define MAX_WINDOW	RDT_JITTER_BUFFER_MAX_WINDOW
-#define MAX_TIME	(2 * GST_SECOND)
+#define DEFAULT_MAX_WINDOW	RDT_JITTER_BUFFER_MAX_WINDOW
+#define DEFAULT_MAX_TIME	RDT_JITTER_BUFFER_MAX_TIME
+#define DEFAULT_SKEW_WEIGHT	RDT_JITTER_BUFFER_SKEW_WEIGHT
 
 /* signals and args */
 enum
@@ -36,11 +37,18 @@ enum
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_WINDOW_SIZE,
+  PROP_WINDOW_TIME,
+  PROP_SKEW_WEIGHT
 };
 
 /* GObject vmethods */
 static void rdt_jitter_buffer_finalize (GObject * object);
+static void rdt_jitter_buffer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void rdt_jitter_buffer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 /* static guint rdt_jitter_buffer_signals[LAST_SIGNAL] = { 0 }; */
 
@@ -54,6 +62,23 @@ rdt_jitter_buffer_class_init (RDTJitterBufferClass * klass)
   gobject_class = (GObjectClass *) klass;
 
   gobject_class->finalize = rdt_jitter_buffer_finalize;
+  gobject_class->set_property = rdt_jitter_buffer_set_property;
+  gobject_class->get_property = rdt_jitter_buffer_get_property;
+
+  /* changing these resets the skew estimation */
+  g_object_class_install_property (gobject_class, PROP_WINDOW_SIZE,
+      g_param_spec_uint ("window-size", "Window size",
+          "Maximum number of measurements in the skew window", 1, G_MAXUINT16,
+          DEFAULT_MAX_WINDOW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_WINDOW_TIME,
+      g_param_spec_uint64 ("window-time", "Window time",
+          "Maximum time in ns covered by the skew window", 1, G_MAXUINT64,
+          DEFAULT_MAX_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_SKEW_WEIGHT,
+      g_param_spec_uint ("skew-weight", "Skew weight",
+          "Number of window minimums the skew is averaged over", 1,
+          G_MAXUINT16, DEFAULT_SKEW_WEIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   GST_DEBUG_CATEGORY_INIT (rdt_jitter_buffer_debug, "rdtjitterbuffer", 0,
       "RDT Jitter Buffer");
@@ -63,6 +88,10 @@ static void
 rdt_jitter_buffer_init (RDTJitterBuffer * jbuf)
 {
   jbuf->packets = g_queue_new ();
+  jbuf->max_window = DEFAULT_MAX_WINDOW;
+  jbuf->max_time = DEFAULT_MAX_TIME;
+  jbuf->skew_weight = DEFAULT_SKEW_WEIGHT;
+  jbuf->window = g_new (RDTSkewSample, jbuf->max_window);
 
   rdt_jitter_buffer_reset_skew (jbuf);
 }
@@ -76,10 +105,61 @@ rdt_jitter_buffer_finalize (GObject * object)
 
   rdt_jitter_buffer_flush (jbuf);
   g_queue_free (jbuf->packets);
+  g_free (jbuf->window);
 
   G_OBJECT_CLASS (rdt_jitter_buffer_parent_class)->finalize (object);
 }
 
+static void
+rdt_jitter_buffer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  RDTJitterBuffer *jbuf;
+
+  jbuf = RDT_JITTER_BUFFER_CAST (object);
+
+  switch (prop_id) {
+    case PROP_WINDOW_SIZE:
+      jbuf->max_window = g_value_get_uint (value);
+      jbuf->window = g_renew (RDTSkewSample, jbuf->window, jbuf->max_window);
+      break;
+    case PROP_WINDOW_TIME:
+      jbuf->max_time = g_value_get_uint64 (value);
+      break;
+    case PROP_SKEW_WEIGHT:
+      jbuf->skew_weight = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      return;
+  }
+  rdt_jitter_buffer_reset_skew (jbuf);
+}
+
+static void
+rdt_jitter_buffer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  RDTJitterBuffer *jbuf;
+
+  jbuf = RDT_JITTER_BUFFER_CAST (object);
+
+  switch (prop_id) {
+    case PROP_WINDOW_SIZE:
+      g_value_set_uint (value, jbuf->max_window);
+      break;
+    case PROP_WINDOW_TIME:
+      g_value_set_uint64 (value, jbuf->max_time);
+      break;
+    case PROP_SKEW_WEIGHT:
+      g_value_set_uint (value, jbuf->skew_weight);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 /**
  * rdt_jitter_buffer_new:
  *
@@ -103,13 +183,52 @@ rdt_jitter_buffer_reset_skew (RDTJitterBuffer * jbuf)
   jbuf->base_time = -1;
   jbuf->base_rtptime = -1;
   jbuf->ext_rtptime = -1;
-  jbuf->window_pos = 0;
+  jbuf->window_head = 0;
+  jbuf->window_len = 0;
+  jbuf->window_count = 0;
+  jbuf->window_size = 0;
   jbuf->window_filling = TRUE;
-  jbuf->window_min = 0;
   jbuf->skew = 0;
   jbuf->prev_send_diff = -1;
 }
 
+/* adds the drift @delta to the skew window and returns the minimum of the
+ * window */
+static gint64
+skew_window_push (RDTJitterBuffer * jbuf, gint64 delta)
+{
+  RDTSkewSample *sample;
+  guint64 index;
+  guint tail;
+
+  index = jbuf->window_count++;
+
+  /* the measurements with a bigger delta can't become the minimum anymore */
+  while (jbuf->window_len > 0) {
+    tail = (jbuf->window_head + jbuf->window_len - 1) % jbuf->max_window;
+    if (jbuf->window[tail].delta < delta)
+      break;
+    jbuf->window_len--;
+  }
+
+  /* the measurements that slid out of the window */
+  if (!jbuf->window_filling) {
+    while (jbuf->window_len > 0
+        && jbuf->window[jbuf->window_head].index + jbuf->window_size <= index) {
+      jbuf->window_head = (jbuf->window_head + 1) % jbuf->max_window;
+      jbuf->window_len--;
+    }
+  }
+
+  tail = (jbuf->window_head + jbuf->window_len) % jbuf->max_window;
+  sample = &jbuf->window[tail];
+  sample->index = index;
+  sample->delta = delta;
+  jbuf->window_len++;
+
+  return jbuf->window[jbuf->window_head].delta;
+}
+
 /* For the clock skew we use a windowed low point averaging algorithm as can be
  * found in http://www.grame.fr/pub/TR-050601.pdf. The idea is that the jitter is
  * composed of:
@@ -160,11 +279,19 @@ rdt_jitter_buffer_reset_skew (RDTJitterBuffer * jbuf)
  * of the drift estimation. Finding the correct parameters turns out to be a
  * compromise between accuracy and inertia. 
  *
- * We use a 2 second window or up to 512 data points, which is statistically big
- * enough to catch spikes (FIXME, detect spikes).
+ * By default we use a 2 second window or up to 512 data points, which is
+ * statistically big enough to catch spikes (FIXME, detect spikes).
  * We also use a rather large weighting factor (125) to smoothly adapt. During
  * startup, when filling the window, we use a parabolic weighting factor, the
  * more the window is filled, the faster we move to the detected possible skew.
+ * The window-size, window-time and skew-weight properties change these.
+ *
+ * The minimum of the window is kept in a deque of the measurements that can
+ * still become the minimum: a new measurement removes the ones before it with
+ * a bigger or equal delta, which can never be the minimum again, and the
+ * oldest ones leave the deque when they slide out of the window. The deltas
+ * in the deque increase and the minimum is the oldest one, so each
+ * measurement costs O(1) amortized time.
  *
  * Returns: @time adjusted with the clock skew.
  */
@@ -174,9 +301,7 @@ calculate_skew (RDTJitterBuffer * jbuf, guint32 rtptime, GstClockTime time,
 {
   guint64 ext_rtptime;
   guint64 send_diff, recv_diff;
-  gint64 delta;
-  gint64 old;
-  gint pos, i;
+  gint64 delta, window_min;
   GstClockTime gstrtptime, out_time;
 
   //ext_rtptime = gst_rtp_buffer_ext_timestamp (&jbuf->ext_rtptime, rtptime);
@@ -243,32 +368,29 @@ again:
   /* measure the diff */
   delta = ((gint64) recv_diff) - ((gint64) send_diff);
 
-  pos = jbuf->window_pos;
+  window_min = skew_window_push (jbuf, delta);
 
   if (jbuf->window_filling) {
     /* we are filling the window */
-    GST_DEBUG ("filling %d, delta %" G_GINT64_FORMAT, pos, delta);
-    jbuf->window[pos++] = delta;
-    /* calc the min delta we observed */
-    if (pos == 1 || delta < jbuf->window_min)
-      jbuf->window_min = delta;
+    GST_DEBUG ("filling %" G_GUINT64_FORMAT ", delta %" G_GINT64_FORMAT,
+        jbuf->window_count, delta);
 
-    if (send_diff >= MAX_TIME || pos >= MAX_WINDOW) {
-      jbuf->window_size = pos;
+    if (send_diff >= jbuf->max_time || jbuf->window_count >= jbuf->max_window) {
+      jbuf->window_size = jbuf->window_count;
 
       /* window filled */
-      GST_DEBUG ("min %" G_GINT64_FORMAT, jbuf->window_min);
+      GST_DEBUG ("min %" G_GINT64_FORMAT, window_min);
 
       /* the skew is now the min */
-      jbuf->skew = jbuf->window_min;
+      jbuf->skew = window_min;
       jbuf->window_filling = FALSE;
     } else {
       gint perc_time, perc_window, perc;
 
       /* figure out how much we filled the window, this depends on the amount of
        * time we have or the max number of points we keep. */
-      perc_time = send_diff * 100 / MAX_TIME;
-      perc_window = pos * 100 / MAX_WINDOW;
+      perc_time = send_diff * 100 / jbuf->max_time;
+      perc_window = jbuf->window_count * 100 / jbuf->max_window;
       perc = MAX (perc_time, perc_window);
 
       /* make a parabolic function, the closer we get to the MAX, the more value
@@ -277,44 +399,15 @@ again:
 
       /* quickly go to the min value when we are filling up, slowly when we are
        * just starting because we're not sure it's a good value yet. */
-      jbuf->skew =
-          (perc * jbuf->window_min + ((10000 - perc) * jbuf->skew)) / 10000;
-      jbuf->window_size = pos + 1;
+      jbuf->skew = (perc * window_min + ((10000 - perc) * jbuf->skew)) / 10000;
     }
   } else {
-    /* pick old value and store new value. We keep the previous value in order
-     * to quickly check if the min of the window changed */
-    old = jbuf->window[pos];
-    jbuf->window[pos++] = delta;
-
-    if (delta <= jbuf->window_min) {
-      /* if the new value we inserted is smaller or equal to the current min,
-       * it becomes the new min */
-      jbuf->window_min = delta;
-    } else if (old == jbuf->window_min) {
-      gint64 min = G_MAXINT64;
-
-      /* if we removed the old min, we have to find a new min */
-      for (i = 0; i < jbuf->window_size; i++) {
-        /* we found another value equal to the old min, we can stop searching now */
-        if (jbuf->window[i] == old) {
-          min = old;
-          break;
-        }
-        if (jbuf->window[i] < min)
-          min = jbuf->window[i];
-      }
-      jbuf->window_min = min;
-    }
     /* average the min values */
-    jbuf->skew = (jbuf->window_min + (124 * jbuf->skew)) / 125;
+    jbuf->skew = (window_min + ((gint64) jbuf->skew_weight - 1) * jbuf->skew) /
+        jbuf->skew_weight;
     GST_DEBUG ("delta %" G_GINT64_FORMAT ", new min: %" G_GINT64_FORMAT,
-        delta, jbuf->window_min);
+        delta, window_min);
   }
-  /* wrap around in the window */
-  if (pos >= jbuf->window_size)
-    pos = 0;
-  jbuf->window_pos = pos;
 
 no_skew:
   /* the output time is defined as the base timestamp plus the RDT time
@@ -364,6 +457,7 @@ rdt_jitter_buffer_insert (RDTJitterBuffer * jbuf, GstBuffer * buf,
    * receive time, this function will retimestamp @buf with the skew corrected
    * running time. */
   rtptime = gst_rdt_packet_data_get_timestamp (&packet);
+  gst_rdt_packet_unmap (&packet);
 
   /* loop the list to skip strictly smaller seqnum buffers */
   for (list = jbuf->packets->head; list; list = g_list_next (list)) {
@@ -376,6 +470,7 @@ rdt_jitter_buffer_insert (RDTJitterBuffer * jbuf, GstBuffer * buf,
     g_return_val_if_fail (more == TRUE, FALSE);
 
     qseq = gst_rdt_packet_data_get_seq (&packet);
+    gst_rdt_packet_unmap (&packet);
 
     /* compare the new seqnum to the one in the buffer */
     gap = gst_rdt_buffer_compare_seqnum (seqnum, qseq);
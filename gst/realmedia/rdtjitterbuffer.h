@@ -42,6 +42,16 @@ typedef struct _RDTJitterBufferClass RDTJitterBufferClass;
 typedef void (*RTPTailChanged) (RDTJitterBuffer *jbuf, gpointer user_data);
 
 #define RDT_JITTER_BUFFER_MAX_WINDOW 512
+#define RDT_JITTER_BUFFER_MAX_TIME   (2 * GST_SECOND)
+#define RDT_JITTER_BUFFER_SKEW_WEIGHT 125
+
+/* a drift measurement in the skew window, @index counts the measurements since
+ * the last reset */
+typedef struct {
+  guint64        index;
+  gint64         delta;
+} RDTSkewSample;
+
 /**
  * RDTJitterBuffer:
  *
@@ -52,15 +62,23 @@ struct _RDTJitterBuffer {
 
   GQueue        *packets;
 
+  /* properties */
+  guint          max_window;
+  GstClockTime   max_time;
+  guint          skew_weight;
+
   /* for calculating skew */
   GstClockTime   base_time;
   GstClockTime   base_rtptime;
   guint64        ext_rtptime;
-  gint64         window[RDT_JITTER_BUFFER_MAX_WINDOW];
-  guint          window_pos;
+  /* the samples of the window that can still become the minimum, a ring of
+   * max_window entries with increasing deltas, the minimum at window_head */
+  RDTSkewSample *window;
+  guint          window_head;
+  guint          window_len;
+  guint64        window_count;
   guint          window_size;
   gboolean       window_filling;
-  gint64         window_min;
   gint64         skew;
   gint64         prev_send_diff;
 };
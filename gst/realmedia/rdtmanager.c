@@ -47,6 +47,27 @@
  * @see_also: GstRtspSrc
  *
  * A simple RTP session manager used internally by rtspsrc.
+ *
+ * Packets are held back for #GstRDTManager:latency after they are received
+ * so that missing packets have time to arrive. Packets still missing when
+ * the next packet is due are lost, and packets that arrive after that are
+ * dropped. With #GstRDTManager:do-lost, a loss is announced downstream with
+ * a "GstRDTPacketLost" custom event that has the first lost "seqnum", the
+ * "count" of lost packets and the "timestamp" of the packet after them.
+ *
+ * Receive statistics are kept for every session: packets lost according to
+ * the gaps in the sequence numbers, packets that arrived out of order, late or
+ * twice, and the interarrival jitter. They are available in the
+ * #GstRDTManager:stats property and, with #GstRDTManager:stats-interval, are
+ * posted as element messages. With #GstRDTManager:report-interval, ACK and
+ * latency report packets are sent to the server on the rtcp_src pad of the
+ * session.
+ *
+ * Every second, the rate at which a session receives data is posted in an
+ * "application/x-rdt-receive-rate" element message with the "session" and its
+ * "bitrate". When the caps of the session come from rtspreal, the rate is
+ * also passed to it. If rtspreal selects other stream rules for the rates, we
+ * ask rtspsrc to send the SET_PARAMETER request that subscribes to them.
  */
 
 /* #define HAVE_RTCP */
@@ -54,10 +75,12 @@
 #include "gstrdtbuffer.h"
 #include "rdtmanager.h"
 #include "rdtjitterbuffer.h"
+#include "rtspreal.h"
 
 #include <gst/glib-compat-private.h>
 
 #include <stdio.h>
+#include <string.h>
 
 GST_DEBUG_CATEGORY_STATIC (rdtmanager_debug);
 #define GST_CAT_DEFAULT (rdtmanager_debug)
@@ -81,11 +104,33 @@ enum
 };
 
 #define DEFAULT_LATENCY_MS      200
+#define DEFAULT_DO_LOST         FALSE
+
+#define DEFAULT_STATS_INTERVAL  0
+#define DEFAULT_REPORT_INTERVAL 0
+#define DEFAULT_WINDOW_SIZE     RDT_JITTER_BUFFER_MAX_WINDOW
+#define DEFAULT_WINDOW_TIME     RDT_JITTER_BUFFER_MAX_TIME
+#define DEFAULT_SKEW_WEIGHT     RDT_JITTER_BUFFER_SKEW_WEIGHT
+
+/* how often the receive rate is reported */
+#define RATE_INTERVAL           GST_SECOND
+
+/* RDT sequence numbers wrap at 0xff00, the values above are packet types */
+#define RDT_SEQ_RANGE           0xff00
+/* the most packets one ACK report covers */
+#define ACK_WINDOW              1024
 
 enum
 {
   PROP_0,
-  PROP_LATENCY
+  PROP_LATENCY,
+  PROP_DO_LOST,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_REPORT_INTERVAL,
+  PROP_WINDOW_SIZE,
+  PROP_WINDOW_TIME,
+  PROP_SKEW_WEIGHT
 };
 
 static GstStaticPadTemplate gst_rdt_manager_recv_rtp_sink_template =
@@ -113,7 +158,7 @@ static GstStaticPadTemplate gst_rdt_manager_rtcp_src_template =
 GST_STATIC_PAD_TEMPLATE ("rtcp_src_%u",
     GST_PAD_SRC,
     GST_PAD_REQUEST,
-    GST_STATIC_CAPS ("application/x-rtcp")
+    GST_STATIC_CAPS ("application/x-rtcp; application/x-rdt")
     );
 
 static void gst_rdt_manager_finalize (GObject * object);
@@ -171,6 +216,30 @@ static guint gst_rdt_manager_signals[LAST_SIGNAL] = { 0 };
  * There is one such structure for each RTP session (audio/video/...).
  * We get the RTP/RTCP packets and stuff them into the session manager. 
  */
+/* updated for every data packet that is not a duplicate */
+typedef struct
+{
+  guint64 packets_received;
+  guint64 bytes_received;
+
+  /* extended sequence numbers of the first and highest packet */
+  gboolean have_seq;
+  guint64 base_seq;
+  guint64 max_seq;
+
+  guint64 packets_reordered;
+  guint max_reorder_depth;
+
+  /* interarrival jitter in nanoseconds, as in RFC 3550 */
+  gboolean have_transit;
+  gint64 transit;
+  guint64 jitter;
+
+  /* of the last packet, for the latency report */
+  guint16 stream_id;
+  guint32 rdt_timestamp;
+} RDTSessionStats;
+
 struct _GstRDTManagerSession
 {
   /* session id */
@@ -216,6 +285,21 @@ struct _GstRDTManagerSession
   /* some accounting */
   guint64 num_late;
   guint64 num_duplicates;
+  RDTSessionStats stats;
+  GstClockTime last_stats_time;
+  GstClockTime last_report_time;
+  gboolean rtcp_started;
+
+  /* for the ACK reports, bit i is set when ack_seq + i was received */
+  guint16 ack_seq;
+  guint ack_len;
+  guint8 ack_bits[ACK_WINDOW / 8];
+
+  /* the rtspreal that wants our receive rate, 0 for none */
+  guint real_context;
+  /* the bytes received since rate_start */
+  GstClockTime rate_start;
+  guint64 rate_bytes;
 };
 
 /* find a session with the given id */
@@ -233,6 +317,15 @@ find_session_by_id (GstRDTManager * rdtmanager, gint id)
   return NULL;
 }
 
+/* passes the skew estimation properties to the jitterbuffer of @session */
+static void
+gst_rdt_manager_session_configure (GstRDTManagerSession * session,
+    guint window_size, guint64 window_time, guint skew_weight)
+{
+  g_object_set (session->jbuf, "window-size", window_size,
+      "window-time", window_time, "skew-weight", skew_weight, NULL);
+}
+
 /* create a session with the given id */
 static GstRDTManagerSession *
 create_session (GstRDTManager * rdtmanager, gint id)
@@ -242,10 +335,17 @@ create_session (GstRDTManager * rdtmanager, gint id)
   sess = g_new0 (GstRDTManagerSession, 1);
   sess->id = id;
   sess->dec = rdtmanager;
+  sess->rate_start = GST_CLOCK_TIME_NONE;
+  sess->last_stats_time = GST_CLOCK_TIME_NONE;
+  sess->last_report_time = GST_CLOCK_TIME_NONE;
   sess->jbuf = rdt_jitter_buffer_new ();
   g_mutex_init (&sess->jbuf_lock);
   g_cond_init (&sess->jbuf_cond);
+  GST_OBJECT_LOCK (rdtmanager);
+  gst_rdt_manager_session_configure (sess, rdtmanager->window_size,
+      rdtmanager->window_time, rdtmanager->skew_weight);
   rdtmanager->sessions = g_slist_prepend (rdtmanager->sessions, sess);
+  GST_OBJECT_UNLOCK (rdtmanager);
 
   return sess;
 }
@@ -421,11 +521,101 @@ gst_rdt_manager_class_init (GstRDTManagerClass * g_class)
   gobject_class->set_property = gst_rdt_manager_set_property;
   gobject_class->get_property = gst_rdt_manager_get_property;
 
+  /**
+   * GstRDTManager:latency:
+   *
+   * The time a packet is held back after it was received. Missing packets
+   * must arrive within this time or they are considered lost.
+   */
   g_object_class_install_property (gobject_class, PROP_LATENCY,
       g_param_spec_uint ("latency", "Buffer latency in ms",
           "Amount of ms to buffer", 0, G_MAXUINT, DEFAULT_LATENCY_MS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRDTManager:do-lost:
+   *
+   * Send a "GstRDTPacketLost" custom event downstream for every gap of lost
+   * packets.
+   */
+  g_object_class_install_property (gobject_class, PROP_DO_LOST,
+      g_param_spec_boolean ("do-lost", "Do Lost",
+          "Send an event downstream when a packet is lost", DEFAULT_DO_LOST,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:stats:
+   *
+   * The receive statistics of the sessions since they were activated, an
+   * array of "application/x-rdt-session-stats" structures in the "sessions"
+   * field. Every structure has the session number, the packets and bytes
+   * received, the packets lost, late, received twice and out of order, the
+   * largest distance of an out of order packet, the interarrival jitter in
+   * nanoseconds and the number of packets in the jitterbuffer.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Receive statistics of the sessions", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:stats-interval:
+   *
+   * Post the statistics of a session as an element message every this
+   * many milliseconds of received data, 0 to never post them.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "Statistics interval",
+          "Interval in ms for posting statistics messages (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:report-interval:
+   *
+   * Send an ACK report for the packets received and missed and a latency
+   * report on the rtcp_src pad of a session every this many milliseconds of
+   * received data, 0 to never send reports.
+   */
+  g_object_class_install_property (gobject_class, PROP_REPORT_INTERVAL,
+      g_param_spec_uint ("report-interval", "Report interval",
+          "Interval in ms for sending reports to the server (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_REPORT_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:window-size:
+   *
+   * The maximum number of measurements in the window that the clock skew of
+   * a session is estimated over.
+   */
+  g_object_class_install_property (gobject_class, PROP_WINDOW_SIZE,
+      g_param_spec_uint ("window-size", "Window size",
+          "Maximum number of measurements in the skew window", 1, G_MAXUINT16,
+          DEFAULT_WINDOW_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:window-time:
+   *
+   * The maximum time in nanoseconds that the skew window covers.
+   */
+  g_object_class_install_property (gobject_class, PROP_WINDOW_TIME,
+      g_param_spec_uint64 ("window-time", "Window time",
+          "Maximum time in ns covered by the skew window", 1, G_MAXUINT64,
+          DEFAULT_WINDOW_TIME, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRDTManager:skew-weight:
+   *
+   * The number of window minimums that the clock skew is averaged over.
+   * Changing any of the skew properties restarts the estimation.
+   */
+  g_object_class_install_property (gobject_class, PROP_SKEW_WEIGHT,
+      g_param_spec_uint ("skew-weight", "Skew weight",
+          "Number of window minimums the skew is averaged over", 1,
+          G_MAXUINT16, DEFAULT_SKEW_WEIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstRDTManager::request-pt-map:
    * @rdtmanager: the object which received the signal
@@ -540,6 +730,12 @@ gst_rdt_manager_init (GstRDTManager * rdtmanager)
 {
   rdtmanager->provided_clock = gst_system_clock_obtain ();
   rdtmanager->latency = DEFAULT_LATENCY_MS;
+  rdtmanager->do_lost = DEFAULT_DO_LOST;
+  rdtmanager->stats_interval = DEFAULT_STATS_INTERVAL;
+  rdtmanager->report_interval = DEFAULT_REPORT_INTERVAL;
+  rdtmanager->window_size = DEFAULT_WINDOW_SIZE;
+  rdtmanager->window_time = DEFAULT_WINDOW_TIME;
+  rdtmanager->skew_weight = DEFAULT_SKEW_WEIGHT;
   GST_OBJECT_FLAG_SET (rdtmanager, GST_ELEMENT_FLAG_PROVIDE_CLOCK);
 }
 
@@ -611,6 +807,12 @@ gst_rdt_manager_src_activate_mode (GstPad * pad, GstObject * parent,
         session->last_out_time = -1;
         session->next_seqnum = -1;
         session->eos = FALSE;
+        session->num_late = 0;
+        session->num_duplicates = 0;
+        memset (&session->stats, 0, sizeof (session->stats));
+        session->last_stats_time = GST_CLOCK_TIME_NONE;
+        session->last_report_time = GST_CLOCK_TIME_NONE;
+        session->ack_len = 0;
         JBUF_UNLOCK (session);
 
         /* start pushing out buffers */
@@ -645,6 +847,100 @@ gst_rdt_manager_src_activate_mode (GstPad * pad, GstObject * parent,
   return result;
 }
 
+/* the distance from @from to @to, negative when @to is older */
+static gint
+rdt_seq_delta (guint16 from, guint16 to)
+{
+  gint delta;
+
+  delta = ((gint) to - (gint) from + RDT_SEQ_RANGE) % RDT_SEQ_RANGE;
+  if (delta >= RDT_SEQ_RANGE / 2)
+    delta -= RDT_SEQ_RANGE;
+
+  return delta;
+}
+
+/* marks @seqnum as received for the next ACK report */
+static void
+gst_rdt_manager_ack_packet (GstRDTManagerSession * session, guint16 seqnum)
+{
+  gint delta;
+
+  if (session->ack_len == 0) {
+    session->ack_seq = seqnum;
+    memset (session->ack_bits, 0, sizeof (session->ack_bits));
+  }
+
+  delta = rdt_seq_delta (session->ack_seq, seqnum);
+  /* reported already */
+  if (delta < 0)
+    return;
+
+  if (delta >= ACK_WINDOW) {
+    /* too many packets since the last report, start again from here */
+    session->ack_seq = seqnum;
+    session->ack_len = 0;
+    memset (session->ack_bits, 0, sizeof (session->ack_bits));
+    delta = 0;
+  }
+
+  session->ack_bits[delta / 8] |= 0x80 >> (delta % 8);
+  session->ack_len = MAX (session->ack_len, delta + 1);
+}
+
+/* called with the JBUF lock for every packet that is not a duplicate */
+static void
+gst_rdt_manager_update_stats (GstRDTManagerSession * session,
+    GstClockTime timestamp, GstRDTPacket * packet)
+{
+  RDTSessionStats *stats = &session->stats;
+  guint16 seqnum;
+  guint32 rdt_timestamp;
+
+  seqnum = gst_rdt_packet_data_get_seq (packet);
+  rdt_timestamp = gst_rdt_packet_data_get_timestamp (packet);
+
+  stats->packets_received++;
+  stats->bytes_received += gst_rdt_packet_get_length (packet);
+
+  if (!stats->have_seq) {
+    stats->base_seq = stats->max_seq = seqnum;
+    stats->have_seq = TRUE;
+  } else {
+    guint16 max_seq = stats->max_seq % RDT_SEQ_RANGE;
+    gint delta = rdt_seq_delta (max_seq, seqnum);
+
+    if (delta > 0) {
+      stats->max_seq += delta;
+    } else {
+      stats->packets_reordered++;
+      stats->max_reorder_depth = MAX (stats->max_reorder_depth, -delta);
+      /* older than the first packet */
+      if (stats->max_seq + delta < stats->base_seq)
+        stats->base_seq = stats->max_seq + delta;
+    }
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    gint64 transit, d;
+
+    transit = (gint64) timestamp - (gint64) gst_util_uint64_scale_int
+        (rdt_timestamp, GST_SECOND, session->clock_rate);
+
+    if (stats->have_transit) {
+      d = ABS (transit - stats->transit);
+      stats->jitter += (d - (gint64) stats->jitter) / 16;
+    }
+    stats->transit = transit;
+    stats->have_transit = TRUE;
+  }
+
+  stats->stream_id = gst_rdt_packet_data_get_stream_id (packet);
+  stats->rdt_timestamp = rdt_timestamp;
+
+  gst_rdt_manager_ack_packet (session, seqnum);
+}
+
 static GstFlowReturn
 gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
     GstClockTime timestamp, GstRDTPacket * packet)
@@ -659,7 +955,7 @@ gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
 
   res = GST_FLOW_OK;
 
-  seqnum = 0;
+  seqnum = gst_rdt_packet_data_get_seq (packet);
   GST_DEBUG_OBJECT (rdtmanager,
       "Received packet #%d at time %" GST_TIME_FORMAT, seqnum,
       GST_TIME_ARGS (timestamp));
@@ -668,15 +964,30 @@ gst_rdt_manager_handle_data_packet (GstRDTManagerSession * session,
 
   JBUF_LOCK_CHECK (session, out_flushing);
 
+  /* the packets after it were pushed out already, it was declared lost and
+   * stays lost for the statistics */
+  if (session->last_popped_seqnum != -1
+      && rdt_seq_delta (session->last_popped_seqnum, seqnum) <= 0)
+    goto too_late;
+
   /* insert the packet into the queue now, FIXME, use seqnum */
   if (!rdt_jitter_buffer_insert (session->jbuf, buffer, timestamp,
           session->clock_rate, &tail))
     goto duplicate;
 
+  gst_rdt_manager_update_stats (session, timestamp, packet);
+
   /* signal addition of new buffer when the _loop is waiting. */
   if (session->waiting)
     JBUF_SIGNAL (session);
 
+  /* the loop waits for the deadline of the old tail, the new one is due
+   * earlier */
+  if (tail && session->clock_id) {
+    GST_DEBUG_OBJECT (rdtmanager, "new tail #%d, unscheduling wait", seqnum);
+    gst_clock_id_unschedule (session->clock_id);
+  }
+
 finished:
   JBUF_UNLOCK (session);
 
@@ -690,6 +1001,13 @@ out_flushing:
     gst_buffer_unref (buffer);
     goto finished;
   }
+too_late:
+  {
+    GST_DEBUG_OBJECT (rdtmanager, "Packet #%d is too late, dropping", seqnum);
+    session->num_late++;
+    gst_buffer_unref (buffer);
+    goto finished;
+  }
 duplicate:
   {
     GST_WARNING_OBJECT (rdtmanager, "Duplicate packet #%d detected, dropping",
@@ -700,6 +1018,159 @@ duplicate:
   }
 }
 
+/* called with the JBUF lock */
+static GstStructure *
+gst_rdt_manager_session_get_stats (GstRDTManagerSession * session)
+{
+  RDTSessionStats *stats = &session->stats;
+  guint64 expected, lost = 0;
+
+  if (stats->have_seq) {
+    expected = stats->max_seq - stats->base_seq + 1;
+    if (expected > stats->packets_received)
+      lost = expected - stats->packets_received;
+  }
+
+  return gst_structure_new ("application/x-rdt-session-stats",
+      "session", G_TYPE_UINT, (guint) session->id,
+      "packets-received", G_TYPE_UINT64, stats->packets_received,
+      "bytes-received", G_TYPE_UINT64, stats->bytes_received,
+      "packets-lost", G_TYPE_UINT64, lost,
+      "packets-late", G_TYPE_UINT64, session->num_late,
+      "packets-duplicate", G_TYPE_UINT64, session->num_duplicates,
+      "packets-reordered", G_TYPE_UINT64, stats->packets_reordered,
+      "max-reorder-depth", G_TYPE_UINT, stats->max_reorder_depth,
+      "jitter", G_TYPE_UINT64, stats->jitter,
+      "buffered", G_TYPE_UINT, rdt_jitter_buffer_num_packets (session->jbuf),
+      NULL);
+}
+
+/* The streaming threads take the object lock with the JBUF lock held, so the
+ * session list is copied and the object lock released before taking any JBUF
+ * lock. Sessions are only freed in finalize. */
+static GstStructure *
+gst_rdt_manager_get_stats (GstRDTManager * rdtmanager)
+{
+  GValue sessions = G_VALUE_INIT;
+  GstStructure *result;
+  GSList *list, *walk;
+
+  g_value_init (&sessions, GST_TYPE_ARRAY);
+
+  GST_OBJECT_LOCK (rdtmanager);
+  list = g_slist_copy (rdtmanager->sessions);
+  GST_OBJECT_UNLOCK (rdtmanager);
+
+  for (walk = list; walk; walk = g_slist_next (walk)) {
+    GstRDTManagerSession *session = (GstRDTManagerSession *) walk->data;
+    GValue value = G_VALUE_INIT;
+
+    g_value_init (&value, GST_TYPE_STRUCTURE);
+    JBUF_LOCK (session);
+    g_value_take_boxed (&value, gst_rdt_manager_session_get_stats (session));
+    JBUF_UNLOCK (session);
+    gst_value_array_append_and_take_value (&sessions, &value);
+  }
+  g_slist_free (list);
+
+  result = gst_structure_new_empty ("application/x-rdt-manager-stats");
+  gst_structure_take_value (result, "sessions", &sessions);
+
+  return result;
+}
+
+/* returns TRUE when @interval ms passed since *@last */
+static gboolean
+check_interval (GstClockTime * last, GstClockTime timestamp, guint interval)
+{
+  if (interval == 0 || !GST_CLOCK_TIME_IS_VALID (timestamp))
+    return FALSE;
+
+  if (!GST_CLOCK_TIME_IS_VALID (*last) || timestamp < *last) {
+    *last = timestamp;
+    return FALSE;
+  }
+  if (timestamp - *last < interval * GST_MSECOND)
+    return FALSE;
+
+  *last = timestamp;
+  return TRUE;
+}
+
+/* called with the JBUF lock, makes the ACK report for the packets since the
+ * last one and a latency report */
+static GstBufferList *
+gst_rdt_manager_make_reports (GstRDTManagerSession * session)
+{
+  GstBufferList *list;
+  RDTSessionStats *stats = &session->stats;
+
+  if (!stats->have_seq)
+    return NULL;
+
+  list = gst_buffer_list_new ();
+
+  if (session->ack_len > 0) {
+    guint8 lost[ACK_WINDOW / 8];
+    guint16 last_seq;
+    guint i;
+
+    for (i = 0; i < (session->ack_len + 7) / 8; i++)
+      lost[i] = ~session->ack_bits[i];
+    /* clear the bits past the end */
+    if (session->ack_len % 8)
+      lost[i - 1] &= 0xff << (8 - session->ack_len % 8);
+
+    last_seq = (session->ack_seq + session->ack_len - 1) % RDT_SEQ_RANGE;
+    gst_buffer_list_add (list, gst_rdt_buffer_new_ack (stats->stream_id,
+            last_seq, session->ack_len, lost));
+
+    session->ack_seq = (last_seq + 1) % RDT_SEQ_RANGE;
+    session->ack_len = 0;
+    memset (session->ack_bits, 0, sizeof (session->ack_bits));
+  }
+
+  gst_buffer_list_add (list,
+      gst_rdt_buffer_new_latency_report (stats->rdt_timestamp));
+
+  return list;
+}
+
+static void
+gst_rdt_manager_push_reports (GstRDTManager * rdtmanager,
+    GstRDTManagerSession * session, GstBufferList * list)
+{
+  if (session->rtcp_src == NULL || !gst_pad_is_linked (session->rtcp_src)) {
+    gst_buffer_list_unref (list);
+    return;
+  }
+
+  if (!session->rtcp_started) {
+    GstCaps *caps;
+    gchar *stream_id;
+    GstSegment segment;
+
+    stream_id = gst_pad_create_stream_id_printf (session->rtcp_src,
+        GST_ELEMENT_CAST (rdtmanager), "%u", session->id);
+    gst_pad_push_event (session->rtcp_src,
+        gst_event_new_stream_start (stream_id));
+    g_free (stream_id);
+
+    caps = gst_caps_new_empty_simple ("application/x-rdt");
+    gst_pad_push_event (session->rtcp_src, gst_event_new_caps (caps));
+    gst_caps_unref (caps);
+
+    gst_segment_init (&segment, GST_FORMAT_TIME);
+    gst_pad_push_event (session->rtcp_src, gst_event_new_segment (&segment));
+
+    session->rtcp_started = TRUE;
+  }
+
+  GST_DEBUG_OBJECT (rdtmanager, "sending %u report packets for session %d",
+      gst_buffer_list_length (list), session->id);
+  gst_pad_push_list (session->rtcp_src, list);
+}
+
 static gboolean
 gst_rdt_manager_parse_caps (GstRDTManager * rdtmanager,
     GstRDTManagerSession * session, GstCaps * caps)
@@ -741,6 +1212,10 @@ gst_rdt_manager_parse_caps (GstRDTManager * rdtmanager,
 
   GST_DEBUG_OBJECT (rdtmanager, "got seqnum-base %d", session->next_seqnum);
 
+  if (!gst_structure_get_uint (caps_struct, "x-real-context",
+          &session->real_context))
+    session->real_context = 0;
+
   return TRUE;
 
   /* ERRORS */
@@ -772,6 +1247,21 @@ gst_rdt_manager_event_rdt (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_event_unref (event);
       break;
     }
+    case GST_EVENT_EOS:
+    {
+      /* push out what we have without waiting, the loop sends the EOS after
+       * the last packet */
+      JBUF_LOCK (session);
+      GST_DEBUG_OBJECT (rdtmanager, "queuing EOS");
+      session->eos = TRUE;
+      JBUF_SIGNAL (session);
+      if (session->clock_id)
+        gst_clock_id_unschedule (session->clock_id);
+      JBUF_UNLOCK (session);
+      gst_event_unref (event);
+      res = TRUE;
+      break;
+    }
     default:
       res = gst_pad_event_default (pad, parent, event);
       break;
@@ -779,6 +1269,87 @@ gst_rdt_manager_event_rdt (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+/* posts the receive rate of @session and passes it to rtspreal. When that
+ * selects other rules, rtspsrc is asked to subscribe to them with a
+ * SET_PARAMETER request, which it queues and sends from its own thread. */
+static void
+gst_rdt_manager_report_rate (GstRDTManager * rdtmanager,
+    GstRDTManagerSession * session, guint64 bitrate)
+{
+  GstObject *parent;
+  gchar *rules;
+
+  gst_element_post_message (GST_ELEMENT_CAST (rdtmanager),
+      gst_message_new_element (GST_OBJECT_CAST (rdtmanager),
+          gst_structure_new ("application/x-rdt-receive-rate",
+              "session", G_TYPE_UINT, (guint) session->id,
+              "bitrate", G_TYPE_UINT64, bitrate, NULL)));
+
+  if (session->real_context == 0)
+    return;
+
+  rules = gst_rtsp_real_report_bitrate (session->real_context, session->id,
+      bitrate);
+  if (rules == NULL)
+    return;
+
+  parent = gst_object_get_parent (GST_OBJECT_CAST (rdtmanager));
+  if (parent && g_signal_lookup ("set-parameter", G_OBJECT_TYPE (parent))) {
+    GstPromise *promise;
+    gboolean res = FALSE;
+
+    /* we don't wait for the reply */
+    promise = gst_promise_new ();
+    g_signal_emit_by_name (parent, "set-parameter",
+        GST_RTSP_REAL_SUBSCRIBE_PARAMETER, rules, NULL, promise, &res);
+    if (!res)
+      GST_WARNING_OBJECT (rdtmanager, "could not subscribe to %s", rules);
+    gst_promise_unref (promise);
+  } else {
+    GST_WARNING_OBJECT (rdtmanager, "can't subscribe to %s", rules);
+  }
+  if (parent)
+    gst_object_unref (parent);
+  g_free (rules);
+}
+
+/* measures the rate at which the session receives data */
+static void
+gst_rdt_manager_update_rate (GstRDTManager * rdtmanager,
+    GstRDTManagerSession * session, GstClockTime timestamp, gsize size)
+{
+  GstClockTime elapsed;
+
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp))
+    return;
+
+  if (!GST_CLOCK_TIME_IS_VALID (session->rate_start)
+      || timestamp < session->rate_start) {
+    session->rate_start = timestamp;
+    session->rate_bytes = size;
+    return;
+  }
+
+  elapsed = timestamp - session->rate_start;
+  if (elapsed >= 2 * RATE_INTERVAL) {
+    /* a pause or a stall, nothing we can say about the rate */
+    session->rate_start = timestamp;
+    session->rate_bytes = size;
+    return;
+  }
+  if (elapsed >= RATE_INTERVAL) {
+    guint64 bitrate;
+
+    bitrate = gst_util_uint64_scale (session->rate_bytes, 8 * GST_SECOND,
+        elapsed);
+    gst_rdt_manager_report_rate (rdtmanager, session, bitrate);
+
+    session->rate_start = timestamp;
+    session->rate_bytes = 0;
+  }
+  session->rate_bytes += size;
+}
+
 static GstFlowReturn
 gst_rdt_manager_chain_rdt (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -825,6 +1396,9 @@ gst_rdt_manager_chain_rdt (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   timestamp = gst_segment_to_running_time (&session->segment, GST_FORMAT_TIME,
       timestamp);
 
+  gst_rdt_manager_update_rate (rdtmanager, session, timestamp,
+      gst_buffer_get_size (buffer));
+
   more = gst_rdt_buffer_get_first_packet (buffer, &packet);
   while (more) {
     GstRDTType type;
@@ -847,12 +1421,76 @@ gst_rdt_manager_chain_rdt (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
     more = gst_rdt_packet_move_to_next (&packet);
   }
+  gst_rdt_packet_unmap (&packet);
 
   gst_buffer_unref (buffer);
 
+  if (rdtmanager->stats_interval > 0 || rdtmanager->report_interval > 0) {
+    GstStructure *stats = NULL;
+    GstBufferList *reports = NULL;
+
+    JBUF_LOCK (session);
+    if (check_interval (&session->last_stats_time, timestamp,
+            rdtmanager->stats_interval))
+      stats = gst_rdt_manager_session_get_stats (session);
+    if (check_interval (&session->last_report_time, timestamp,
+            rdtmanager->report_interval))
+      reports = gst_rdt_manager_make_reports (session);
+    JBUF_UNLOCK (session);
+
+    if (stats)
+      gst_element_post_message (GST_ELEMENT_CAST (rdtmanager),
+          gst_message_new_element (GST_OBJECT_CAST (rdtmanager), stats));
+    if (reports)
+      gst_rdt_manager_push_reports (rdtmanager, session, reports);
+  }
+
   return res;
 }
 
+/* called with the JBUF lock, waits until @buffer is due. The lock is released
+ * while waiting, GST_CLOCK_UNSCHEDULED is returned when an older packet
+ * arrived or we are flushing or EOS. */
+static GstClockReturn
+gst_rdt_manager_wait_deadline (GstRDTManager * rdtmanager,
+    GstRDTManagerSession * session, GstBuffer * buffer)
+{
+  GstClock *clock;
+  GstClockTime timestamp, deadline;
+  GstClockID id;
+  GstClockReturn ret;
+
+  timestamp = GST_BUFFER_TIMESTAMP (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp))
+    return GST_CLOCK_OK;
+
+  GST_OBJECT_LOCK (rdtmanager);
+  clock = GST_ELEMENT_CLOCK (rdtmanager);
+  if (clock == NULL) {
+    /* nothing to wait on, push right away */
+    GST_OBJECT_UNLOCK (rdtmanager);
+    return GST_CLOCK_OK;
+  }
+  deadline = timestamp + GST_ELEMENT_CAST (rdtmanager)->base_time +
+      rdtmanager->latency * GST_MSECOND;
+  id = gst_clock_new_single_shot_id (clock, deadline);
+  GST_OBJECT_UNLOCK (rdtmanager);
+
+  GST_DEBUG_OBJECT (rdtmanager, "waiting until %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (deadline));
+
+  session->clock_id = id;
+  JBUF_UNLOCK (session);
+  ret = gst_clock_id_wait (id, NULL);
+  JBUF_LOCK (session);
+  session->clock_id = NULL;
+  gst_clock_id_unref (id);
+
+  GST_DEBUG_OBJECT (rdtmanager, "wait returned %d", ret);
+
+  return ret;
+}
+
 /* push packets from the queue to the downstream demuxer */
 static void
 gst_rdt_manager_loop (GstPad * pad)
@@ -860,13 +1498,18 @@ gst_rdt_manager_loop (GstPad * pad)
   GstRDTManager *rdtmanager;
   GstRDTManagerSession *session;
   GstBuffer *buffer;
+  GstRDTPacket packet;
   GstFlowReturn result;
+  GstEvent *lost_event = NULL;
+  guint16 seqnum;
+  gint gap;
 
   rdtmanager = GST_RDT_MANAGER (GST_PAD_PARENT (pad));
 
   session = gst_pad_get_element_private (pad);
 
   JBUF_LOCK_CHECK (session, flushing);
+again:
   GST_DEBUG_OBJECT (rdtmanager, "Peeking item");
   while (TRUE) {
     /* always wait if we are blocked */
@@ -884,10 +1527,46 @@ gst_rdt_manager_loop (GstPad * pad)
     session->waiting = FALSE;
   }
 
+  /* the oldest packet is due latency after it was received, until then the
+   * packets missing before it can still arrive. At EOS we push what we
+   * have. */
+  if (!session->eos) {
+    GstClockReturn ret;
+
+    ret = gst_rdt_manager_wait_deadline (rdtmanager, session,
+        rdt_jitter_buffer_peek (session->jbuf));
+    if (session->srcresult != GST_FLOW_OK)
+      goto flushing;
+    if (ret == GST_CLOCK_UNSCHEDULED)
+      goto again;
+  }
+
   buffer = rdt_jitter_buffer_pop (session->jbuf);
 
   GST_DEBUG_OBJECT (rdtmanager, "Got item %p", buffer);
 
+  gst_rdt_buffer_get_first_packet (buffer, &packet);
+  seqnum = gst_rdt_packet_data_get_seq (&packet);
+  gst_rdt_packet_unmap (&packet);
+
+  /* the missing packets before this one had their chance */
+  if (session->next_seqnum != -1) {
+    gap = rdt_seq_delta (session->next_seqnum, seqnum);
+    if (gap > 0) {
+      GST_DEBUG_OBJECT (rdtmanager, "%d packets lost before #%d", gap, seqnum);
+      session->discont = TRUE;
+      if (rdtmanager->do_lost)
+        lost_event = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+            gst_structure_new ("GstRDTPacketLost",
+                "seqnum", G_TYPE_UINT, session->next_seqnum,
+                "count", G_TYPE_UINT, (guint) gap,
+                "timestamp", G_TYPE_UINT64, GST_BUFFER_TIMESTAMP (buffer),
+                NULL));
+    }
+  }
+  session->last_popped_seqnum = seqnum;
+  session->next_seqnum = (seqnum + 1) % RDT_SEQ_RANGE;
+
   if (session->discont) {
     GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
     session->discont = FALSE;
@@ -895,6 +1574,9 @@ gst_rdt_manager_loop (GstPad * pad)
 
   JBUF_UNLOCK (session);
 
+  if (lost_event)
+    gst_pad_push_event (session->recv_rtp_src, lost_event);
+
   result = gst_pad_push (session->recv_rtp_src, buffer);
   if (result != GST_FLOW_OK)
     goto pause;
@@ -1093,6 +1775,33 @@ bad_packet:
 #endif
 }
 
+/* takes the JBUF locks without the object lock, see
+ * gst_rdt_manager_get_stats() */
+static void
+gst_rdt_manager_configure_sessions (GstRDTManager * rdtmanager)
+{
+  GSList *list, *walk;
+  guint window_size, skew_weight;
+  guint64 window_time;
+
+  GST_OBJECT_LOCK (rdtmanager);
+  list = g_slist_copy (rdtmanager->sessions);
+  window_size = rdtmanager->window_size;
+  window_time = rdtmanager->window_time;
+  skew_weight = rdtmanager->skew_weight;
+  GST_OBJECT_UNLOCK (rdtmanager);
+
+  for (walk = list; walk; walk = g_slist_next (walk)) {
+    GstRDTManagerSession *session = (GstRDTManagerSession *) walk->data;
+
+    JBUF_LOCK (session);
+    gst_rdt_manager_session_configure (session, window_size, window_time,
+        skew_weight);
+    JBUF_UNLOCK (session);
+  }
+  g_slist_free (list);
+}
+
 static void
 gst_rdt_manager_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -1105,6 +1814,33 @@ gst_rdt_manager_set_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       src->latency = g_value_get_uint (value);
       break;
+    case PROP_DO_LOST:
+      src->do_lost = g_value_get_boolean (value);
+      break;
+    case PROP_STATS_INTERVAL:
+      src->stats_interval = g_value_get_uint (value);
+      break;
+    case PROP_REPORT_INTERVAL:
+      src->report_interval = g_value_get_uint (value);
+      break;
+    case PROP_WINDOW_SIZE:
+      GST_OBJECT_LOCK (src);
+      src->window_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      gst_rdt_manager_configure_sessions (src);
+      break;
+    case PROP_WINDOW_TIME:
+      GST_OBJECT_LOCK (src);
+      src->window_time = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (src);
+      gst_rdt_manager_configure_sessions (src);
+      break;
+    case PROP_SKEW_WEIGHT:
+      GST_OBJECT_LOCK (src);
+      src->skew_weight = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      gst_rdt_manager_configure_sessions (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1123,6 +1859,33 @@ gst_rdt_manager_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LATENCY:
       g_value_set_uint (value, src->latency);
       break;
+    case PROP_DO_LOST:
+      g_value_set_boolean (value, src->do_lost);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_rdt_manager_get_stats (src));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, src->stats_interval);
+      break;
+    case PROP_REPORT_INTERVAL:
+      g_value_set_uint (value, src->report_interval);
+      break;
+    case PROP_WINDOW_SIZE:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->window_size);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_WINDOW_TIME:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint64 (value, src->window_time);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_SKEW_WEIGHT:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->skew_weight);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -61,6 +61,12 @@ struct _GstRDTManager {
   GstElement  element;
 
   guint       latency;
+  gboolean    do_lost;
+  guint       stats_interval;
+  guint       report_interval;
+  guint       window_size;
+  guint64     window_time;
+  guint       skew_weight;
   GSList     *sessions;
   GstClock   *provided_clock;
 };
@@ -41,6 +41,8 @@
 #define DATA_SIZE 8
 
 #define MAX_FRAGS 256
+/* the largest fragment offset header of a RealVideo frame */
+#define MAX_FRAG_HEADER (1 + 8 * MAX_FRAGS)
 
 static const guint8 sipr_subpk_size[4] = { 29, 19, 37, 20 };
 
@@ -92,7 +94,8 @@ struct _GstRMDemuxStream
   guint frag_current;
   guint frag_count;
   guint frag_offset[MAX_FRAGS];
-  GstAdapter *adapter;
+  GstBuffer *fragments;         /* shares the memory of the packets */
+  gboolean frag_copied;         /* or is a copy, behind MAX_FRAG_HEADER */
 
   GstTagList *pending_tags;
 };
@@ -127,10 +130,23 @@ GST_DEBUG_CATEGORY_STATIC (rmdemux_debug);
 
 static GstElementClass *parent_class = NULL;
 
+#define DEFAULT_READ_AHEAD (1024 * 1024)
+
+enum
+{
+  PROP_0,
+  PROP_STATS,
+  PROP_READ_AHEAD
+};
+
 static void gst_rmdemux_class_init (GstRMDemuxClass * klass);
 static void gst_rmdemux_base_init (GstRMDemuxClass * klass);
 static void gst_rmdemux_init (GstRMDemux * rmdemux);
 static void gst_rmdemux_finalize (GObject * object);
+static void gst_rmdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rmdemux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static GstStateChangeReturn gst_rmdemux_change_state (GstElement * element,
     GstStateChange transition);
 static GstFlowReturn gst_rmdemux_chain (GstPad * pad, GstObject * parent,
@@ -226,6 +242,35 @@ gst_rmdemux_class_init (GstRMDemuxClass * klass)
       0, "Demuxer for Realmedia streams");
 
   gobject_class->finalize = gst_rmdemux_finalize;
+  gobject_class->set_property = gst_rmdemux_set_property;
+  gobject_class->get_property = gst_rmdemux_get_property;
+
+  /**
+   * GstRMDemux:stats:
+   *
+   * Counters of the parsing hot path since the element last went to READY:
+   * data packets parsed and dropped, audio descrambling, payload bytes
+   * copied versus passed on as sub-buffers, index lookups and pull calls.
+   * Reading them does not block the streaming thread.
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Parsing statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRMDemux:read-ahead:
+   *
+   * In pull mode, the data packets are read in windows of this many bytes
+   * and parsed in place. A packet that does not fit into the rest of a
+   * window is read again at the start of the next one. 0 reads one
+   * average packet at a time.
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD,
+      g_param_spec_uint ("read-ahead", "Read ahead",
+          "Bytes to read at once in pull mode (0 = one average packet)",
+          0, G_MAXINT, DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -245,6 +290,69 @@ gst_rmdemux_finalize (GObject * object)
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
 
+static GstStructure *
+gst_rmdemux_get_stats (GstRMDemux * rmdemux)
+{
+  return gst_structure_new ("application/x-rm-demux-stats",
+      "packets-parsed", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, packets_parsed),
+      "packets-dropped", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, packets_dropped),
+      "descrambled", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, descrambled),
+      "descramble-time", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_DESCRAMBLE_TIME (rmdemux),
+      "bytes-copied", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_UINT64 (rmdemux, bytes_copied),
+      "bytes-shared", G_TYPE_UINT64,
+      GST_DEMUX_STATS_GET_UINT64 (rmdemux, bytes_shared),
+      "index-hits", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, index_hits),
+      "index-misses", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, index_misses),
+      "pull-calls", G_TYPE_UINT,
+      GST_DEMUX_STATS_GET_UINT (rmdemux, pull_calls), NULL);
+}
+
+static void
+gst_rmdemux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRMDemux *rmdemux = GST_RMDEMUX (object);
+
+  switch (prop_id) {
+    case PROP_READ_AHEAD:
+      GST_OBJECT_LOCK (rmdemux);
+      rmdemux->read_ahead = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rmdemux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rmdemux_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstRMDemux *rmdemux = GST_RMDEMUX (object);
+
+  switch (prop_id) {
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_rmdemux_get_stats (rmdemux));
+      break;
+    case PROP_READ_AHEAD:
+      GST_OBJECT_LOCK (rmdemux);
+      g_value_set_uint (value, rmdemux->read_ahead);
+      GST_OBJECT_UNLOCK (rmdemux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_rmdemux_init (GstRMDemux * rmdemux)
 {
@@ -268,6 +376,7 @@ gst_rmdemux_init (GstRMDemux * rmdemux)
   rmdemux->have_group_id = FALSE;
   rmdemux->group_id = G_MAXUINT;
   rmdemux->flowcombiner = gst_flow_combiner_new ();
+  rmdemux->read_ahead = DEFAULT_READ_AHEAD;
 
   gst_rm_utils_run_tests ();
 }
@@ -352,6 +461,7 @@ gst_rmdemux_validate_offset (GstRMDemux * rmdemux)
   GstMapInfo map;
 
   buffer = NULL;
+  GST_DEMUX_STATS_INC (rmdemux, pull_calls);
   flowret = gst_pad_pull_range (rmdemux->sinkpad, rmdemux->offset, 4, &buffer);
 
   if (flowret != GST_FLOW_OK) {
@@ -552,6 +662,7 @@ gst_rmdemux_perform_seek (GstRMDemux * rmdemux, GstEvent * event)
    */
   if (!find_seek_offset_time (rmdemux, rmdemux->segment.position)) {
     GST_LOG_OBJECT (rmdemux, "Failed to find seek offset by time");
+    GST_DEMUX_STATS_INC (rmdemux, index_misses);
     ret = FALSE;
     goto done;
   }
@@ -562,11 +673,13 @@ gst_rmdemux_perform_seek (GstRMDemux * rmdemux, GstEvent * event)
     GST_INFO_OBJECT (rmdemux, "Failed to validate offset at %u",
         rmdemux->offset);
     if (!find_seek_offset_bytes (rmdemux, rmdemux->offset - 1)) {
+      GST_DEMUX_STATS_INC (rmdemux, index_misses);
       ret = FALSE;
       goto done;
     }
     validated = gst_rmdemux_validate_offset (rmdemux);
   }
+  GST_DEMUX_STATS_INC (rmdemux, index_hits);
 
   GST_LOG_OBJECT (rmdemux, "Found final offset. Excellent!");
 
@@ -681,7 +794,7 @@ gst_rmdemux_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
 static void
 gst_rmdemux_free_stream (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
 {
-  g_object_unref (stream->adapter);
+  gst_buffer_replace (&stream->fragments, NULL);
   gst_rmdemux_stream_clear_cached_subpackets (rmdemux, stream);
   if (stream->pending_tags)
     gst_tag_list_unref (stream->pending_tags);
@@ -738,6 +851,7 @@ gst_rmdemux_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_NULL_TO_READY:
+      memset (&rmdemux->stats, 0, sizeof (rmdemux->stats));
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       rmdemux->state = RMDEMUX_STATE_HEADER;
@@ -848,7 +962,8 @@ gst_rmdemux_loop (GstPad * pad)
   GstRMDemux *rmdemux;
   GstBuffer *buffer;
   GstFlowReturn ret = GST_FLOW_OK;
-  guint size;
+  gboolean bulk = FALSE;
+  guint size, avail;
 
   rmdemux = GST_RMDEMUX (GST_PAD_PARENT (pad));
 
@@ -864,6 +979,14 @@ gst_rmdemux_loop (GstPad * pad)
       break;
     case RMDEMUX_STATE_DATA_PACKET:
       size = rmdemux->avg_packet_size;
+      if (rmdemux->loop_state == RMDEMUX_LOOP_STATE_DATA) {
+        GST_OBJECT_LOCK (rmdemux);
+        if (rmdemux->read_ahead > size) {
+          size = rmdemux->read_ahead;
+          bulk = TRUE;
+        }
+        GST_OBJECT_UNLOCK (rmdemux);
+      }
       break;
     case RMDEMUX_STATE_EOS:
       GST_LOG_OBJECT (rmdemux, "At EOS, pausing task");
@@ -876,6 +999,7 @@ gst_rmdemux_loop (GstPad * pad)
   }
 
   buffer = NULL;
+  GST_DEMUX_STATS_INC (rmdemux, pull_calls);
   ret = gst_pad_pull_range (pad, rmdemux->offset, size, &buffer);
   if (ret != GST_FLOW_OK) {
     if (rmdemux->offset == rmdemux->index_offset) {
@@ -897,15 +1021,28 @@ gst_rmdemux_loop (GstPad * pad)
 
   size = gst_buffer_get_size (buffer);
 
+  /* the data in the adapter ends at the offset while the chain function
+   * parses it */
+  rmdemux->offset += size;
+
   /* Defer to the chain function */
   ret = gst_rmdemux_chain (pad, GST_OBJECT_CAST (rmdemux), buffer);
   if (ret != GST_FLOW_OK) {
     GST_DEBUG_OBJECT (rmdemux, "Chain flow failed at offset 0x%08x",
-        rmdemux->offset);
+        rmdemux->offset - size);
     goto need_pause;
   }
 
-  rmdemux->offset += size;
+  /* A packet straddles the end of the window. Read it again at the start
+   * of the next window, so that all packets are sub-buffers of a single
+   * pull. When not even one packet fit, keep collecting instead. */
+  avail = gst_adapter_available (rmdemux->adapter);
+  if (bulk && avail > 0 && avail < size) {
+    GST_LOG_OBJECT (rmdemux, "dropping %u bytes at the end of the window",
+        avail);
+    gst_adapter_clear (rmdemux->adapter);
+    rmdemux->offset -= avail;
+  }
 
   switch (rmdemux->loop_state) {
     case RMDEMUX_LOOP_STATE_HEADER:
@@ -1639,7 +1776,6 @@ gst_rmdemux_parse_mdpr (GstRMDemux * rmdemux, const guint8 * data, int length)
   stream->last_ts = -1;
   stream->next_ts = -1;
   stream->discont = TRUE;
-  stream->adapter = gst_adapter_new ();
   GST_LOG_OBJECT (rmdemux, "stream_number=%d", stream->id);
 
   /* parse the bitrates */
@@ -1967,12 +2103,15 @@ gst_rmdemux_descramble_audio (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
   guint height = stream->subpackets->len;
   guint leaf_size = stream->leaf_size;
   guint p, x;
+  GstClockTime start;
 
   g_assert (stream->height == height);
 
   GST_LOG ("packet_size = %u, leaf_size = %u, height= %u", packet_size,
       leaf_size, height);
 
+  start = gst_util_get_timestamp ();
+
   outbuf = gst_buffer_new_and_alloc (height * packet_size);
   gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
 
@@ -1999,8 +2138,11 @@ gst_rmdemux_descramble_audio (GstRMDemux * rmdemux, GstRMDemuxStream * stream)
     gst_buffer_unmap (b, &map);
   }
   gst_buffer_unmap (outbuf, &outmap);
+  gst_demux_stats_add_descramble (&rmdemux->stats, start);
 
   /* some decoders, such as realaudiodec, need to be fed in packet units */
+  GST_DEMUX_STATS_ADD (rmdemux, bytes_copied, height * packet_size);
+
   for (p = 0; p < height; ++p) {
     GstBuffer *subbuf;
 
@@ -2034,12 +2176,15 @@ gst_rmdemux_descramble_dnet_audio (GstRMDemux * rmdemux,
     GstRMDemuxStream * stream)
 {
   GstBuffer *buf;
+  GstClockTime start;
 
   buf = g_ptr_array_index (stream->subpackets, 0);
   g_ptr_array_index (stream->subpackets, 0) = NULL;
   g_ptr_array_set_size (stream->subpackets, 0);
 
+  start = gst_util_get_timestamp ();
   buf = gst_rm_utils_descramble_dnet_buffer (buf);
+  gst_demux_stats_add_descramble (&rmdemux->stats, start);
 
   if (stream->discont) {
     GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
@@ -2053,10 +2198,11 @@ gst_rmdemux_descramble_mp4a_audio (GstRMDemux * rmdemux,
     GstRMDemuxStream * stream)
 {
   GstFlowReturn res;
-  GstBuffer *buf, *outbuf;
+  /* the frame count has 4 bits */
+  GstBuffer *buf, *outbufs[16];
   guint frames, index, i;
   GstMapInfo map;
-  GstClockTime timestamp;
+  GstClockTime timestamp, start;
 
   res = GST_FLOW_OK;
 
@@ -2064,33 +2210,43 @@ gst_rmdemux_descramble_mp4a_audio (GstRMDemux * rmdemux,
   g_ptr_array_index (stream->subpackets, 0) = NULL;
   g_ptr_array_set_size (stream->subpackets, 0);
 
+  start = gst_util_get_timestamp ();
+
   gst_buffer_map (buf, &map, GST_MAP_READ);
   timestamp = GST_BUFFER_PTS (buf);
 
   frames = (map.data[1] & 0xf0) >> 4;
   index = 2 * frames + 2;
 
+  /* split up first, so that only that counts as descrambling */
   for (i = 0; i < frames; i++) {
     guint len = (map.data[i * 2 + 2] << 8) | map.data[i * 2 + 3];
 
-    outbuf = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL, index, len);
+    outbufs[i] = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL, index, len);
+    GST_DEMUX_STATS_ADD (rmdemux, bytes_shared, len);
     if (i == 0) {
-      GST_BUFFER_PTS (outbuf) = timestamp;
-      GST_BUFFER_DTS (outbuf) = timestamp;
+      GST_BUFFER_PTS (outbufs[i]) = timestamp;
+      GST_BUFFER_DTS (outbufs[i]) = timestamp;
     }
 
     index += len;
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+  gst_demux_stats_add_descramble (&rmdemux->stats, start);
+
+  for (i = 0; i < frames; i++) {
+    if (res != GST_FLOW_OK) {
+      gst_buffer_unref (outbufs[i]);
+      continue;
+    }
 
     if (stream->discont) {
-      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+      GST_BUFFER_FLAG_SET (outbufs[i], GST_BUFFER_FLAG_DISCONT);
       stream->discont = FALSE;
     }
-    res = gst_pad_push (stream->pad, outbuf);
-    if (res != GST_FLOW_OK)
-      break;
+    res = gst_pad_push (stream->pad, outbufs[i]);
   }
-  gst_buffer_unmap (buf, &map);
-  gst_buffer_unref (buf);
   return res;
 }
 
@@ -2104,12 +2260,15 @@ gst_rmdemux_descramble_sipr_audio (GstRMDemux * rmdemux,
   guint packet_size = stream->packet_size;
   guint height = stream->subpackets->len;
   guint p;
+  GstClockTime start;
 
   g_assert (stream->height == height);
 
   GST_LOG ("packet_size = %u, leaf_size = %u, height= %u", packet_size,
       stream->leaf_size, height);
 
+  start = gst_util_get_timestamp ();
+
   outbuf = gst_buffer_new_and_alloc (height * packet_size);
   gst_buffer_map (outbuf, &outmap, GST_MAP_WRITE);
 
@@ -2124,6 +2283,7 @@ gst_rmdemux_descramble_sipr_audio (GstRMDemux * rmdemux,
     gst_buffer_extract (b, 0, outmap.data + packet_size * p, packet_size);
   }
   gst_buffer_unmap (outbuf, &outmap);
+  GST_DEMUX_STATS_ADD (rmdemux, bytes_copied, height * packet_size);
 
   GST_LOG_OBJECT (rmdemux, "pushing buffer dts %" GST_TIME_FORMAT ", pts %"
       GST_TIME_FORMAT, GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)),
@@ -2135,6 +2295,7 @@ gst_rmdemux_descramble_sipr_audio (GstRMDemux * rmdemux,
   }
 
   outbuf = gst_rm_utils_descramble_sipr_buffer (outbuf);
+  gst_demux_stats_add_descramble (&rmdemux->stats, start);
 
   ret = gst_pad_push (stream->pad, outbuf);
 
@@ -2167,6 +2328,7 @@ gst_rmdemux_handle_scrambled_packet (GstRMDemux * rmdemux,
 
   g_assert (stream->subpackets->len >= 1);
 
+  /* the descramble functions count the time without the pushing */
   switch (stream->fourcc) {
     case GST_RM_AUD_DNET:
       ret = gst_rmdemux_descramble_dnet_audio (rmdemux, stream);
@@ -2208,6 +2370,67 @@ G_STMT_START {                                  \
   }                                             \
 } G_STMT_END
 
+/* copies @fragment behind the fragments of @stream. The first time, the
+ * fragments collected so far are copied into memory for the whole frame,
+ * with room for the largest header in front. */
+static void
+gst_rmdemux_copy_fragment (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
+    GstBuffer * fragment)
+{
+  gsize size = gst_buffer_get_size (fragment);
+
+  if (!stream->frag_copied) {
+    GstBuffer *frame;
+    GstMapInfo map;
+
+    frame = gst_buffer_new_allocate (NULL, MAX_FRAG_HEADER +
+        MAX (stream->frag_length, stream->frag_current + size), NULL);
+    gst_buffer_map (frame, &map, GST_MAP_WRITE);
+    gst_buffer_extract (stream->fragments, 0, map.data + MAX_FRAG_HEADER,
+        stream->frag_current);
+    gst_buffer_unmap (frame, &map);
+    GST_DEMUX_STATS_ADD (rmdemux, bytes_copied, stream->frag_current);
+
+    gst_buffer_unref (stream->fragments);
+    stream->fragments = frame;
+    stream->frag_copied = TRUE;
+  }
+
+  if (MAX_FRAG_HEADER + stream->frag_current + size <=
+      gst_buffer_get_size (stream->fragments)) {
+    GstMapInfo map;
+
+    gst_buffer_map (fragment, &map, GST_MAP_READ);
+    gst_buffer_fill (stream->fragments, MAX_FRAG_HEADER + stream->frag_current,
+        map.data, size);
+    gst_buffer_unmap (fragment, &map);
+    gst_buffer_unref (fragment);
+    GST_DEMUX_STATS_ADD (rmdemux, bytes_copied, size);
+  } else {
+    /* more data than the frame should have, this is its last fragment */
+    gst_buffer_resize (stream->fragments, 0,
+        MAX_FRAG_HEADER + stream->frag_current);
+    stream->fragments = gst_buffer_append (stream->fragments, fragment);
+    GST_DEMUX_STATS_ADD (rmdemux, bytes_shared, size);
+  }
+}
+
+/* writes the number of fragments - 1 and, for each fragment, 0x00000001 and
+ * its offset, both 4 bytes little endian */
+static void
+gst_rmdemux_write_frag_header (GstRMDemuxStream * stream, guint8 * outdata)
+{
+  gint i;
+
+  *outdata++ = stream->frag_count - 1;
+  for (i = 0; i < stream->frag_count; i++) {
+    GST_WRITE_UINT32_LE (outdata, 0x00000001);
+    outdata += 4;
+    GST_WRITE_UINT32_LE (outdata, stream->frag_offset[i]);
+    outdata += 4;
+  }
+}
+
 static GstFlowReturn
 gst_rmdemux_parse_video_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
     GstBuffer * in, guint offset, guint16 version,
@@ -2286,43 +2509,60 @@ gst_rmdemux_parse_video_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
     }
     GST_DEBUG_OBJECT (rmdemux, "fragment size %d", fragment_size);
 
-    /* get the fragment */
+    if (fragment_size > size)
+      goto not_enough_data;
+
+    /* get the fragment, without copying the data */
     fragment =
-        gst_buffer_copy_region (in, GST_BUFFER_COPY_ALL, data - map.data,
+        gst_buffer_copy_region (in, GST_BUFFER_COPY_MEMORY, data - map.data,
         fragment_size);
 
     if (pkg_subseq == 1) {
       GST_DEBUG_OBJECT (rmdemux, "start new fragment");
-      gst_adapter_clear (stream->adapter);
+      gst_buffer_replace (&stream->fragments, NULL);
+      stream->frag_copied = FALSE;
       stream->frag_current = 0;
       stream->frag_count = 0;
       stream->frag_length = pkg_length;
     } else if (pkg_subseq == 0) {
       GST_DEBUG_OBJECT (rmdemux, "non fragmented packet");
+      gst_buffer_replace (&stream->fragments, NULL);
+      stream->frag_copied = FALSE;
       stream->frag_current = 0;
       stream->frag_count = 0;
       stream->frag_length = fragment_size;
     }
 
-    /* put fragment in adapter */
-    gst_adapter_push (stream->adapter, fragment);
+    if (stream->frag_count >= MAX_FRAGS) {
+      gst_buffer_unref (fragment);
+      goto too_many_fragments;
+    }
+
+    /* collect the memory of the fragments, as long as the header memory
+     * still fits in the buffer with them */
+    if (stream->fragments == NULL) {
+      stream->fragments = fragment;
+      GST_DEMUX_STATS_ADD (rmdemux, bytes_shared, fragment_size);
+    } else if (!stream->frag_copied
+        && stream->frag_count + 2 <= gst_buffer_get_max_memory ()) {
+      stream->fragments = gst_buffer_append (stream->fragments, fragment);
+      GST_DEMUX_STATS_ADD (rmdemux, bytes_shared, fragment_size);
+    } else {
+      gst_rmdemux_copy_fragment (rmdemux, stream, fragment);
+    }
     stream->frag_offset[stream->frag_count] = stream->frag_current;
     stream->frag_current += fragment_size;
     stream->frag_count++;
 
-    if (stream->frag_count > MAX_FRAGS)
-      goto too_many_fragments;
-
-    GST_DEBUG_OBJECT (rmdemux, "stored fragment in adapter %d/%d",
+    GST_DEBUG_OBJECT (rmdemux, "stored fragment %d/%d",
         stream->frag_current, stream->frag_length);
 
     /* flush fragment when complete */
     if (stream->frag_current >= stream->frag_length) {
       GstBuffer *out;
+      GstMemory *header;
       GstMapInfo outmap;
-      guint8 *outdata;
       guint header_size;
-      gint i, avail;
 
       /* calculate header size, which is:
        * 1 byte for the number of fragments - 1
@@ -2340,25 +2580,27 @@ gst_rmdemux_parse_video_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
           "fragmented completed. count %d, header_size %u", stream->frag_count,
           header_size);
 
-      avail = gst_adapter_available (stream->adapter);
-
-      out = gst_buffer_new_and_alloc (header_size + avail);
-      gst_buffer_map (out, &outmap, GST_MAP_WRITE);
-      outdata = outmap.data;
-
-      /* create header */
-      *outdata++ = stream->frag_count - 1;
-      for (i = 0; i < stream->frag_count; i++) {
-        GST_WRITE_UINT32_LE (outdata, 0x00000001);
-        outdata += 4;
-        GST_WRITE_UINT32_LE (outdata, stream->frag_offset[i]);
-        outdata += 4;
+      out = stream->fragments;
+      stream->fragments = NULL;
+      if (stream->frag_copied) {
+        /* the header goes in the room left in front of the copy */
+        header = gst_buffer_peek_memory (out, 0);
+        gst_memory_map (header, &outmap, GST_MAP_WRITE);
+        gst_rmdemux_write_frag_header (stream,
+            outmap.data + MAX_FRAG_HEADER - header_size);
+        gst_memory_unmap (header, &outmap);
+        gst_buffer_resize (out, MAX_FRAG_HEADER - header_size, -1);
+        stream->frag_copied = FALSE;
+      } else {
+        /* small enough to come from the slice allocator, the packet data
+         * follows it in the memory of the packets */
+        header = gst_allocator_alloc (NULL, header_size, NULL);
+        gst_memory_map (header, &outmap, GST_MAP_WRITE);
+        gst_rmdemux_write_frag_header (stream, outmap.data);
+        gst_memory_unmap (header, &outmap);
+        gst_buffer_prepend_memory (out, header);
       }
 
-      /* copy packet data after the header now */
-      gst_adapter_copy (stream->adapter, outdata, 0, avail);
-      gst_adapter_flush (stream->adapter, avail);
-
       stream->frag_current = 0;
       stream->frag_count = 0;
       stream->frag_length = 0;
@@ -2372,7 +2614,6 @@ gst_rmdemux_parse_video_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
         if (rmdemux->base_ts != -1)
           timestamp += rmdemux->base_ts;
       }
-      gst_buffer_unmap (out, &outmap);
 
       /* video has DTS */
       GST_BUFFER_DTS (out) = timestamp;
@@ -2435,6 +2676,7 @@ gst_rmdemux_parse_audio_packet (GstRMDemux * rmdemux, GstRMDemuxStream * stream,
   GstBuffer *buffer;
 
   buffer = gst_buffer_copy_region (in, GST_BUFFER_COPY_MEMORY, offset, -1);
+  GST_DEMUX_STATS_ADD (rmdemux, bytes_shared, gst_buffer_get_size (buffer));
 
   if (rmdemux->first_ts != -1 && timestamp > rmdemux->first_ts)
     timestamp -= rmdemux->first_ts;
@@ -2482,6 +2724,7 @@ gst_rmdemux_parse_packet (GstRMDemux * rmdemux, GstBuffer * in, guint16 version)
   guint8 *data;
   guint8 flags;
   guint32 ts;
+  guint packet_end;
 
   gst_buffer_map (in, &map, GST_MAP_READ);
   data = map.data;
@@ -2555,15 +2798,25 @@ gst_rmdemux_parse_packet (GstRMDemux * rmdemux, GstBuffer * in, guint16 version)
     stream->pending_tags = NULL;
   }
 
-  if ((rmdemux->offset + size) <= stream->seek_offset) {
+  /* in pull mode, the adapter holds what follows the packet, up to the
+   * offset */
+  if (GST_PAD_MODE (rmdemux->sinkpad) == GST_PAD_MODE_PULL)
+    packet_end = rmdemux->offset - gst_adapter_available (rmdemux->adapter);
+  else
+    packet_end = rmdemux->offset + size;
+
+  if (packet_end <= stream->seek_offset) {
     GST_DEBUG_OBJECT (rmdemux,
-        "Stream %d is skipping: seek_offset=%d, offset=%d, size=%"
-        G_GSIZE_FORMAT, stream->id, stream->seek_offset, rmdemux->offset, size);
+        "Stream %d is skipping: seek_offset=%d, packet end=%u, size=%"
+        G_GSIZE_FORMAT, stream->id, stream->seek_offset, packet_end, size);
+    GST_DEMUX_STATS_INC (rmdemux, packets_dropped);
     cret = GST_FLOW_OK;
     gst_buffer_unref (in);
     goto beach;
   }
 
+  GST_DEMUX_STATS_INC (rmdemux, packets_parsed);
+
   /* do special headers */
   if (stream->subtype == GST_RMDEMUX_STREAM_VIDEO) {
     ret =
@@ -2589,6 +2842,7 @@ unknown_stream:
   {
     GST_WARNING_OBJECT (rmdemux, "No stream for stream id %d in parsing "
         "data packet", id);
+    GST_DEMUX_STATS_INC (rmdemux, packets_dropped);
     gst_buffer_unmap (in, &map);
     gst_buffer_unref (in);
     return GST_FLOW_OK;
@@ -25,6 +25,7 @@
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstflowcombiner.h>
 #include <gst/pbutils/descriptions.h>
+#include <gst/demux-stats-private.h>
 
 G_BEGIN_DECLS
 
@@ -103,6 +104,7 @@ struct _GstRMDemux {
 
   guint offset;
   gboolean seekable;
+  guint read_ahead;
 
   GstRMDemuxState state;
   GstRMDemuxLoopState loop_state;
@@ -132,6 +134,8 @@ struct _GstRMDemux {
 
   /* container tags for all streams */
   GstTagList *pending_tags;
+
+  GstDemuxStats stats;
 };
 
 struct _GstRMDemuxClass {
@@ -22,6 +22,15 @@
  * SECTION:element-rtspreal
  *
  * A RealMedia RTSP extension
+ *
+ * The ASM rules of the streams are selected for the #GstRTSPReal:bandwidth.
+ * When #GstRTSPReal:adaptive is enabled, the rules are selected again for the
+ * rate at which the data of every stream is received when it stays below what
+ * the subscribed rules should deliver. When the rate recovers, the bandwidth
+ * is raised again step by step. rdtmanager finds us through the
+ * "x-real-context" field that we put in the stream caps and passes us the
+ * rates. When we select other rules, it has rtspsrc send a SET_PARAMETER
+ * request from its own thread, and we put the rules in its Subscribe header.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -45,7 +54,31 @@ GST_DEBUG_CATEGORY_STATIC (rtspreal_debug);
 #define GST_CAT_DEFAULT (rtspreal_debug)
 
 #define SERVER_PREFIX "RealServer"
-#define DEFAULT_BANDWIDTH	"10485800"
+
+#define DEFAULT_BANDWIDTH	10485800
+#define DEFAULT_ADAPTIVE	TRUE
+
+/* receiving less than 4/5 of the expected rate in this many report intervals
+ * in a row makes us select rules for the rate we get */
+#define BAD_REPORTS		2
+/* after this many intervals in a row with at least 19/20 of the expected rate
+ * we try half again the bandwidth */
+#define GOOD_REPORTS		5
+
+enum
+{
+  PROP_0,
+  PROP_BANDWIDTH,
+  PROP_ADAPTIVE
+};
+
+/* the contexts that rdtmanager can report the receive rate to, context id
+ * -> GWeakRef to the GstRTSPReal */
+static GMutex contexts_lock;
+static GHashTable *contexts;
+static guint next_context = 1;
+
+static void gst_rtsp_stream_free (GstRTSPRealStream * stream);
 
 static GstRTSPResult
 rtsp_ext_real_get_transports (GstRTSPExtension * ext,
@@ -112,8 +145,12 @@ rtsp_ext_real_before_send (GstRTSPExtension * ext, GstRTSPMessage * request)
     case GST_RTSP_DESCRIBE:
     {
       if (ctx->isreal) {
-        gst_rtsp_message_add_header (request, GST_RTSP_HDR_BANDWIDTH,
-            DEFAULT_BANDWIDTH);
+        gchar *value;
+
+        GST_OBJECT_LOCK (ctx);
+        value = g_strdup_printf ("%u", ctx->bandwidth);
+        GST_OBJECT_UNLOCK (ctx);
+        gst_rtsp_message_take_header (request, GST_RTSP_HDR_BANDWIDTH, value);
         gst_rtsp_message_add_header (request, GST_RTSP_HDR_GUID,
             "00000000-0000-0000-0000-000000000000");
         gst_rtsp_message_add_header (request, GST_RTSP_HDR_REGION_DATA, "0");
@@ -138,6 +175,30 @@ rtsp_ext_real_before_send (GstRTSPExtension * ext, GstRTSPMessage * request)
       }
       break;
     }
+    case GST_RTSP_SET_PARAMETER:
+    {
+      guint8 *data;
+      guint size;
+      gchar *body, *rules;
+
+      gst_rtsp_message_get_body (request, &data, &size);
+      body = g_strndup ((gchar *) data, size);
+      if (!g_str_has_prefix (body, GST_RTSP_REAL_SUBSCRIBE_PARAMETER ":")) {
+        g_free (body);
+        break;
+      }
+
+      /* the rules rdtmanager got from us go in the Subscribe header */
+      rules = g_strdup (body + strlen (GST_RTSP_REAL_SUBSCRIBE_PARAMETER ":"));
+      g_strstrip (rules);
+      g_free (body);
+      gst_rtsp_message_set_body (request, NULL, 0);
+      gst_rtsp_message_remove_header (request, GST_RTSP_HDR_CONTENT_TYPE, -1);
+
+      GST_INFO_OBJECT (ctx, "subscribing to %s", rules);
+      gst_rtsp_message_take_header (request, GST_RTSP_HDR_SUBSCRIBE, rules);
+      break;
+    }
     default:
       break;
   }
@@ -266,6 +327,85 @@ G_STMT_START {			                      \
   datap += str_len + 2;                               \
 } G_STMT_END
 
+/* matches the rules of @stream for @bandwidth, the other variables of the
+ * rulebook are 0 */
+static gint
+rtsp_ext_real_match_stream (GstRTSPRealStream * stream, guint bandwidth,
+    gint * rulematches)
+{
+  GstASMRuleBook *book = stream->rulebook;
+  gfloat *values;
+  gint slot;
+
+  values = g_newa (gfloat, MAX (book->n_vars, 1));
+  memset (values, 0, MAX (book->n_vars, 1) * sizeof (gfloat));
+
+  slot = gst_asm_rule_book_get_var_slot (book, "Bandwidth");
+  if (slot >= 0)
+    values[slot] = bandwidth;
+
+  return gst_asm_rule_book_match_values (book, values, rulematches);
+}
+
+/* the MLTI codec the first rule matching @bandwidth selects, or -1 when the
+ * stream has no MLTI table */
+static gint
+rtsp_ext_real_get_codec (GstRTSPRealStream * stream, guint bandwidth)
+{
+  gint rulematches[MAX_RULEMATCHES];
+  gint n, sel;
+
+  if (stream->rule_codecs == NULL)
+    return -1;
+
+  n = rtsp_ext_real_match_stream (stream, bandwidth, rulematches);
+  sel = n > 0 ? rulematches[0] : 0;
+  if (sel >= stream->n_rule_codecs)
+    return -1;
+
+  return stream->rule_codecs[sel];
+}
+
+/* makes the Subscribe value for the rules matching @bandwidth and updates the
+ * rate that the streams are expected to be received at */
+static gchar *
+rtsp_ext_real_select_rules (GstRTSPReal * ctx, guint bandwidth)
+{
+  GString *rules;
+  GList *walk;
+
+  rules = g_string_new ("");
+
+  for (walk = ctx->streams; walk; walk = g_list_next (walk)) {
+    GstRTSPRealStream *stream = (GstRTSPRealStream *) walk->data;
+    gint rulematches[MAX_RULEMATCHES];
+    gint j, n;
+    guint rate = 0;
+
+    n = rtsp_ext_real_match_stream (stream, bandwidth, rulematches);
+    for (j = 0; j < n; j++) {
+      GstASMRule *rule;
+      const gchar *avg;
+
+      g_string_append_printf (rules, "stream=%u;rule=%u,", stream->id,
+          rulematches[j]);
+
+      rule = g_list_nth_data (stream->rulebook->rules, rulematches[j]);
+      avg = g_hash_table_lookup (rule->props, "AverageBandwidth");
+      if (avg)
+        rate += atoi (avg);
+    }
+    stream->expected_bit_rate = rate;
+    stream->have_rate = FALSE;
+  }
+
+  /* strip final , if we added some stream rules */
+  if (rules->len > 0)
+    g_string_truncate (rules, rules->len - 1);
+
+  return g_string_free (rules, FALSE);
+}
+
 static GstRTSPResult
 rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
     GstStructure * props)
@@ -280,14 +420,27 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
   GstBuffer *buf;
   gchar *opaque_data;
   gsize opaque_data_len, asm_rule_book_len;
-  GHashTable *vars;
-  GString *rules;
+  guint bandwidth;
 
   /* don't bother for non-real formats */
   READ_INT (sdp, "IsRealDataType", ctx->isreal);
   if (!ctx->isreal)
     return TRUE;
 
+  /* called again for every DESCRIBE, start from scratch */
+  GST_OBJECT_LOCK (ctx);
+  g_list_foreach (ctx->streams, (GFunc) gst_rtsp_stream_free, NULL);
+  g_list_free (ctx->streams);
+  ctx->streams = NULL;
+  g_free (ctx->rules);
+  ctx->rules = NULL;
+  ctx->subscribed = FALSE;
+  bandwidth = ctx->bandwidth;
+  ctx->current_bandwidth = bandwidth;
+  ctx->good_reports = 0;
+  ctx->bad_reports = 0;
+  GST_OBJECT_UNLOCK (ctx);
+
   /* Force PAUSE | PLAY */
   //src->methods |= GST_RTSP_PLAY | GST_RTSP_PAUSE;
 
@@ -360,12 +513,6 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
   WRITE_STRING2 (datap, comment, comment_len);
   offset += size;
 
-  /* fix the hashtale for the rule parser */
-  rules = g_string_new ("");
-  vars = g_hash_table_new (g_str_hash, g_str_equal);
-  g_hash_table_insert (vars, (gchar *) "Bandwidth",
-      (gchar *) DEFAULT_BANDWIDTH);
-
   /* MDPR */
   for (i = 0; i < ctx->n_streams; i++) {
     const GstSDPMedia *media;
@@ -381,6 +528,7 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
       continue;
 
     stream = g_new0 (GstRTSPRealStream, 1);
+    stream->id = i;
     ctx->streams = g_list_append (ctx->streams, stream);
 
     READ_INT_M (media, "MaxBitRate", stream->max_bit_rate);
@@ -395,35 +543,12 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
     READ_STRING (media, "mimetype", str, stream->mime_type_len);
     stream->mime_type = g_strndup (str, stream->mime_type_len);
 
-    /* FIXME: Depending on the current bandwidth, we need to select one
-     * bandwith out of a list offered by the server. Someone needs to write
-     * a parser for strings like
-     *
-     * #($Bandwidth < 67959),TimestampDelivery=T,DropByN=T,priority=9;
-     * #($Bandwidth >= 67959) && ($Bandwidth < 167959),AverageBandwidth=67959,
-     * Priority=9;#($Bandwidth >= 67959) && ($Bandwidth < 167959),
-     * AverageBandwidth=0,Priority=5,OnDepend=\"1\";
-     * #($Bandwidth >= 167959) && ($Bandwidth < 267959),
-     * AverageBandwidth=167959,Priority=9;
-     * #($Bandwidth >= 167959) && ($Bandwidth < 267959),AverageBandwidth=0,
-     * Priority=5,OnDepend=\"3\";#($Bandwidth >= 267959),
-     * AverageBandwidth=267959,Priority=9;#($Bandwidth >= 267959),
-     * AverageBandwidth=0,Priority=5,OnDepend=\"5\";
-     *
-     * As I don't know how to do that, I just use the first entry (sel = 0).
-     * But to give you a starting point, I offer you above string
-     * in the variable 'asm_rule_book'.
-     */
     READ_STRING (media, "ASMRuleBook", str, asm_rule_book_len);
-    stream->rulebook = gst_asm_rule_book_new (str);
+    stream->rulebook = gst_asm_rule_book_new_cached (str);
 
-    n = gst_asm_rule_book_match (stream->rulebook, vars, rulematches);
-    for (j = 0; j < n; j++) {
-      g_string_append_printf (rules, "stream=%u;rule=%u,", i, rulematches[j]);
-    }
-
-    /* get the MLTI for the first matched rules */
-    sel = rulematches[0];
+    /* get the MLTI for the first matched rule */
+    n = rtsp_ext_real_match_stream (stream, bandwidth, rulematches);
+    sel = n > 0 ? rulematches[0] : 0;
 
     READ_BUFFER_M (media, "OpaqueData", opaque_data, opaque_data_len);
 
@@ -455,30 +580,21 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
       goto strange_opaque_data;
     }
 
-    if (opaque_data_len < 2 * sel) {
+    /* keep the codec of every rule, the rules we select later must not
+     * switch to another codec */
+    if (opaque_data_len < 2 * stream->num_rules) {
       GST_DEBUG_OBJECT (ctx, "opaque_data_len %" G_GSIZE_FORMAT
-          " < 2 * sel (%d)", opaque_data_len, 2 * sel);
+          " < 2 * num_rules (%d)", opaque_data_len, 2 * stream->num_rules);
       goto strange_opaque_data;
     }
-    opaque_data += 2 * sel;
-    opaque_data_len -= 2 * sel;
-
-    if (opaque_data_len < 2) {
-      GST_DEBUG_OBJECT (ctx, "opaque_data_len %" G_GSIZE_FORMAT " < 2",
-          opaque_data_len);
-      goto strange_opaque_data;
-    }
-    stream->codec = GST_READ_UINT16_BE (opaque_data);
-    opaque_data += 2;
-    opaque_data_len -= 2;
+    stream->n_rule_codecs = stream->num_rules;
+    stream->rule_codecs = g_new (guint16, stream->num_rules);
+    for (j = 0; j < stream->num_rules; j++)
+      stream->rule_codecs[j] = GST_READ_UINT16_BE (opaque_data + 2 * j);
+    opaque_data += 2 * stream->num_rules;
+    opaque_data_len -= 2 * stream->num_rules;
 
-    if (opaque_data_len < 2 * (stream->num_rules - sel - 1)) {
-      GST_DEBUG_OBJECT (ctx, "opaque_data_len %" G_GSIZE_FORMAT
-          " < %d", opaque_data_len, 2 * (stream->num_rules - sel - 1));
-      goto strange_opaque_data;
-    }
-    opaque_data += 2 * (stream->num_rules - sel - 1);
-    opaque_data_len -= 2 * (stream->num_rules - sel - 1);
+    stream->codec = stream->rule_codecs[sel];
 
     if (opaque_data_len < 2) {
       GST_DEBUG_OBJECT (ctx, "opaque_data_len %" G_GSIZE_FORMAT " < 2",
@@ -559,16 +675,13 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
     offset += size;
   }
 
-  /* destroy the rulebook hashtable now */
-  g_hash_table_destroy (vars);
-
-  /* strip final , if we added some stream rules */
-  if (rules->len > 0) {
-    rules = g_string_truncate (rules, rules->len - 1);
-  }
-
   /* and store rules in the context */
-  ctx->rules = g_string_free (rules, FALSE);
+  GST_OBJECT_LOCK (ctx);
+  ctx->rules = rtsp_ext_real_select_rules (ctx, bandwidth);
+  GST_OBJECT_UNLOCK (ctx);
+
+  /* so that rdtmanager can find us */
+  gst_structure_set (props, "x-real-context", G_TYPE_UINT, ctx->context, NULL);
 
   /* DATA */
   size = 18;
@@ -598,8 +711,6 @@ rtsp_ext_real_parse_sdp (GstRTSPExtension * ext, GstSDPMessage * sdp,
   /* ERRORS */
 strange_opaque_data:
   {
-    g_string_free (rules, TRUE);
-    g_hash_table_destroy (vars);
     g_free (data);
 
     GST_ELEMENT_ERROR (ctx, RESOURCE, WRITE, ("Strange opaque data."), (NULL));
@@ -607,21 +718,16 @@ strange_opaque_data:
   }
 }
 
+/* sends a SET_PARAMETER to subscribe to @rules */
 static GstRTSPResult
-rtsp_ext_real_stream_select (GstRTSPExtension * ext, GstRTSPUrl * url)
+rtsp_ext_real_subscribe (GstRTSPReal * ctx, GstRTSPUrl * url,
+    const gchar * rules)
 {
-  GstRTSPReal *ctx = (GstRTSPReal *) ext;
   GstRTSPResult res;
   GstRTSPMessage request = { 0 };
   GstRTSPMessage response = { 0 };
   gchar *req_url;
 
-  if (!ctx->isreal)
-    return GST_RTSP_OK;
-
-  if (!ctx->rules)
-    return GST_RTSP_OK;
-
   req_url = gst_rtsp_url_get_request_uri (url);
 
   /* create SET_PARAMETER */
@@ -631,10 +737,11 @@ rtsp_ext_real_stream_select (GstRTSPExtension * ext, GstRTSPUrl * url)
 
   g_free (req_url);
 
-  gst_rtsp_message_add_header (&request, GST_RTSP_HDR_SUBSCRIBE, ctx->rules);
+  gst_rtsp_message_add_header (&request, GST_RTSP_HDR_SUBSCRIBE, rules);
 
   /* send SET_PARAMETER */
-  if ((res = gst_rtsp_extension_send (ext, &request, &response)) < 0)
+  if ((res = gst_rtsp_extension_send (GST_RTSP_EXTENSION (ctx), &request,
+              &response)) < 0)
     goto send_error;
 
   gst_rtsp_message_unset (&request);
@@ -664,9 +771,203 @@ reset:
   }
 }
 
+static GstRTSPResult
+rtsp_ext_real_stream_select (GstRTSPExtension * ext, GstRTSPUrl * url)
+{
+  GstRTSPReal *ctx = (GstRTSPReal *) ext;
+  GstRTSPResult res;
+  gchar *rules;
+
+  if (!ctx->isreal)
+    return GST_RTSP_OK;
+
+  GST_OBJECT_LOCK (ctx);
+  rules = g_strdup (ctx->rules);
+  /* the rates are only of use once we have subscribed */
+  ctx->subscribed = rules != NULL;
+  GST_OBJECT_UNLOCK (ctx);
+
+  if (!rules)
+    return GST_RTSP_OK;
+
+  res = rtsp_ext_real_subscribe (ctx, url, rules);
+  g_free (rules);
+
+  return res;
+}
+
+/* called with the object lock once per report interval, returns the
+ * bandwidth to select the rules for. The streams without a rate in the
+ * interval count as received at the expected rate. */
+static guint
+rtsp_ext_real_adapt_bandwidth (GstRTSPReal * ctx)
+{
+  GList *walk;
+  guint64 expected = 0, received = 0;
+  guint bandwidth = ctx->current_bandwidth;
+
+  for (walk = ctx->streams; walk; walk = g_list_next (walk)) {
+    GstRTSPRealStream *stream = (GstRTSPRealStream *) walk->data;
+
+    /* rules without an average bandwidth, we can't tell */
+    if (stream->expected_bit_rate == 0)
+      continue;
+
+    expected += stream->expected_bit_rate;
+    received += stream->have_rate ? stream->received_bit_rate :
+        stream->expected_bit_rate;
+  }
+  if (expected == 0)
+    return bandwidth;
+
+  if (received * 5 < expected * 4) {
+    ctx->good_reports = 0;
+    if (++ctx->bad_reports >= BAD_REPORTS) {
+      GST_DEBUG_OBJECT (ctx, "received %" G_GUINT64_FORMAT " of %"
+          G_GUINT64_FORMAT " bits/s", received, expected);
+      bandwidth = MAX (received, 1);
+      ctx->bad_reports = 0;
+    }
+  } else if (received * 20 >= expected * 19) {
+    ctx->bad_reports = 0;
+    if (++ctx->good_reports >= GOOD_REPORTS && bandwidth < ctx->bandwidth) {
+      GST_DEBUG_OBJECT (ctx, "received %" G_GUINT64_FORMAT " bits/s, "
+          "trying more", received);
+      bandwidth = MIN ((guint64) bandwidth * 3 / 2, ctx->bandwidth);
+      ctx->good_reports = 0;
+    }
+  } else {
+    ctx->good_reports = 0;
+    ctx->bad_reports = 0;
+  }
+
+  return bandwidth;
+}
+
+/* called with the object lock at the end of a report interval, returns the
+ * rules to subscribe to instead of the current ones, or NULL */
+static gchar *
+rtsp_ext_real_update_rules (GstRTSPReal * ctx)
+{
+  GList *walk;
+  gchar *rules;
+  guint bandwidth;
+
+  bandwidth = rtsp_ext_real_adapt_bandwidth (ctx);
+  for (walk = ctx->streams; walk; walk = g_list_next (walk))
+    ((GstRTSPRealStream *) walk->data)->have_rate = FALSE;
+
+  if (bandwidth == ctx->current_bandwidth)
+    return NULL;
+
+  /* the decoders are set up for one codec of every stream */
+  for (walk = ctx->streams; walk; walk = g_list_next (walk)) {
+    GstRTSPRealStream *stream = (GstRTSPRealStream *) walk->data;
+    gint codec = rtsp_ext_real_get_codec (stream, bandwidth);
+
+    if (codec >= 0 && codec != stream->codec) {
+      GST_DEBUG_OBJECT (ctx, "bandwidth %u needs codec %d for stream %u, "
+          "not %u", bandwidth, codec, stream->id, stream->codec);
+      return NULL;
+    }
+  }
+
+  GST_DEBUG_OBJECT (ctx, "selecting rules for bandwidth %u", bandwidth);
+  ctx->current_bandwidth = bandwidth;
+  rules = rtsp_ext_real_select_rules (ctx, bandwidth);
+  if (!g_strcmp0 (rules, ctx->rules)) {
+    g_free (rules);
+    return NULL;
+  }
+  g_free (ctx->rules);
+  ctx->rules = g_strdup (rules);
+
+  return rules;
+}
+
+/* A report interval ends when every stream that we expect a rate of has
+ * reported, or when a stream reports again before the others did. Returns
+ * the rules to subscribe to instead of the current ones, or NULL. */
+static gchar *
+rtsp_ext_real_report_rate (GstRTSPReal * ctx, guint id, guint64 bitrate)
+{
+  GstRTSPRealStream *stream = NULL;
+  GList *walk;
+  gchar *rules = NULL;
+  gboolean complete = TRUE;
+
+  GST_LOG_OBJECT (ctx, "stream %u received at %" G_GUINT64_FORMAT " bits/s",
+      id, bitrate);
+
+  GST_OBJECT_LOCK (ctx);
+  if (!ctx->isreal || !ctx->adaptive || !ctx->subscribed)
+    goto done;
+
+  for (walk = ctx->streams; walk; walk = g_list_next (walk)) {
+    if (((GstRTSPRealStream *) walk->data)->id == id)
+      stream = walk->data;
+  }
+  /* rules without an average bandwidth, we can't tell */
+  if (stream == NULL || stream->expected_bit_rate == 0)
+    goto done;
+
+  if (stream->have_rate) {
+    rules = rtsp_ext_real_update_rules (ctx);
+    complete = FALSE;
+  }
+
+  stream->received_bit_rate = MIN (bitrate, G_MAXUINT);
+  stream->have_rate = TRUE;
+
+  for (walk = ctx->streams; walk && complete; walk = g_list_next (walk)) {
+    GstRTSPRealStream *s = (GstRTSPRealStream *) walk->data;
+
+    if (s->expected_bit_rate > 0 && !s->have_rate)
+      complete = FALSE;
+  }
+  if (complete)
+    rules = rtsp_ext_real_update_rules (ctx);
+
+done:
+  GST_OBJECT_UNLOCK (ctx);
+
+  return rules;
+}
+
+/* called by rdtmanager with the rate at which @stream of @context was
+ * received, returns the rules to subscribe to or NULL when they stay the
+ * same */
+gchar *
+gst_rtsp_real_report_bitrate (guint context, guint stream, guint64 bitrate)
+{
+  GstRTSPReal *ctx = NULL;
+  GWeakRef *ref;
+  gchar *rules;
+
+  g_mutex_lock (&contexts_lock);
+  if (contexts != NULL) {
+    ref = g_hash_table_lookup (contexts, GUINT_TO_POINTER (context));
+    if (ref != NULL)
+      ctx = g_weak_ref_get (ref);
+  }
+  g_mutex_unlock (&contexts_lock);
+
+  if (ctx == NULL)
+    return NULL;
+
+  rules = rtsp_ext_real_report_rate (ctx, stream, bitrate);
+  gst_object_unref (ctx);
+
+  return rules;
+}
+
 static void gst_rtsp_real_extension_init (gpointer g_iface,
     gpointer iface_data);
 static void gst_rtsp_real_finalize (GObject * obj);
+static void gst_rtsp_real_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtsp_real_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 #define gst_rtsp_real_parent_class parent_class
 G_DEFINE_TYPE_WITH_CODE (GstRTSPReal, gst_rtsp_real, GST_TYPE_ELEMENT,
@@ -680,6 +981,31 @@ gst_rtsp_real_class_init (GstRTSPRealClass * g_class)
   GstElementClass *gstelement_class = (GstElementClass *) g_class;
 
   gobject_class->finalize = gst_rtsp_real_finalize;
+  gobject_class->set_property = gst_rtsp_real_set_property;
+  gobject_class->get_property = gst_rtsp_real_get_property;
+
+  /**
+   * GstRTSPReal:bandwidth:
+   *
+   * The bandwidth in bits/s that the ASM rules of the streams are selected
+   * for. With #GstRTSPReal:adaptive, the rules are never selected for more.
+   */
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH,
+      g_param_spec_uint ("bandwidth", "Bandwidth",
+          "The bandwidth to select the stream rules for (bits/s)", 1,
+          G_MAXUINT, DEFAULT_BANDWIDTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRTSPReal:adaptive:
+   *
+   * Select other ASM rules when the streams are received at another rate
+   * than the subscribed rules should deliver.
+   */
+  g_object_class_install_property (gobject_class, PROP_ADAPTIVE,
+      g_param_spec_boolean ("adaptive", "Adaptive",
+          "Select the stream rules for the rate data is received at",
+          DEFAULT_ADAPTIVE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "RealMedia RTSP Extension", "Network/Extension/Protocol",
@@ -693,7 +1019,22 @@ gst_rtsp_real_class_init (GstRTSPRealClass * g_class)
 static void
 gst_rtsp_real_init (GstRTSPReal * rtspreal)
 {
+  GWeakRef *ref;
+
   rtspreal->isreal = FALSE;
+  rtspreal->bandwidth = DEFAULT_BANDWIDTH;
+  rtspreal->adaptive = DEFAULT_ADAPTIVE;
+  rtspreal->current_bandwidth = DEFAULT_BANDWIDTH;
+
+  ref = g_new0 (GWeakRef, 1);
+  g_weak_ref_init (ref, rtspreal);
+
+  g_mutex_lock (&contexts_lock);
+  if (contexts == NULL)
+    contexts = g_hash_table_new (NULL, NULL);
+  rtspreal->context = next_context++;
+  g_hash_table_insert (contexts, GUINT_TO_POINTER (rtspreal->context), ref);
+  g_mutex_unlock (&contexts_lock);
 }
 
 static void
@@ -703,6 +1044,7 @@ gst_rtsp_stream_free (GstRTSPRealStream * stream)
   g_free (stream->mime_type);
   gst_asm_rule_book_free (stream->rulebook);
   g_free (stream->type_specific_data);
+  g_free (stream->rule_codecs);
 
   g_free (stream);
 }
@@ -711,6 +1053,14 @@ static void
 gst_rtsp_real_finalize (GObject * obj)
 {
   GstRTSPReal *r = (GstRTSPReal *) obj;
+  GWeakRef *ref;
+
+  g_mutex_lock (&contexts_lock);
+  ref = g_hash_table_lookup (contexts, GUINT_TO_POINTER (r->context));
+  g_hash_table_remove (contexts, GUINT_TO_POINTER (r->context));
+  g_mutex_unlock (&contexts_lock);
+  g_weak_ref_clear (ref);
+  g_free (ref);
 
   g_list_foreach (r->streams, (GFunc) gst_rtsp_stream_free, NULL);
   g_list_free (r->streams);
@@ -719,6 +1069,52 @@ gst_rtsp_real_finalize (GObject * obj)
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
+static void
+gst_rtsp_real_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRTSPReal *r = (GstRTSPReal *) object;
+
+  switch (prop_id) {
+    case PROP_BANDWIDTH:
+      GST_OBJECT_LOCK (r);
+      r->bandwidth = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (r);
+      break;
+    case PROP_ADAPTIVE:
+      GST_OBJECT_LOCK (r);
+      r->adaptive = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (r);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtsp_real_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstRTSPReal *r = (GstRTSPReal *) object;
+
+  switch (prop_id) {
+    case PROP_BANDWIDTH:
+      GST_OBJECT_LOCK (r);
+      g_value_set_uint (value, r->bandwidth);
+      GST_OBJECT_UNLOCK (r);
+      break;
+    case PROP_ADAPTIVE:
+      GST_OBJECT_LOCK (r);
+      g_value_set_boolean (value, r->adaptive);
+      GST_OBJECT_UNLOCK (r);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_rtsp_real_extension_init (gpointer g_iface, gpointer iface_data)
 {
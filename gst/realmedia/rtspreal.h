@@ -32,6 +32,10 @@ G_BEGIN_DECLS
 #define GST_RTSP_REAL(obj)  		(G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTSP_REAL, GstRTSPReal))
 #define GST_RTSP_REAL_CLASS(klass)  	(G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTSP_REAL, GstRTSPRealClass))
 
+/* the parameter of the SET_PARAMETER requests that rdtmanager has rtspsrc
+ * send for new rules, we put its value in the Subscribe header */
+#define GST_RTSP_REAL_SUBSCRIBE_PARAMETER "x-real-subscribe"
+
 typedef struct _GstRTSPReal GstRTSPReal;
 typedef struct _GstRTSPRealClass GstRTSPRealClass;
 
@@ -57,6 +61,15 @@ struct _GstRTSPRealStream {
   guint  type_specific_data_len;
 
   guint16 num_rules, j, sel, codec;
+
+  /* the MLTI table, the type specific data of each rule */
+  guint16 *rule_codecs;
+  guint    n_rule_codecs;
+
+  /* bits/s of the subscribed rules and as received */
+  guint    expected_bit_rate;
+  guint    received_bit_rate;
+  gboolean have_rate;
 };
 
 struct _GstRTSPReal {
@@ -77,6 +90,17 @@ struct _GstRTSPReal {
   guint  duration;
 
   gchar *rules;
+
+  /* identifies us in the caps, for the rate reports of rdtmanager */
+  guint   context;
+
+  /* protected by the object lock */
+  guint   bandwidth;
+  gboolean adaptive;
+  guint   current_bandwidth;
+  guint   good_reports;
+  guint   bad_reports;
+  gboolean subscribed;
 };
 
 struct _GstRTSPRealClass {
@@ -87,6 +111,9 @@ GType gst_rtsp_real_get_type(void);
 
 gboolean gst_rtsp_real_plugin_init (GstPlugin * plugin);
 
+gchar * gst_rtsp_real_report_bitrate (guint context, guint stream,
+                                      guint64 bitrate);
+
 G_END_DECLS
 
 #endif /* __GST_RTSP_REAL_H__ */
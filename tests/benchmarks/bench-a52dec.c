@@ -0,0 +1,73 @@
+/* GStreamer
+ *
+ * Benchmark for a52dec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+#include "mediagen.h"
+
+#include <string.h>
+
+#define N_FRAMES 2000
+
+int
+main (int argc, char **argv)
+{
+  static const guint threads[] = { 1, 2, 4, 0 };
+  static const gchar *layouts[] = { "stereo", "5.1" };
+  BenchInput *input;
+  guint8 *stream;
+  guint i, l, n_frames;
+
+  if (!bench_init (&argc, &argv, "a52dec"))
+    return 1;
+  if (!bench_have_element ("a52dec"))
+    return BENCH_EXIT_SKIP;
+
+  n_frames = N_FRAMES * bench_get_scale ();
+  stream = g_malloc (n_frames * MEDIA_GEN_AC3_FRAME_SIZE);
+
+  for (l = 0; l < G_N_ELEMENTS (layouts); l++) {
+    media_gen_ac3_frame (stream, l > 0);
+    for (i = 1; i < n_frames; i++)
+      memcpy (stream + i * MEDIA_GEN_AC3_FRAME_SIZE, stream,
+          MEDIA_GEN_AC3_FRAME_SIZE);
+
+    /* not aligned to frames, like it would come from a demuxer or file */
+    input = bench_input_new ("audio/x-ac3", GST_FORMAT_TIME);
+    bench_input_add_chunked (input, stream, n_frames * MEDIA_GEN_AC3_FRAME_SIZE,
+        4096);
+
+    for (i = 0; i < G_N_ELEMENTS (threads); i++) {
+      gchar *name = g_strdup_printf ("%s,threads=%u", layouts[l],
+          threads[i]);
+
+      bench_run (name, "a52dec", input, "threads", threads[i], NULL);
+      g_free (name);
+    }
+
+    bench_input_free (input);
+  }
+  g_free (stream);
+
+  return bench_finish ();
+}
@@ -0,0 +1,93 @@
+/* GStreamer
+ *
+ * Benchmark for asfdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+#include "mediagen.h"
+
+/* one PCM stream, 44.1 kHz stereo, in media objects of 10 ms */
+#define N_OBJECTS 6000
+#define OBJECT_SIZE 1764
+
+static void
+run_case (const gchar * name, MediaGenAsf * gen)
+{
+  BenchInput *input;
+  GByteArray *file;
+
+  gen->n_objects = N_OBJECTS * bench_get_scale ();
+
+  file = g_byte_array_new ();
+  if (!media_gen_asf_write (gen, media_gen_write_byte_array, file))
+    g_error ("could not generate %s stream", name);
+
+  input = bench_input_new ("video/x-ms-asf", GST_FORMAT_BYTES);
+  bench_input_add_chunked (input, file->data, file->len, 4096);
+  g_byte_array_unref (file);
+
+  bench_run (name, "asfdemux", input, NULL);
+
+  bench_input_free (input);
+}
+
+int
+main (int argc, char **argv)
+{
+  MediaGenAsf gen;
+
+  if (!bench_init (&argc, &argv, "asfdemux"))
+    return 1;
+  if (!bench_have_element ("asfdemux"))
+    return BENCH_EXIT_SKIP;
+
+  /* exactly one object per packet, several objects per packet, and
+   * objects fragmented over several packets */
+  media_gen_asf_init (&gen);
+  gen.packet_size = MEDIA_GEN_ASF_PACKET_HEADER_SIZE +
+      MEDIA_GEN_ASF_PAYLOAD_HEADER_SIZE + OBJECT_SIZE;
+  run_case ("single-payload", &gen);
+
+  media_gen_asf_init (&gen);
+  gen.multiple_payloads = TRUE;
+  run_case ("multiple-payloads", &gen);
+
+  media_gen_asf_init (&gen);
+  gen.packet_size = 512;
+  run_case ("fragmented", &gen);
+
+  /* objects of 4 rows of 1024 bytes, descrambled in chunks of 128 bytes */
+  media_gen_asf_init (&gen);
+  gen.span = 4;
+  gen.ds_packet_size = 1024;
+  gen.ds_chunk_size = 128;
+  run_case ("span", &gen);
+
+  /* the extra header and index objects */
+  media_gen_asf_init (&gen);
+  gen.multiple_payloads = TRUE;
+  gen.simple_index = TRUE;
+  gen.ext_stream_props = TRUE;
+  run_case ("index-ext-props", &gen);
+
+  return bench_finish ();
+}
@@ -0,0 +1,647 @@
+/* GStreamer
+ *
+ * Common code for the element benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every benchmark drives a single element as
+ *
+ *   appsrc ! element ! fakesink sync=false (one per source pad)
+ *
+ * or, for inputs written to a file, with filesrc in place of appsrc so
+ * that the element can work in pull mode. The pipeline is driven from the
+ * main thread, and one JSON object per case is printed on stdout:
+ *
+ *   {"benchmark": "a52dec", "case": "threads=1", "element": "a52dec",
+ *    "bytes": ..., "buffers_in": ..., "seconds": ..., "mb_per_s": ...,
+ *    "buffers_out": ..., "bytes_out": ..., "buffers_per_s": ...,
+ *    "allocations": ..., "peak_rss_kb": ..., "stats": {...}}
+ *
+ * mb_per_s is input bytes per second, buffers_per_s output buffers per
+ * second. allocations counts the GstMemory allocated through the default
+ * allocator while the case ran, peak_rss_kb is the peak resident set size
+ * of the process so far. stats holds the integer fields of the "stats"
+ * property of the element at the end of the case, if it has one.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+
+#include <gst/app/gstappsrc.h>
+#include <glib/gstdio.h>
+
+#include <stdio.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+static const gchar *bench_name;
+static guint bench_scale = 1;
+static gboolean bench_failed;
+
+/* Allocator that counts the allocations and hands them to the system
+ * memory allocator, which then also takes care of freeing them */
+typedef struct
+{
+  GstAllocator parent;
+
+  GstAllocator *sysmem;
+} BenchAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} BenchAllocatorClass;
+
+G_DEFINE_TYPE (BenchAllocator, bench_allocator, GST_TYPE_ALLOCATOR);
+
+static gint bench_allocations;
+
+static GstMemory *
+bench_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  BenchAllocator *self = (BenchAllocator *) allocator;
+
+  g_atomic_int_inc (&bench_allocations);
+
+  return gst_allocator_alloc (self->sysmem, size, params);
+}
+
+static void
+bench_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  BenchAllocator *self = (BenchAllocator *) allocator;
+
+  gst_allocator_free (self->sysmem, mem);
+}
+
+static void
+bench_allocator_finalize (GObject * object)
+{
+  BenchAllocator *self = (BenchAllocator *) object;
+
+  gst_object_unref (self->sysmem);
+
+  G_OBJECT_CLASS (bench_allocator_parent_class)->finalize (object);
+}
+
+static void
+bench_allocator_class_init (BenchAllocatorClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  gobject_class->finalize = bench_allocator_finalize;
+  allocator_class->alloc = bench_allocator_alloc;
+  allocator_class->free = bench_allocator_free;
+}
+
+static void
+bench_allocator_init (BenchAllocator * self)
+{
+  GstAllocator *allocator = GST_ALLOCATOR_CAST (self);
+
+  self->sysmem = gst_allocator_find (GST_ALLOCATOR_SYSMEM);
+  allocator->mem_type = GST_ALLOCATOR_SYSMEM;
+}
+
+gboolean
+bench_init (gint * argc, gchar *** argv, const gchar * benchmark)
+{
+  GOptionEntry entries[] = {
+    {"scale", 's', 0, G_OPTION_ARG_INT, &bench_scale,
+        "Multiply the size of the generated streams by SCALE", "SCALE"},
+    {NULL}
+  };
+  GOptionContext *ctx;
+  GError *err = NULL;
+
+  bench_name = benchmark;
+
+  ctx = g_option_context_new (NULL);
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, argc, argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return FALSE;
+  }
+  g_option_context_free (ctx);
+
+  bench_scale = MAX (bench_scale, 1);
+
+  gst_allocator_set_default (g_object_new (bench_allocator_get_type (), NULL));
+
+  return TRUE;
+}
+
+guint
+bench_get_scale (void)
+{
+  return bench_scale;
+}
+
+gboolean
+bench_have_element (const gchar * factory)
+{
+  GstElementFactory *f;
+
+  f = gst_element_factory_find (factory);
+  if (f == NULL) {
+    g_printerr ("%s: element %s not available, skipping\n", bench_name,
+        factory);
+    return FALSE;
+  }
+  gst_object_unref (f);
+
+  return TRUE;
+}
+
+BenchInput *
+bench_input_new (const gchar * caps, GstFormat format)
+{
+  BenchInput *input = g_new0 (BenchInput, 1);
+
+  input->caps = gst_caps_from_string (caps);
+  input->format = format;
+  input->buffers = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_buffer_unref);
+
+  return input;
+}
+
+void
+bench_input_add (BenchInput * input, const guint8 * data, gsize size,
+    GstClockTime pts)
+{
+  GstBuffer *buf;
+
+  buf = gst_buffer_new_wrapped (g_memdup (data, size), size);
+  GST_BUFFER_PTS (buf) = pts;
+  g_ptr_array_add (input->buffers, buf);
+  input->bytes += size;
+}
+
+void
+bench_input_add_chunked (BenchInput * input, const guint8 * data, gsize size,
+    gsize chunk_size)
+{
+  GstBuffer *buf;
+  gsize offset;
+
+  /* one block of memory for the whole stream, and the chunks are
+   * sub-buffers of it like a file source would produce them */
+  buf = gst_buffer_new_wrapped (g_memdup (data, size), size);
+
+  for (offset = 0; offset < size; offset += chunk_size) {
+    g_ptr_array_add (input->buffers, gst_buffer_copy_region (buf,
+            GST_BUFFER_COPY_MEMORY, offset, MIN (chunk_size, size - offset)));
+  }
+  input->bytes += size;
+
+  gst_buffer_unref (buf);
+}
+
+/**
+ * bench_input_new_file:
+ * @data: the whole stream
+ * @size: size of @data
+ *
+ * Writes @data to a temporary file, which is removed again by
+ * bench_input_free(). The file is read with filesrc, so the element can
+ * pull the data.
+ *
+ * Returns: the new input, or %NULL if the file could not be written.
+ */
+BenchInput *
+bench_input_new_file (const guint8 * data, gsize size)
+{
+  BenchInput *input;
+  GError *err = NULL;
+  gchar *location;
+  gint fd;
+
+  fd = g_file_open_tmp ("bench-XXXXXX", &location, &err);
+  if (fd < 0) {
+    g_printerr ("%s: %s\n", bench_name, err->message);
+    g_clear_error (&err);
+    return NULL;
+  }
+  g_close (fd, NULL);
+
+  if (!g_file_set_contents (location, (const gchar *) data, size, &err)) {
+    g_printerr ("%s: %s\n", bench_name, err->message);
+    g_clear_error (&err);
+    g_unlink (location);
+    g_free (location);
+    return NULL;
+  }
+
+  input = g_new0 (BenchInput, 1);
+  input->format = GST_FORMAT_BYTES;
+  input->buffers = g_ptr_array_new ();
+  input->bytes = size;
+  input->location = location;
+
+  return input;
+}
+
+void
+bench_input_free (BenchInput * input)
+{
+  if (input->location != NULL) {
+    g_unlink (input->location);
+    g_free (input->location);
+  }
+  if (input->caps != NULL)
+    gst_caps_unref (input->caps);
+  g_ptr_array_unref (input->buffers);
+  g_free (input);
+}
+
+typedef struct
+{
+  GstElement *pipeline;
+
+  GMutex lock;
+  guint64 buffers;
+  guint64 bytes;
+} BenchRun;
+
+static GstPadProbeReturn
+bench_count_probe (GstPad * pad, GstPadProbeInfo * info, BenchRun * run)
+{
+  guint64 buffers = 0, bytes = 0;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+    buffers = 1;
+    bytes = gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info));
+  } else if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+    guint i;
+
+    buffers = gst_buffer_list_length (list);
+    for (i = 0; i < buffers; i++)
+      bytes += gst_buffer_get_size (gst_buffer_list_get (list, i));
+  }
+
+  g_mutex_lock (&run->lock);
+  run->buffers += buffers;
+  run->bytes += bytes;
+  g_mutex_unlock (&run->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+bench_link_src_pad (GstElement * element, GstPad * pad, BenchRun * run)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  if (GST_PAD_DIRECTION (pad) != GST_PAD_SRC)
+    return;
+
+  /* async=false so that the pipeline does not wait for the pads that a
+   * demuxer only adds once it has seen some data */
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add (GST_BIN (run->pipeline), sink);
+
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) bench_count_probe, run, NULL);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    g_printerr ("%s: could not link pad %s\n", bench_name, GST_PAD_NAME (pad));
+  gst_object_unref (sinkpad);
+
+  gst_element_sync_state_with_parent (sink);
+}
+
+/**
+ * bench_get_rss_kb:
+ *
+ * Returns: the resident set size of the process in kB, or -1 where it is
+ * not known.
+ */
+glong
+bench_get_rss_kb (void)
+{
+#ifdef G_OS_UNIX
+  gchar *contents;
+  gulong size, resident;
+  glong ret = -1;
+
+  /* Linux only, elsewhere we report -1 */
+  if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    return -1;
+  if (sscanf (contents, "%lu %lu", &size, &resident) == 2)
+    ret = resident * (sysconf (_SC_PAGESIZE) / 1024);
+  g_free (contents);
+
+  return ret;
+#else
+  return -1;
+#endif
+}
+
+/**
+ * bench_get_peak_rss_kb:
+ *
+ * Returns: the peak resident set size of the process so far in kB, or -1
+ * where it is not known.
+ */
+glong
+bench_get_peak_rss_kb (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return -1;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+static gboolean
+bench_append_stats_field (GQuark field, const GValue * value, GString * str)
+{
+  if (!G_VALUE_HOLDS_INT (value) && !G_VALUE_HOLDS_UINT (value) &&
+      !G_VALUE_HOLDS_INT64 (value) && !G_VALUE_HOLDS_UINT64 (value))
+    return TRUE;
+
+  if (str->len > 0)
+    g_string_append (str, ", ");
+  g_string_append_printf (str, "\"%s\": ", g_quark_to_string (field));
+  if (G_VALUE_HOLDS_INT (value))
+    g_string_append_printf (str, "%d", g_value_get_int (value));
+  else if (G_VALUE_HOLDS_UINT (value))
+    g_string_append_printf (str, "%u", g_value_get_uint (value));
+  else if (G_VALUE_HOLDS_INT64 (value))
+    g_string_append_printf (str, "%" G_GINT64_FORMAT,
+        g_value_get_int64 (value));
+  else
+    g_string_append_printf (str, "%" G_GUINT64_FORMAT,
+        g_value_get_uint64 (value));
+
+  return TRUE;
+}
+
+/* adds the "stats" member to the report, if @element has the property */
+static void
+bench_report_add_stats (GString * report, GstElement * element)
+{
+  GParamSpec *pspec;
+  GstStructure *stats = NULL;
+  GString *str;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+      "stats");
+  if (pspec == NULL || pspec->value_type != GST_TYPE_STRUCTURE)
+    return;
+
+  g_object_get (element, "stats", &stats, NULL);
+  if (stats == NULL)
+    return;
+
+  str = g_string_new (NULL);
+  gst_structure_foreach (stats,
+      (GstStructureForeachFunc) bench_append_stats_field, str);
+  gst_structure_free (stats);
+
+  bench_report_add (report, "stats", "{%s}", str->str);
+  g_string_free (str, TRUE);
+}
+
+/**
+ * bench_report_new:
+ * @case_name: name of the case
+ * @element: the element that was benchmarked
+ *
+ * Starts the JSON object that reports a case, with the "benchmark", "case"
+ * and "element" members.
+ *
+ * Returns: the report, to add members to with bench_report_add()
+ */
+GString *
+bench_report_new (const gchar * case_name, const gchar * element)
+{
+  GString *report = g_string_new (NULL);
+
+  g_string_append_printf (report, "{\"benchmark\": \"%s\", \"case\": \"%s\", "
+      "\"element\": \"%s\"", bench_name, case_name, element);
+
+  return report;
+}
+
+/**
+ * bench_report_add:
+ * @report: a report
+ * @field: name of the member
+ * @format: printf format of the JSON value
+ * @...: the arguments of @format
+ *
+ * Adds a member to @report.
+ */
+void
+bench_report_add (GString * report, const gchar * field,
+    const gchar * format, ...)
+{
+  va_list args;
+
+  g_string_append_printf (report, ", \"%s\": ", field);
+  va_start (args, format);
+  g_string_append_vprintf (report, format, args);
+  va_end (args);
+}
+
+/**
+ * bench_report_print:
+ * @report: a report
+ *
+ * Prints @report on stdout, on a line of its own, and frees it.
+ */
+void
+bench_report_print (GString * report)
+{
+  g_string_append (report, "}\n");
+  g_print ("%s", report->str);
+  g_string_free (report, TRUE);
+}
+
+/**
+ * bench_run:
+ * @case_name: name of the case in the report
+ * @factory: element to benchmark
+ * @input: buffers to push into the element
+ * @first_property: name of the first element property to set, or %NULL
+ * @...: value of the first property, followed by more name/value pairs,
+ *   terminated by %NULL
+ *
+ * Pushes all of @input through @factory and reports the result on stdout.
+ *
+ * Returns: %TRUE if the element processed the stream without error.
+ */
+gboolean
+bench_run (const gchar * case_name, const gchar * factory, BenchInput * input,
+    const gchar * first_property, ...)
+{
+  GstElement *src, *element;
+  GstMessage *msg;
+  GstBus *bus;
+  GList *pads = NULL, *l;
+  BenchRun run = { NULL, };
+  gint64 start, elapsed;
+  gdouble seconds;
+  gboolean ret = TRUE;
+  guint i;
+  gint allocations;
+
+  run.pipeline = gst_pipeline_new (NULL);
+  g_mutex_init (&run.lock);
+
+  if (input->location != NULL) {
+    src = gst_element_factory_make ("filesrc", NULL);
+    g_object_set (src, "location", input->location, NULL);
+  } else {
+    src = gst_element_factory_make ("appsrc", NULL);
+    /* the queue is unlimited, so pushing never blocks on a pipeline that
+     * stopped with an error */
+    g_object_set (src, "caps", input->caps, "format", input->format,
+        "max-bytes", (guint64) 0, NULL);
+  }
+  element = gst_element_factory_make (factory, NULL);
+  g_assert (src != NULL && element != NULL);
+
+  if (first_property != NULL) {
+    va_list args;
+
+    va_start (args, first_property);
+    g_object_set_valist (G_OBJECT (element), first_property, args);
+    va_end (args);
+  }
+
+  gst_bin_add_many (GST_BIN (run.pipeline), src, element, NULL);
+  if (!gst_element_link (src, element)) {
+    g_printerr ("%s: could not link %s to %s\n", bench_name,
+        GST_ELEMENT_NAME (src), factory);
+    ret = FALSE;
+    goto done;
+  }
+
+  GST_OBJECT_LOCK (element);
+  for (l = element->srcpads; l != NULL; l = l->next)
+    pads = g_list_prepend (pads, gst_object_ref (l->data));
+  GST_OBJECT_UNLOCK (element);
+  for (l = pads; l != NULL; l = l->next)
+    bench_link_src_pad (element, l->data, &run);
+  g_list_free_full (pads, gst_object_unref);
+  g_signal_connect (element, "pad-added", G_CALLBACK (bench_link_src_pad),
+      &run);
+
+  g_atomic_int_set (&bench_allocations, 0);
+  start = g_get_monotonic_time ();
+
+  if (gst_element_set_state (run.pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    g_printerr ("%s: could not start the pipeline\n", bench_name);
+    ret = FALSE;
+    goto done;
+  }
+
+  if (input->location == NULL) {
+    for (i = 0; i < input->buffers->len; i++) {
+      GstBuffer *buf = g_ptr_array_index (input->buffers, i);
+
+      if (gst_app_src_push_buffer (GST_APP_SRC (src),
+              gst_buffer_copy (buf)) != GST_FLOW_OK)
+        break;
+    }
+    gst_app_src_end_of_stream (GST_APP_SRC (src));
+  }
+
+  bus = gst_element_get_bus (run.pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+  allocations = g_atomic_int_get (&bench_allocations);
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    GError *err = NULL;
+    gchar *debug = NULL;
+
+    gst_message_parse_error (msg, &err, &debug);
+    g_printerr ("%s: %s failed: %s\n%s\n", bench_name, case_name,
+        err->message, GST_STR_NULL (debug));
+    g_clear_error (&err);
+    g_free (debug);
+    ret = FALSE;
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  if (ret) {
+    GString *report = bench_report_new (case_name, factory);
+
+    seconds = elapsed / (gdouble) G_USEC_PER_SEC;
+
+    bench_report_add (report, "bytes", "%" G_GUINT64_FORMAT, input->bytes);
+    bench_report_add (report, "buffers_in", "%u", input->buffers->len);
+    bench_report_add (report, "seconds", "%.6f", seconds);
+    bench_report_add (report, "mb_per_s", "%.3f",
+        input->bytes / (1024.0 * 1024.0) / seconds);
+    bench_report_add (report, "buffers_out", "%" G_GUINT64_FORMAT,
+        run.buffers);
+    bench_report_add (report, "bytes_out", "%" G_GUINT64_FORMAT, run.bytes);
+    bench_report_add (report, "buffers_per_s", "%.1f", run.buffers / seconds);
+    bench_report_add (report, "allocations", "%d", allocations);
+    bench_report_add (report, "peak_rss_kb", "%ld", bench_get_peak_rss_kb ());
+    bench_report_add_stats (report, element);
+    bench_report_print (report);
+  }
+
+done:
+  gst_element_set_state (run.pipeline, GST_STATE_NULL);
+  gst_object_unref (run.pipeline);
+  g_mutex_clear (&run.lock);
+
+  if (!ret)
+    bench_failed = TRUE;
+
+  return ret;
+}
+
+gint
+bench_finish (void)
+{
+  return bench_failed ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/* GStreamer
+ *
+ * Common code for the element benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* exit status that makes meson report a benchmark as skipped */
+#define BENCH_EXIT_SKIP 77
+
+typedef struct _BenchInput BenchInput;
+
+/* The input of a benchmark case: caps and the buffers that appsrc pushes.
+ * The buffers are generated once and pushed as shallow copies for every
+ * run, so generating the stream is not part of the measurement. Inputs
+ * with a @location are read from that file by filesrc instead. */
+struct _BenchInput
+{
+  GstCaps *caps;
+  GstFormat format;
+  GPtrArray *buffers;
+  guint64 bytes;
+  gchar *location;
+};
+
+gboolean     bench_init                 (gint * argc, gchar *** argv,
+                                         const gchar * benchmark);
+
+guint        bench_get_scale            (void);
+
+gboolean     bench_have_element         (const gchar * factory);
+
+BenchInput * bench_input_new            (const gchar * caps,
+                                         GstFormat format);
+
+void         bench_input_add            (BenchInput * input,
+                                         const guint8 * data,
+                                         gsize size,
+                                         GstClockTime pts);
+
+void         bench_input_add_chunked    (BenchInput * input,
+                                         const guint8 * data,
+                                         gsize size,
+                                         gsize chunk_size);
+
+BenchInput * bench_input_new_file       (const guint8 * data,
+                                         gsize size);
+
+void         bench_input_free           (BenchInput * input);
+
+gboolean     bench_run                  (const gchar * case_name,
+                                         const gchar * factory,
+                                         BenchInput * input,
+                                         const gchar * first_property,
+                                         ...) G_GNUC_NULL_TERMINATED;
+
+GString *    bench_report_new           (const gchar * case_name,
+                                         const gchar * element);
+
+void         bench_report_add           (GString * report,
+                                         const gchar * field,
+                                         const gchar * format,
+                                         ...) G_GNUC_PRINTF (3, 4);
+
+void         bench_report_print         (GString * report);
+
+glong        bench_get_rss_kb           (void);
+
+glong        bench_get_peak_rss_kb      (void);
+
+gint         bench_finish               (void);
+
+G_END_DECLS
+
+#endif /* __BENCH_COMMON_H__ */
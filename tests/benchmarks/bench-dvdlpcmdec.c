@@ -0,0 +1,122 @@
+/* GStreamer
+ *
+ * Benchmark for dvdlpcmdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+
+#include <string.h>
+
+/* seconds of 48 kHz stereo audio */
+#define DURATION 60
+#define RATE 48000
+#define CHANNELS 2
+
+/* payload of a DVD LPCM packet, a multiple of the sample size for all
+ * widths, and the size of the raw chunks */
+#define PACKET_PAYLOAD 2040
+
+static guint8 *
+make_samples (gsize size)
+{
+  guint8 *data = g_malloc (size);
+  guint32 state = 1;
+  gsize i;
+
+  /* noise, so nothing can take a shortcut on silence */
+  for (i = 0; i < size; i++) {
+    state = state * 1103515245 + 12345;
+    data[i] = state >> 16;
+  }
+
+  return data;
+}
+
+static void
+run_raw (gint width, const guint8 * samples, gsize size)
+{
+  BenchInput *input;
+  gchar *caps, *name;
+
+  caps = g_strdup_printf ("audio/x-lpcm, width=(int)%d, rate=(int)%d, "
+      "channels=(int)%d, dynamic_range=(int)0, emphasis=(boolean)false, "
+      "mute=(boolean)false", width, RATE, CHANNELS);
+  input = bench_input_new (caps, GST_FORMAT_TIME);
+  bench_input_add_chunked (input, samples, size, PACKET_PAYLOAD);
+
+  name = g_strdup_printf ("raw-%d", width);
+  bench_run (name, "dvdlpcmdec", input, NULL);
+
+  g_free (name);
+  g_free (caps);
+  bench_input_free (input);
+}
+
+/* private stream 1 packets as they come out of the MPEG-PS demuxer: the
+ * first access unit pointer and the three byte LPCM header, which here
+ * says 16 bits, 48 kHz, stereo */
+static void
+run_dvd (const guint8 * samples, gsize size)
+{
+  BenchInput *input;
+  guint8 packet[5 + PACKET_PAYLOAD] = { 0x00, 0x04, 0x00, 0x01, 0x80 };
+  gsize offset;
+  guint n = 0;
+
+  input = bench_input_new ("audio/x-private1-lpcm", GST_FORMAT_TIME);
+  for (offset = 0; offset + PACKET_PAYLOAD <= size; offset += PACKET_PAYLOAD) {
+    memcpy (packet + 5, samples + offset, PACKET_PAYLOAD);
+    bench_input_add (input, packet, sizeof (packet),
+        gst_util_uint64_scale (n++, PACKET_PAYLOAD / (2 * CHANNELS) *
+            GST_SECOND, RATE));
+  }
+
+  bench_run ("dvd", "dvdlpcmdec", input, NULL);
+
+  bench_input_free (input);
+}
+
+int
+main (int argc, char **argv)
+{
+  guint8 *samples;
+  gsize size;
+
+  if (!bench_init (&argc, &argv, "dvdlpcmdec"))
+    return 1;
+  if (!bench_have_element ("dvdlpcmdec"))
+    return BENCH_EXIT_SKIP;
+
+  /* the same bytes are decoded as 16, 20 and 24 bit samples */
+  size = DURATION * RATE * CHANNELS * 2 * (gsize) bench_get_scale ();
+  size -= size % PACKET_PAYLOAD;
+  samples = make_samples (size);
+
+  run_raw (16, samples, size);
+  run_raw (20, samples, size);
+  run_raw (24, samples, size);
+  run_dvd (samples, size);
+
+  g_free (samples);
+
+  return bench_finish ();
+}
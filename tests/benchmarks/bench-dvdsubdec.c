@@ -0,0 +1,174 @@
+/* GStreamer
+ *
+ * Benchmark for dvdsubdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+
+/* one subpicture every two seconds, shown for one second */
+#define N_PACKETS 500
+#define PACKET_INTERVAL (2 * GST_SECOND)
+#define SHOW_TICKS 88           /* ticks of 1024/90000 s */
+
+typedef struct
+{
+  GByteArray *data;
+  gboolean half;
+} RleWriter;
+
+static void
+rle_put_nibble (RleWriter * w, guint nibble)
+{
+  if (w->half) {
+    w->data->data[w->data->len - 1] |= nibble;
+  } else {
+    guint8 b = nibble << 4;
+
+    g_byte_array_append (w->data, &b, 1);
+  }
+  w->half = !w->half;
+}
+
+/* runs of 1-3, 4-15, 16-63 and 64-255 pixels take 1, 2, 3 and 4 nibbles,
+ * a length of 0 fills the rest of the line */
+static void
+rle_put_run (RleWriter * w, guint len, guint colour)
+{
+  guint code = (len << 2) | colour;
+  gint n_nibbles;
+
+  if (len == 0 || len >= 64)
+    n_nibbles = 4;
+  else if (len >= 16)
+    n_nibbles = 3;
+  else if (len >= 4)
+    n_nibbles = 2;
+  else
+    n_nibbles = 1;
+
+  while (n_nibbles--)
+    rle_put_nibble (w, (code >> (4 * n_nibbles)) & 0xf);
+}
+
+/* all four run lengths and colours, varying from line to line */
+static void
+rle_put_line (RleWriter * w, guint y, guint width)
+{
+  static const guint runs[] = { 2, 9, 33, 120, 1, 14, 60, 200, 3, 5 };
+  guint x = 0, i = y;
+
+  while (TRUE) {
+    guint len = runs[i % G_N_ELEMENTS (runs)] + (y & 3);
+
+    if (x + len >= width)
+      break;
+    rle_put_run (w, len, i & 3);
+    x += len;
+    i++;
+  }
+  rle_put_run (w, 0, i & 3);
+
+  /* lines start on a byte boundary */
+  if (w->half)
+    rle_put_nibble (w, 0);
+}
+
+static GByteArray *
+make_packet (guint top, guint width, guint height)
+{
+  RleWriter w = { g_byte_array_new (), FALSE };
+  guint8 header[4] = { 0, };
+  guint offsets[2], dcsq[2], y, field;
+  guint right = width - 1, bottom = top + height - 1;
+
+  g_byte_array_append (w.data, header, sizeof (header));
+
+  /* the two interlaced fields */
+  for (field = 0; field < 2; field++) {
+    offsets[field] = w.data->len;
+    for (y = field; y < height; y += 2)
+      rle_put_line (&w, y, width);
+  }
+
+  /* show at once with palette, alpha, size and field offsets */
+  dcsq[0] = w.data->len;
+  dcsq[1] = dcsq[0] + 4 + 3 + 3 + 7 + 5 + 1 + 1;
+  {
+    guint8 cmds[] = {
+      0x00, 0x00, dcsq[1] >> 8, dcsq[1] & 0xff,
+      0x03, 0x32, 0x10,
+      0x04, 0xff, 0xf0,
+      0x05, 0x00, right >> 8, right & 0xff,
+      top >> 4, ((top & 0xf) << 4) | (bottom >> 8), bottom & 0xff,
+      0x06, offsets[0] >> 8, offsets[0] & 0xff, offsets[1] >> 8,
+      offsets[1] & 0xff,
+      0x01,
+      0xff,
+      /* hide after a while, last sequence points to itself */
+      SHOW_TICKS >> 8, SHOW_TICKS & 0xff, dcsq[1] >> 8, dcsq[1] & 0xff,
+      0x02,
+      0xff
+    };
+
+    g_byte_array_append (w.data, cmds, sizeof (cmds));
+  }
+
+  GST_WRITE_UINT16_BE (w.data->data, w.data->len);
+  GST_WRITE_UINT16_BE (w.data->data + 2, dcsq[0]);
+
+  return w.data;
+}
+
+static void
+run_case (const gchar * name, guint top, guint height)
+{
+  BenchInput *input;
+  GByteArray *packet;
+  guint i, n_packets;
+
+  packet = make_packet (top, 720, height);
+
+  input = bench_input_new ("subpicture/x-dvd", GST_FORMAT_TIME);
+  n_packets = N_PACKETS * bench_get_scale ();
+  for (i = 0; i < n_packets; i++)
+    bench_input_add (input, packet->data, packet->len, i * PACKET_INTERVAL);
+  g_byte_array_unref (packet);
+
+  bench_run (name, "dvdsubdec", input, NULL);
+
+  bench_input_free (input);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (!bench_init (&argc, &argv, "dvdsubdec"))
+    return 1;
+  if (!bench_have_element ("dvdsubdec"))
+    return BENCH_EXIT_SKIP;
+
+  /* two lines of text at the bottom, and a full screen menu */
+  run_case ("720x96", 464, 96);
+  run_case ("720x576", 0, 576);
+
+  return bench_finish ();
+}
@@ -0,0 +1,128 @@
+/* GStreamer
+ *
+ * Benchmark for mpeg2dec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+
+/* The pictures are the ones of the 176x144 blue stream in the mpeg2dec unit
+ * test, repeated as GOPs of one I and eleven P pictures at 25 fps */
+#define GOP_LENGTH 12
+#define N_GOPS 250
+#define N_SLICES 9
+
+static const guint8 sequence_header[] = {
+  0x00, 0x00, 0x01, 0xb3, 0x0b, 0x00, 0x90, 0x13,
+  0xff, 0xff, 0xe0, 0x28, 0x00, 0x00, 0x01, 0xb5,
+  0x14, 0x8a, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+  0x01, 0xb8, 0x00, 0x08, 0x00, 0x00
+};
+
+static const guint8 i_picture_header[] = {
+  0x00, 0x00, 0x01, 0x00, 0x00, 0x0f, 0xff, 0xf8,
+  0x00, 0x00, 0x01, 0xb5, 0x8f, 0xff, 0xf3, 0x41,
+  0x80
+};
+
+static const guint8 i_slice[] = {
+  0x13, 0xf8, 0xe5, 0x29, 0x4b, 0xf7, 0xfb, 0xca,
+  0xb9, 0x4a, 0x52, 0x22, 0xe5, 0x29, 0x48, 0x8b,
+  0x94, 0xa5, 0x22, 0x2e, 0x52, 0x94, 0x88, 0xb9,
+  0x4a, 0x52, 0x22, 0xe5, 0x29, 0x48, 0x8b, 0x94,
+  0xa5, 0x22, 0x2e, 0x52, 0x94, 0x88, 0xb9, 0x4a,
+  0x52, 0x22, 0xe5, 0x29, 0x48, 0x88
+};
+
+static const guint8 p_picture_extension[] = {
+  0x00, 0x00, 0x01, 0xb5, 0x81, 0x1f, 0xf3, 0x41,
+  0x80
+};
+
+static const guint8 p_slice[] = { 0x12, 0x70, 0xb3, 0x80 };
+
+static void
+add_slices (GByteArray * picture, const guint8 * slice, guint size)
+{
+  guint8 start_code[4] = { 0x00, 0x00, 0x01, 0x00 };
+  guint i;
+
+  for (i = 1; i <= N_SLICES; i++) {
+    start_code[3] = i;
+    g_byte_array_append (picture, start_code, sizeof (start_code));
+    g_byte_array_append (picture, slice, size);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  BenchInput *input;
+  GByteArray *picture;
+  guint gop, i, n_gops, frame = 0;
+
+  if (!bench_init (&argc, &argv, "mpeg2dec"))
+    return 1;
+  if (!bench_have_element ("mpeg2dec"))
+    return BENCH_EXIT_SKIP;
+
+  input = bench_input_new ("video/mpeg, mpegversion=(int)2, "
+      "systemstream=(boolean)false", GST_FORMAT_TIME);
+
+  /* the decoder is packetized, so push one picture per buffer */
+  n_gops = N_GOPS * bench_get_scale ();
+  picture = g_byte_array_new ();
+  for (gop = 0; gop < n_gops; gop++) {
+    for (i = 0; i < GOP_LENGTH; i++) {
+      g_byte_array_set_size (picture, 0);
+
+      if (i == 0) {
+        g_byte_array_append (picture, sequence_header,
+            sizeof (sequence_header));
+        g_byte_array_append (picture, i_picture_header,
+            sizeof (i_picture_header));
+        add_slices (picture, i_slice, sizeof (i_slice));
+      } else {
+        guint8 header[9] = { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xff, 0xfb,
+          0x80
+        };
+
+        /* temporal reference and P picture coding type */
+        header[4] = i >> 2;
+        header[5] = ((i & 3) << 6) | 0x17;
+        g_byte_array_append (picture, header, sizeof (header));
+        g_byte_array_append (picture, p_picture_extension,
+            sizeof (p_picture_extension));
+        add_slices (picture, p_slice, sizeof (p_slice));
+      }
+
+      bench_input_add (input, picture->data, picture->len,
+          gst_util_uint64_scale (frame++, GST_SECOND, 25));
+    }
+  }
+  g_byte_array_unref (picture);
+
+  bench_run ("176x144", "mpeg2dec", input, NULL);
+
+  bench_input_free (input);
+
+  return bench_finish ();
+}
@@ -0,0 +1,99 @@
+/* GStreamer
+ *
+ * Benchmark for rademux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+#include "mediagen.h"
+
+#define N_PACKETS 20000
+
+/* A RealAudio 4 file of whole interleaving blocks, rademux pushes the
+ * packets one by one */
+static GByteArray *
+make_file (const gchar * fourcc)
+{
+  GByteArray *file;
+  MediaGenRm gen;
+
+  media_gen_rm_init (&gen, fourcc);
+  gen.n_blocks = N_PACKETS * bench_get_scale () / gen.height;
+
+  file = g_byte_array_new ();
+  if (!media_gen_ra_write (&gen, media_gen_write_byte_array, file))
+    g_error ("could not generate %s stream", fourcc);
+
+  return file;
+}
+
+static void
+run_case (const gchar * name, const gchar * fourcc, gsize chunk_size)
+{
+  BenchInput *input;
+  GByteArray *file;
+
+  file = make_file (fourcc);
+
+  input = bench_input_new ("application/x-pn-realaudio", GST_FORMAT_BYTES);
+  bench_input_add_chunked (input, file->data, file->len, chunk_size);
+  g_byte_array_unref (file);
+
+  bench_run (name, "rademux", input, NULL);
+
+  bench_input_free (input);
+}
+
+/* the same file read by filesrc, so that rademux pulls it in large blocks */
+static void
+run_pull_case (const gchar * name, const gchar * fourcc)
+{
+  BenchInput *input;
+  GByteArray *file;
+
+  file = make_file (fourcc);
+  input = bench_input_new_file (file->data, file->len);
+  g_byte_array_unref (file);
+  if (input == NULL)
+    return;
+
+  bench_run (name, "rademux", input, NULL);
+
+  bench_input_free (input);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (!bench_init (&argc, &argv, "rademux"))
+    return 1;
+  if (!bench_have_element ("rademux"))
+    return BENCH_EXIT_SKIP;
+
+  /* dnet packets are byte-swapped, sipr ones passed on as they are */
+  run_case ("dnet", "dnet", 4096);
+  run_case ("dnet-64k", "dnet", 65536);
+  run_case ("sipr", "sipr", 4096);
+  run_pull_case ("dnet-pull", "dnet");
+  run_pull_case ("sipr-pull", "sipr");
+
+  return bench_finish ();
+}
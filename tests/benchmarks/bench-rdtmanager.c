@@ -0,0 +1,494 @@
+/* GStreamer
+ *
+ * Soak benchmark for rdtmanager with many concurrent sessions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Unlike the other benchmarks this one does not push a stream as fast as
+ * possible. Every case runs N sessions through one rdtmanager in real time,
+ * each one receiving a PACKET_SIZE byte packet every PACKET_DURATION ms from
+ * a synthetic server, for RUN_TIME seconds times --scale:
+ *
+ *   generator -> recv_rtp_sink_%u  rdtmanager  recv_rtp_src_%u_0_0 -> sink
+ *
+ * The generator runs in the main thread and can lose, reorder and duplicate
+ * packets and give every server clock a skew. The report has the CPU time
+ * of the process as a percentage of one core, also per session, the
+ * latency of the packets from the generator to the sink, which is the time
+ * they spend in the jitterbuffer and the loop of the session, the growth of
+ * the resident set per session and the totals of the session statistics.
+ *
+ *   {"benchmark": "rdtmanager", "case": "sessions=1000", "sessions": 1000,
+ *    "seconds": ..., "packets_in": ..., "packets_out": ...,
+ *    "cpu_percent": ..., "cpu_percent_per_session": ...,
+ *    "latency_p50_us": ..., "latency_p99_us": ..., "latency_max_us": ...,
+ *    "rss_kb_per_session": ..., "ticks_late": ..., "packets_lost": ...,
+ *    "packets_late": ..., "packets_duplicate": ..., "peak_rss_kb": ...}
+ *
+ * ticks_late counts the packet intervals the generator started late, when
+ * it is not much below the number of intervals the process is saturated and
+ * the numbers are not meaningful anymore. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+#include "gstrdtbuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#define PACKET_SIZE 200
+#define PACKET_DURATION 20      /* ms */
+#define RUN_TIME 4              /* s */
+/* for looking up the send time of a packet in the sink */
+#define SEQ_RING 1024
+
+/* the latency histogram, 10 us buckets up to 2 seconds */
+#define BUCKET_US 10
+#define N_BUCKETS 200000
+
+/* what happens to the packets of a session, the probabilities are in per
+ * mille and the server clock skew in ppm, each session picks its own in
+ * +/- max_skew */
+typedef struct
+{
+  guint loss;
+  guint reorder;
+  guint duplicate;
+  gint max_skew;
+} Impairments;
+
+typedef struct
+{
+  guint id;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+
+  /* the generator */
+  GRand *rand;
+  gint skew;
+  guint16 seq;
+  guint64 n_packets;
+  GstBuffer *held;
+  guint64 sent;
+
+  /* the monotonic time each sequence number was pushed */
+  gint64 send_time[SEQ_RING];
+  /* written by the loop of the session only */
+  guint64 received;
+} RdtSession;
+
+static gint latency_histogram[N_BUCKETS];
+static gboolean failed;
+
+/* user and system time of the process in microseconds */
+static gint64
+get_cpu_time (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+  return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+      G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+  return 0;
+#endif
+}
+
+static gboolean
+roll (RdtSession * session, guint per_mille)
+{
+  return per_mille > 0 && g_rand_int_range (session->rand, 0, 1000) <
+      per_mille;
+}
+
+/* the next data packet of the server for stream 0, with the length included
+ * and the timestamp in ms of the skewed server clock. The payload is
+ * zeroed. */
+static GstBuffer *
+make_packet (RdtSession * session)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint32 timestamp;
+
+  timestamp = gst_util_uint64_scale (session->n_packets * PACKET_DURATION,
+      1000000 + session->skew, 1000000);
+
+  buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  /* length_included_flag, stream id 0 */
+  map.data[0] = 0x80;
+  GST_WRITE_UINT16_BE (&map.data[1], session->seq);
+  GST_WRITE_UINT16_BE (&map.data[3], PACKET_SIZE);
+  GST_WRITE_UINT32_BE (&map.data[6], timestamp);
+  gst_buffer_unmap (buf, &map);
+
+  session->seq = (session->seq + 1) % 0xff00;
+  session->n_packets++;
+
+  return buf;
+}
+
+static void
+push_packet (RdtSession * session, GstBuffer * buf, GstClockTime running_time)
+{
+  GstRDTPacket packet;
+
+  gst_rdt_buffer_get_first_packet (buf, &packet);
+  session->send_time[gst_rdt_packet_data_get_seq (&packet) % SEQ_RING] =
+      g_get_monotonic_time ();
+  gst_rdt_packet_unmap (&packet);
+
+  GST_BUFFER_PTS (buf) = running_time;
+  if (gst_pad_push (session->srcpad, buf) != GST_FLOW_OK)
+    failed = TRUE;
+  session->sent++;
+}
+
+/* sends what the server sends in the next packet interval */
+static void
+send_packets (RdtSession * session, const Impairments * imp,
+    GstClockTime running_time)
+{
+  GstBuffer *buf, *held;
+
+  buf = make_packet (session);
+  held = session->held;
+  session->held = NULL;
+
+  if (roll (session, imp->loss)) {
+    gst_buffer_unref (buf);
+  } else if (held == NULL && roll (session, imp->reorder)) {
+    /* goes out after the next one */
+    session->held = buf;
+  } else {
+    if (roll (session, imp->duplicate))
+      push_packet (session, gst_buffer_ref (buf), running_time);
+    push_packet (session, buf, running_time);
+  }
+
+  if (held)
+    push_packet (session, held, running_time);
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  RdtSession *session = gst_pad_get_element_private (pad);
+  GstRDTPacket packet;
+  gint64 latency;
+
+  if (gst_rdt_buffer_get_first_packet (buf, &packet)) {
+    latency = g_get_monotonic_time () -
+        session->send_time[gst_rdt_packet_data_get_seq (&packet) % SEQ_RING];
+    g_atomic_int_inc (&latency_histogram[CLAMP (latency / BUCKET_US, 0,
+                N_BUCKETS - 1)]);
+    gst_rdt_packet_unmap (&packet);
+  }
+  session->received++;
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static GstCaps *
+request_pt_map (GstElement * manager, guint session, guint pt,
+    gpointer user_data)
+{
+  return gst_caps_from_string ("application/x-rdt, clock-rate=(int)1000");
+}
+
+static void
+pad_added (GstElement * manager, GstPad * pad, RdtSession * sessions)
+{
+  guint id, ssrc, pt;
+
+  if (sscanf (GST_PAD_NAME (pad), "recv_rtp_src_%u_%u_%u", &id, &ssrc,
+          &pt) != 3)
+    return;
+
+  if (gst_pad_link (pad, sessions[id].sinkpad) != GST_PAD_LINK_OK)
+    failed = TRUE;
+}
+
+static void
+setup_session (RdtSession * session, guint id, GstElement * manager,
+    const Impairments * imp)
+{
+  GstPad *sinkpad;
+  gchar *name;
+
+  session->id = id;
+  session->rand = g_rand_new_with_seed (id);
+  if (imp->max_skew > 0)
+    session->skew = g_rand_int_range (session->rand, -imp->max_skew,
+        imp->max_skew + 1);
+
+  session->srcpad = gst_pad_new (NULL, GST_PAD_SRC);
+  name = g_strdup_printf ("recv_rtp_sink_%u", id);
+  sinkpad = gst_element_get_request_pad (manager, name);
+  g_free (name);
+  if (sinkpad == NULL || gst_pad_link (session->srcpad,
+          sinkpad) != GST_PAD_LINK_OK)
+    g_error ("could not link session %u", id);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (session->srcpad, TRUE);
+
+  session->sinkpad = gst_pad_new (NULL, GST_PAD_SINK);
+  gst_pad_set_element_private (session->sinkpad, session);
+  gst_pad_set_chain_function (session->sinkpad, sink_chain);
+  gst_pad_set_active (session->sinkpad, TRUE);
+}
+
+static void
+start_session (RdtSession * session)
+{
+  GstSegment segment;
+  GstCaps *caps;
+  gchar *stream_id;
+
+  stream_id = g_strdup_printf ("rdt-%u", session->id);
+  gst_pad_push_event (session->srcpad, gst_event_new_stream_start (stream_id));
+  g_free (stream_id);
+
+  caps = gst_caps_from_string ("application/x-rdt, clock-rate=(int)1000");
+  gst_pad_push_event (session->srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (session->srcpad, gst_event_new_segment (&segment));
+}
+
+static void
+free_session (RdtSession * session)
+{
+  gst_buffer_replace (&session->held, NULL);
+  gst_pad_set_active (session->srcpad, FALSE);
+  gst_object_unref (session->srcpad);
+  gst_pad_set_active (session->sinkpad, FALSE);
+  gst_object_unref (session->sinkpad);
+  g_rand_free (session->rand);
+}
+
+/* the sum of @field over the session statistics */
+static guint64
+sum_stats (const GstStructure * stats, const gchar * field)
+{
+  const GValue *sessions;
+  guint64 val, sum = 0;
+  guint i;
+
+  sessions = gst_structure_get_value (stats, "sessions");
+  for (i = 0; i < gst_value_array_get_size (sessions); i++) {
+    const GstStructure *s =
+        gst_value_get_structure (gst_value_array_get_value (sessions, i));
+
+    if (gst_structure_get_uint64 (s, field, &val))
+      sum += val;
+  }
+
+  return sum;
+}
+
+/* the latency below which @percent of the packets got through */
+static guint64
+get_latency_percentile (guint percent)
+{
+  guint64 total = 0, count = 0, target;
+  guint i;
+
+  for (i = 0; i < N_BUCKETS; i++)
+    total += g_atomic_int_get (&latency_histogram[i]);
+  if (total == 0)
+    return 0;
+
+  target = (total * percent + 99) / 100;
+  for (i = 0; i < N_BUCKETS; i++) {
+    count += g_atomic_int_get (&latency_histogram[i]);
+    if (count >= target)
+      break;
+  }
+
+  return (guint64) (i + 1) * BUCKET_US;
+}
+
+static void
+run_case (const gchar * name, guint n_sessions, const Impairments * imp,
+    guint latency)
+{
+  GstElement *pipeline, *manager;
+  GstStructure *stats;
+  GstClock *clock;
+  GstClockTime base_time;
+  RdtSession *sessions;
+  GstMessage *msg;
+  GstBus *bus;
+  GString *report;
+  glong rss_before, rss_after;
+  gint64 start, elapsed, cpu_start, cpu;
+  guint64 sent = 0, received = 0;
+  guint n_ticks, ticks_late = 0, i, tick;
+  gdouble seconds, cpu_percent;
+
+  memset (latency_histogram, 0, sizeof (latency_histogram));
+  rss_before = bench_get_rss_kb ();
+
+  pipeline = gst_pipeline_new (NULL);
+  manager = gst_element_factory_make ("rdtmanager", NULL);
+  g_object_set (manager, "latency", latency, NULL);
+  gst_bin_add (GST_BIN (pipeline), manager);
+
+  sessions = g_new0 (RdtSession, n_sessions);
+  g_signal_connect (manager, "request-pt-map", G_CALLBACK (request_pt_map),
+      NULL);
+  g_signal_connect (manager, "pad-added", G_CALLBACK (pad_added), sessions);
+  for (i = 0; i < n_sessions; i++)
+    setup_session (&sessions[i], i, manager, imp);
+
+  if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    g_error ("could not start the pipeline");
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  clock = gst_pipeline_get_clock (GST_PIPELINE (pipeline));
+  base_time = gst_element_get_base_time (pipeline);
+
+  for (i = 0; i < n_sessions; i++)
+    start_session (&sessions[i]);
+
+  n_ticks = RUN_TIME * bench_get_scale () * 1000 / PACKET_DURATION;
+
+  start = g_get_monotonic_time ();
+  cpu_start = get_cpu_time ();
+
+  for (tick = 0; tick < n_ticks; tick++) {
+    GstClockID id;
+    GstClockTime now;
+
+    id = gst_clock_new_single_shot_id (clock, base_time +
+        tick * PACKET_DURATION * GST_MSECOND);
+    if (gst_clock_id_wait (id, NULL) == GST_CLOCK_EARLY && tick > 0)
+      ticks_late++;
+    gst_clock_id_unref (id);
+
+    now = gst_clock_get_time (clock) - base_time;
+    for (i = 0; i < n_sessions; i++)
+      send_packets (&sessions[i], imp, now);
+  }
+
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+  cpu = get_cpu_time () - cpu_start;
+  rss_after = bench_get_rss_kb ();
+
+  /* let the packets still in the jitterbuffers out */
+  g_usleep ((latency + 100) * 1000);
+
+  g_object_get (manager, "stats", &stats, NULL);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  if (msg) {
+    GError *err = NULL;
+
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("rdtmanager: %s failed: %s\n", name, err->message);
+    g_clear_error (&err);
+    gst_message_unref (msg);
+    failed = TRUE;
+  }
+  gst_object_unref (bus);
+
+  for (i = 0; i < n_sessions; i++) {
+    sent += sessions[i].sent;
+    received += sessions[i].received;
+  }
+
+  seconds = elapsed / (gdouble) G_USEC_PER_SEC;
+  cpu_percent = 100.0 * cpu / elapsed;
+
+  report = bench_report_new (name, "rdtmanager");
+  bench_report_add (report, "sessions", "%u", n_sessions);
+  bench_report_add (report, "seconds", "%.6f", seconds);
+  bench_report_add (report, "packets_in", "%" G_GUINT64_FORMAT, sent);
+  bench_report_add (report, "packets_out", "%" G_GUINT64_FORMAT, received);
+  bench_report_add (report, "cpu_percent", "%.2f", cpu_percent);
+  bench_report_add (report, "cpu_percent_per_session", "%.4f",
+      cpu_percent / n_sessions);
+  bench_report_add (report, "latency_p50_us", "%" G_GUINT64_FORMAT,
+      get_latency_percentile (50));
+  bench_report_add (report, "latency_p99_us", "%" G_GUINT64_FORMAT,
+      get_latency_percentile (99));
+  bench_report_add (report, "latency_max_us", "%" G_GUINT64_FORMAT,
+      get_latency_percentile (100));
+  bench_report_add (report, "rss_kb_per_session", "%.1f",
+      rss_before >= 0 && rss_after >= 0 ?
+      (rss_after - rss_before) / (gdouble) n_sessions : -1.0);
+  bench_report_add (report, "ticks_late", "%u", ticks_late);
+  bench_report_add (report, "packets_lost", "%" G_GUINT64_FORMAT,
+      sum_stats (stats, "packets-lost"));
+  bench_report_add (report, "packets_late", "%" G_GUINT64_FORMAT,
+      sum_stats (stats, "packets-late"));
+  bench_report_add (report, "packets_duplicate", "%" G_GUINT64_FORMAT,
+      sum_stats (stats, "packets-duplicate"));
+  bench_report_add (report, "peak_rss_kb", "%ld", bench_get_peak_rss_kb ());
+  bench_report_print (report);
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  for (i = 0; i < n_sessions; i++)
+    free_session (&sessions[i]);
+  g_free (sessions);
+  gst_object_unref (clock);
+  gst_object_unref (pipeline);
+}
+
+int
+main (int argc, char **argv)
+{
+  /* a clean network */
+  static const Impairments clean = { 0, 0, 0, 0 };
+  /* 1% loss, 1% reordering, 0.5% duplicates and up to 200 ppm skew */
+  static const Impairments lossy = { 10, 10, 5, 200 };
+
+  if (!bench_init (&argc, &argv, "rdtmanager"))
+    return 1;
+  if (!bench_have_element ("rdtmanager"))
+    return BENCH_EXIT_SKIP;
+
+  /* the cost of the sessions and their loops, without waiting */
+  run_case ("sessions=1", 1, &lossy, 0);
+  run_case ("sessions=10", 10, &lossy, 0);
+  run_case ("sessions=100", 100, &lossy, 0);
+  run_case ("sessions=1000", 1000, &lossy, 0);
+  run_case ("sessions=1000-clean", 1000, &clean, 0);
+
+  /* reordered packets are waited for, the latency adds to every packet */
+  run_case ("sessions=1000-latency=100", 1000, &lossy, 100);
+
+  return failed ? 1 : bench_finish ();
+}
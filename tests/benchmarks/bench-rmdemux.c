@@ -0,0 +1,110 @@
+/* GStreamer
+ *
+ * Benchmark for rmdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+#include "mediagen.h"
+
+#define N_PACKETS 20000
+
+static void
+run_case (const gchar * fourcc, gboolean index)
+{
+  BenchInput *input;
+  GByteArray *file;
+  MediaGenRm gen;
+  gchar *name;
+
+  media_gen_rm_init (&gen, fourcc);
+  /* whole interleaving blocks */
+  gen.n_blocks = N_PACKETS * bench_get_scale () / gen.height;
+  gen.index = index;
+
+  file = g_byte_array_new ();
+  if (!media_gen_rm_write (&gen, media_gen_write_byte_array, file))
+    g_error ("could not generate %s stream", fourcc);
+
+  input = bench_input_new ("application/vnd.rn-realmedia", GST_FORMAT_BYTES);
+  bench_input_add_chunked (input, file->data, file->len, 4096);
+  g_byte_array_unref (file);
+
+  name = g_strconcat (fourcc, index ? "-index" : NULL, NULL);
+  bench_run (name, "rmdemux", input, NULL);
+  g_free (name);
+
+  bench_input_free (input);
+}
+
+/* RealVideo frames of 11200 bytes in @n_fragments fragments. The stats of
+ * the report give the bytes copied, buffers_out the number of frames. */
+static void
+run_video_case (const gchar * fourcc, guint n_fragments)
+{
+  BenchInput *input;
+  GByteArray *file;
+  MediaGenRm gen;
+  gchar *name;
+
+  media_gen_rm_init (&gen, fourcc);
+  gen.packet_size = gen.height * gen.packet_size / n_fragments;
+  gen.height = n_fragments;
+  gen.n_blocks = N_PACKETS * bench_get_scale () / 8;
+
+  file = g_byte_array_new ();
+  if (!media_gen_rm_write (&gen, media_gen_write_byte_array, file))
+    g_error ("could not generate %s stream", fourcc);
+
+  input = bench_input_new ("application/vnd.rn-realmedia", GST_FORMAT_BYTES);
+  bench_input_add_chunked (input, file->data, file->len, 4096);
+  g_byte_array_unref (file);
+
+  name = g_strdup_printf ("%s-fragments=%u", fourcc, n_fragments);
+  bench_run (name, "rmdemux", input, NULL);
+  g_free (name);
+
+  bench_input_free (input);
+}
+
+int
+main (int argc, char **argv)
+{
+  if (!bench_init (&argc, &argv, "rmdemux"))
+    return 1;
+  if (!bench_have_element ("rmdemux"))
+    return BENCH_EXIT_SKIP;
+
+  /* byte-swapping, leaf interleaving and nibble swapping */
+  run_case ("dnet", FALSE);
+  run_case ("cook", FALSE);
+  run_case ("atrc", FALSE);
+  run_case ("sipr", FALSE);
+  run_case ("cook", TRUE);
+
+  /* frame reassembly, with more fragments than a buffer holds memories */
+  run_video_case ("RV30", 8);
+  run_video_case ("RV40", 1);
+  run_video_case ("RV40", 8);
+  run_video_case ("RV40", 32);
+
+  return bench_finish ();
+}
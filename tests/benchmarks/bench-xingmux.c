@@ -0,0 +1,72 @@
+/* GStreamer
+ *
+ * Benchmark for xingmux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "bench-common.h"
+
+#include <string.h>
+
+/* MPEG-1 layer 3, 128 kbit/s, 44.1 kHz, joint stereo, no padding */
+#define FRAME_SIZE 417
+#define N_FRAMES 20000
+
+int
+main (int argc, char **argv)
+{
+  static const guint8 header[] = { 0xff, 0xfb, 0x90, 0x64 };
+  BenchInput *frames, *chunks;
+  guint8 *stream;
+  guint i, n_frames;
+
+  if (!bench_init (&argc, &argv, "xingmux"))
+    return 1;
+  if (!bench_have_element ("xingmux"))
+    return BENCH_EXIT_SKIP;
+
+  /* xingmux only looks at the frame headers, the payload can be silence */
+  n_frames = N_FRAMES * bench_get_scale ();
+  stream = g_malloc0 (n_frames * FRAME_SIZE);
+  for (i = 0; i < n_frames; i++)
+    memcpy (stream + i * FRAME_SIZE, header, sizeof (header));
+
+  /* one frame per buffer as from a parser, and unaligned chunks */
+  frames = bench_input_new ("audio/mpeg, mpegversion=(int)1, layer=(int)3, "
+      "rate=(int)44100, channels=(int)2", GST_FORMAT_TIME);
+  for (i = 0; i < n_frames; i++) {
+    bench_input_add (frames, stream + i * FRAME_SIZE, FRAME_SIZE,
+        gst_util_uint64_scale (i, 1152 * GST_SECOND, 44100));
+  }
+
+  chunks = bench_input_new ("audio/mpeg, mpegversion=(int)1, layer=(int)3, "
+      "rate=(int)44100, channels=(int)2", GST_FORMAT_TIME);
+  bench_input_add_chunked (chunks, stream, n_frames * FRAME_SIZE, 4096);
+  g_free (stream);
+
+  bench_run ("frames", "xingmux", frames, NULL);
+  bench_run ("chunks", "xingmux", chunks, NULL);
+
+  bench_input_free (frames);
+  bench_input_free (chunks);
+
+  return bench_finish ();
+}
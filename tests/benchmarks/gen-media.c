@@ -0,0 +1,148 @@
+/* GStreamer
+ *
+ * Writes synthetic ASF and RealMedia files of any size
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* gen-media asf --size 4096 --span 4 --index big.asf
+ * gen-media rm --codec sipr --index big.rm
+ * gen-media rm --codec RV40 video.rm */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mediagen.h"
+
+#include <string.h>
+
+/* the scrambling of --span, rows of 1024 bytes in chunks of 128 bytes */
+#define DS_PACKET_SIZE 1024
+#define DS_CHUNK_SIZE 128
+
+static gint64 size_mb = 10;
+static gint packet_size = 8192;
+static gboolean multiple_payloads = FALSE;
+static gboolean add_index = FALSE;
+static gboolean ext_stream_props = FALSE;
+static gint preroll = 0;
+static gboolean broadcast = FALSE;
+static gint span = 0;
+static gchar *codec = NULL;
+
+static GOptionEntry entries[] = {
+  {"size", 's', 0, G_OPTION_ARG_INT64, &size_mb,
+      "Approximate size of the file in MB (default: 10)", "MB"},
+  {"packet-size", 'p', 0, G_OPTION_ARG_INT, &packet_size,
+      "ASF packet size (default: 8192)", "BYTES"},
+  {"multiple-payloads", 'm', 0, G_OPTION_ARG_NONE, &multiple_payloads,
+      "Put as many ASF payloads into a packet as fit", NULL},
+  {"index", 'i', 0, G_OPTION_ARG_NONE, &add_index,
+      "Add a simple index or an INDX chunk", NULL},
+  {"ext-stream-props", 'e', 0, G_OPTION_ARG_NONE, &ext_stream_props,
+      "Add extended ASF stream properties", NULL},
+  {"preroll", 0, 0, G_OPTION_ARG_INT, &preroll,
+      "ASF preroll (default: 0)", "MS"},
+  {"broadcast", 'b', 0, G_OPTION_ARG_NONE, &broadcast,
+      "Write an ASF broadcast stream, without duration", NULL},
+  {"span", 0, 0, G_OPTION_ARG_INT, &span,
+      "Scramble the ASF audio with this span", "N"},
+  {"codec", 'c', 0, G_OPTION_ARG_STRING, &codec,
+      "RealMedia codec: dnet, cook, atrc, sipr, RV30 or RV40 (default: cook)",
+      "FOURCC"},
+  {NULL}
+};
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  guint64 size;
+  gboolean ret;
+  FILE *file;
+
+  ctx = g_option_context_new ("asf|rm OUTPUT - write a synthetic media file");
+  g_option_context_add_main_entries (ctx, entries, NULL);
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (argc != 3 || size_mb <= 0) {
+    g_printerr ("Usage: %s [OPTION...] asf|rm OUTPUT\n", argv[0]);
+    return 1;
+  }
+  size = (guint64) size_mb * 1024 * 1024;
+
+  file = fopen (argv[2], "wb");
+  if (file == NULL) {
+    g_printerr ("Could not open %s for writing\n", argv[2]);
+    return 1;
+  }
+
+  if (!strcmp (argv[1], "asf")) {
+    MediaGenAsf gen;
+
+    media_gen_asf_init (&gen);
+    gen.packet_size = packet_size;
+    gen.multiple_payloads = multiple_payloads;
+    gen.simple_index = add_index;
+    gen.ext_stream_props = ext_stream_props;
+    gen.preroll = MAX (preroll, 0);
+    gen.broadcast = broadcast;
+    if (span > 1) {
+      gen.span = span;
+      gen.ds_packet_size = DS_PACKET_SIZE;
+      gen.ds_chunk_size = DS_CHUNK_SIZE;
+      gen.object_size = DS_PACKET_SIZE * span;
+    }
+    gen.n_objects = MAX (size / gen.object_size, 1);
+
+    ret = media_gen_asf_write (&gen, media_gen_write_file, file);
+  } else if (!strcmp (argv[1], "rm")) {
+    MediaGenRm gen;
+
+    if (!media_gen_rm_init (&gen, codec ? codec : "cook")) {
+      g_printerr ("Unknown codec %s\n", codec);
+      fclose (file);
+      return 1;
+    }
+    gen.index = add_index;
+    gen.n_blocks = MAX (size / (gen.height * gen.packet_size), 1);
+
+    ret = media_gen_rm_write (&gen, media_gen_write_file, file);
+  } else {
+    g_printerr ("Unknown format %s\n", argv[1]);
+    fclose (file);
+    return 1;
+  }
+
+  if (fclose (file) != 0)
+    ret = FALSE;
+  if (!ret) {
+    g_printerr ("Could not write %s\n", argv[2]);
+    return 1;
+  }
+
+  g_free (codec);
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* GStreamer
+ *
+ * Synthetic AC-3 frames for the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mediagen.h"
+
+#include <string.h>
+
+typedef struct
+{
+  guint8 *data;
+  guint pos;
+} BitWriter;
+
+static void
+put_bits (BitWriter * bw, guint value, guint n_bits)
+{
+  while (n_bits--) {
+    if ((value >> n_bits) & 1)
+      bw->data[bw->pos >> 3] |= 0x80 >> (bw->pos & 7);
+    bw->pos++;
+  }
+}
+
+/* A frame of silence that still goes through the whole decoding: block 0
+ * sends exponents and bit allocation parameters, the other blocks reuse
+ * them. With zero SNR offsets no mantissa bits are allocated. */
+void
+media_gen_ac3_frame (guint8 * frame, gboolean surround)
+{
+  /* 48 kHz, 192 kbit/s */
+  static const guint8 header[] = { 0x0b, 0x77, 0x00, 0x00, 0x14, 0x40 };
+  BitWriter bw = { frame, 8 * sizeof (header) };
+  guint n_chans = surround ? 5 : 2;
+  guint ch, i;
+
+  memset (frame, 0, MEDIA_GEN_AC3_FRAME_SIZE);
+  memcpy (frame, header, sizeof (header));
+
+  /* bsi: acmod 3/2 with cmixlev and surmixlev, or 2/0 with dsurmod */
+  if (surround) {
+    put_bits (&bw, 7, 3);
+    put_bits (&bw, 0, 2);
+    put_bits (&bw, 0, 2);
+  } else {
+    put_bits (&bw, 2, 3);
+    put_bits (&bw, 0, 2);
+  }
+  /* lfeon, dialnorm, compre, langcode, audprodie, copyrightb, origbs,
+   * timecod1e, timecod2e, addbsie */
+  put_bits (&bw, surround, 1);
+  put_bits (&bw, 27, 5);
+  put_bits (&bw, 0, 3);
+  put_bits (&bw, 0, 1);
+  put_bits (&bw, 1, 1);
+  put_bits (&bw, 0, 3);
+
+  /* block 0: blksw and dithflag per channel, dynrnge, cplstre, cplinu */
+  put_bits (&bw, 0, n_chans);
+  put_bits (&bw, 0, n_chans);
+  put_bits (&bw, 0, 1);
+  put_bits (&bw, 1, 1);
+  put_bits (&bw, 0, 1);
+  /* rematstr and the four rematrixing flags, stereo only */
+  if (!surround) {
+    put_bits (&bw, 1, 1);
+    put_bits (&bw, 0, 4);
+  }
+  /* D45 exponent strategy per channel, D15 for the LFE channel, chbwcod */
+  for (ch = 0; ch < n_chans; ch++)
+    put_bits (&bw, 3, 2);
+  if (surround)
+    put_bits (&bw, 1, 1);
+  for (ch = 0; ch < n_chans; ch++)
+    put_bits (&bw, 0, 6);
+
+  /* absolute exponent and six groups of unchanged exponents, gainrng */
+  for (ch = 0; ch < n_chans; ch++) {
+    put_bits (&bw, 15, 4);
+    for (i = 0; i < 6; i++)
+      put_bits (&bw, 62, 7);
+    put_bits (&bw, 0, 2);
+  }
+  /* the LFE channel has two groups and no gainrng */
+  if (surround) {
+    put_bits (&bw, 15, 4);
+    put_bits (&bw, 62, 7);
+    put_bits (&bw, 62, 7);
+  }
+
+  /* baie: sdcycod, fdcycod, sgaincod, dbpbcod, floorcod */
+  put_bits (&bw, 1, 1);
+  put_bits (&bw, 2, 2);
+  put_bits (&bw, 1, 2);
+  put_bits (&bw, 1, 2);
+  put_bits (&bw, 2, 2);
+  put_bits (&bw, 7, 3);
+
+  /* snroffste: csnroffst, fsnroffst and fgaincod per channel */
+  put_bits (&bw, 1, 1);
+  put_bits (&bw, 0, 6);
+  for (ch = 0; ch < n_chans + (surround ? 1 : 0); ch++) {
+    put_bits (&bw, 0, 4);
+    put_bits (&bw, 4, 3);
+  }
+
+  /* deltbaie, skiple; blocks 1 to 5 reuse everything and are all zero */
+  put_bits (&bw, 0, 2);
+}
@@ -0,0 +1,559 @@
+/* GStreamer
+ *
+ * Synthetic ASF streams for the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mediagen.h"
+
+#include <string.h>
+
+static const guint32 guid_header[] =
+    { 0x75B22630, 0x11CF668E, 0xAA00D9A6, 0x6CCE6200 };
+static const guint32 guid_file[] =
+    { 0x8CABDCA1, 0x11CFA947, 0xC000E48E, 0x6553200C };
+static const guint32 guid_stream[] =
+    { 0xB7DC0791, 0x11CFA9B7, 0xC000E68E, 0x6553200C };
+static const guint32 guid_header_ext[] =
+    { 0x5FBF03B5, 0x11CFA92E, 0xC000E38E, 0x6553200C };
+static const guint32 guid_header_ext_reserved[] =
+    { 0xABD3D211, 0x11CFA9BA, 0xC000E68E, 0x6553200C };
+static const guint32 guid_ext_stream_props[] =
+    { 0x14E6A5CB, 0x4332C672, 0x69A99983, 0x5A5B0652 };
+static const guint32 guid_data[] =
+    { 0x75B22636, 0x11CF668E, 0xAA00D9A6, 0x6CCE6200 };
+static const guint32 guid_simple_index[] =
+    { 0x33000890, 0x11CFE5B1, 0xA000F489, 0xCB4903C9 };
+static const guint32 guid_stream_audio[] =
+    { 0xF8699E40, 0x11CF5B4D, 0x8000FDA8, 0x2B445C5F };
+static const guint32 guid_correction_off[] =
+    { 0x20FB5700, 0x11CF5B55, 0x8000FDA8, 0x2B445C5F };
+static const guint32 guid_correction_on[] =
+    { 0xBFC3CD50, 0x11CF618F, 0xAA00B28B, 0x20E2B400 };
+static const guint32 guid_file_id[] =
+    { 0x01234567, 0x89ABCDEF, 0x01234567, 0x89ABCDEF };
+
+#define HEADER_OBJECT_SIZE 30
+#define FILE_OBJECT_SIZE 104
+/* with a WAVEFORMATEX, and the error correction data when scrambling */
+#define STREAM_OBJECT_SIZE (78 + 18)
+#define CORRECTION_DATA_SIZE 8
+#define EXT_STREAM_PROPS_SIZE (24 + 64)
+#define HEADER_EXT_SIZE (24 + 16 + 2 + 4 + EXT_STREAM_PROPS_SIZE)
+#define DATA_OBJECT_SIZE 50
+#define SIMPLE_INDEX_SIZE 56
+#define SIMPLE_INDEX_ENTRY_SIZE 6
+
+#define INDEX_INTERVAL 1000     /* ms */
+
+#define PACKET_HEADER_SIZE MEDIA_GEN_ASF_PACKET_HEADER_SIZE
+#define PAYLOAD_HEADER_SIZE MEDIA_GEN_ASF_PAYLOAD_HEADER_SIZE
+
+typedef struct
+{
+  guint32 packet;
+  guint16 count;
+} AsfIndexEntry;
+
+typedef struct
+{
+  const MediaGenAsf *gen;
+  MediaGenWriteFunc func;
+  gpointer user_data;
+
+  GByteArray *buf;
+  guint8 *plain;
+  guint8 *object;
+  guint64 n_packets;
+  GArray *index;
+} AsfWriter;
+
+static void
+put_u8 (GByteArray * a, guint8 val)
+{
+  g_byte_array_append (a, &val, 1);
+}
+
+static void
+put_u16 (GByteArray * a, guint16 val)
+{
+  val = GUINT16_TO_LE (val);
+  g_byte_array_append (a, (const guint8 *) &val, 2);
+}
+
+static void
+put_u32 (GByteArray * a, guint32 val)
+{
+  val = GUINT32_TO_LE (val);
+  g_byte_array_append (a, (const guint8 *) &val, 4);
+}
+
+static void
+put_u64 (GByteArray * a, guint64 val)
+{
+  val = GUINT64_TO_LE (val);
+  g_byte_array_append (a, (const guint8 *) &val, 8);
+}
+
+static void
+put_guid (GByteArray * a, const guint32 * guid)
+{
+  gint i;
+
+  for (i = 0; i < 4; i++)
+    put_u32 (a, guid[i]);
+}
+
+static gboolean
+asf_writer_flush (AsfWriter * w)
+{
+  gboolean ret;
+
+  ret = w->func (w->buf->data, w->buf->len, w->user_data);
+  g_byte_array_set_size (w->buf, 0);
+
+  return ret;
+}
+
+static guint
+get_object_size (const MediaGenAsf * gen)
+{
+  if (gen->span > 1)
+    return gen->ds_packet_size * gen->span;
+
+  return gen->object_size;
+}
+
+static guint64
+get_duration (const MediaGenAsf * gen)
+{
+  return gen->n_objects * gen->object_duration;
+}
+
+/* objects of all streams, interleaved in turn */
+static guint64
+get_n_objects (const MediaGenAsf * gen)
+{
+  return gen->n_objects * gen->n_streams;
+}
+
+/* presentation time of object @obj of get_n_objects(), in ms */
+static guint64
+get_object_pts (const MediaGenAsf * gen, guint64 obj)
+{
+  guint64 pts = (obj / gen->n_streams) * gen->object_duration + gen->preroll;
+
+  if (gen->n_streams > 1 && obj % gen->n_streams == 0)
+    pts += gen->stream_offset;
+
+  return pts;
+}
+
+static guint
+get_n_index_entries (const MediaGenAsf * gen)
+{
+  if (!gen->simple_index || gen->n_objects == 0)
+    return 0;
+
+  return (gen->n_objects - 1) * gen->object_duration / INDEX_INTERVAL + 1;
+}
+
+/* stores chunk off of the plain object at the place asfdemux takes it
+ * from when descrambling */
+static void
+load_object (AsfWriter * w, guint64 n)
+{
+  const MediaGenAsf *gen = w->gen;
+  guint cs = gen->ds_chunk_size, n_chunks, off;
+
+  if (gen->span <= 1) {
+    media_gen_fill_payload (w->object, gen->object_size, n);
+    return;
+  }
+
+  media_gen_fill_payload (w->plain, get_object_size (gen), n);
+
+  n_chunks = get_object_size (gen) / cs;
+  for (off = 0; off < n_chunks; off++) {
+    guint row = off / gen->span;
+    guint col = off % gen->span;
+    guint idx = row + col * gen->ds_packet_size / cs;
+
+    memcpy (w->object + idx * cs, w->plain + off * cs, cs);
+  }
+}
+
+/* Cuts the media objects into packets. Without a write function this only
+ * counts them, which is what the header needs to know up front. */
+static gboolean
+write_packets (AsfWriter * w)
+{
+  const MediaGenAsf *gen = w->gen;
+  guint object_size = get_object_size (gen);
+  guint64 n_objects = get_n_objects (gen);
+  guint64 obj = 0, obj_first_packet = 0, next_index_time = 0;
+  guint obj_offset = 0;
+  gboolean multiple = gen->multiple_payloads;
+
+  if (w->func && n_objects > 0)
+    load_object (w, 0);
+
+  w->n_packets = 0;
+  while (obj < n_objects) {
+    guint start = w->buf->len, space, n_payloads = 0;
+    guint padding_pos;
+
+    put_u8 (w->buf, 0x82);
+    put_u16 (w->buf, 0);
+    /* padding length as word, optionally multiple payloads */
+    put_u8 (w->buf, multiple ? 0x11 : 0x10);
+    /* byte stream number, byte object number, dword offset, byte
+     * replicated data length */
+    put_u8 (w->buf, 0x5d);
+    padding_pos = w->buf->len;
+    put_u16 (w->buf, 0);
+    put_u32 (w->buf, (obj / gen->n_streams) * gen->object_duration);
+    put_u16 (w->buf, 0);
+
+    space = gen->packet_size - PACKET_HEADER_SIZE;
+    if (multiple) {
+      /* number of payloads with word lengths, filled in below */
+      put_u8 (w->buf, 0x80);
+      space--;
+    }
+
+    while (obj < n_objects && n_payloads < 63) {
+      guint header = PAYLOAD_HEADER_SIZE + (multiple ? 2 : 0);
+      guint len;
+
+      if (space <= header)
+        break;
+      len = MIN (space - header, object_size - obj_offset);
+
+      if (obj_offset == 0) {
+        guint64 pts = obj * gen->object_duration;
+
+        obj_first_packet = w->n_packets;
+        while (w->index && next_index_time <= pts) {
+          AsfIndexEntry entry = { w->n_packets, 0 };
+
+          g_array_append_val (w->index, entry);
+          next_index_time += INDEX_INTERVAL;
+        }
+      }
+
+      put_u8 (w->buf, 0x80 | (obj % gen->n_streams + 1));
+      put_u8 (w->buf, (obj / gen->n_streams) & 0xff);
+      put_u32 (w->buf, obj_offset);
+      put_u8 (w->buf, 8);
+      put_u32 (w->buf, object_size);
+      put_u32 (w->buf, get_object_pts (gen, obj));
+      if (multiple)
+        put_u16 (w->buf, len);
+      if (w->func)
+        g_byte_array_append (w->buf, w->object + obj_offset, len);
+      else
+        g_byte_array_set_size (w->buf, w->buf->len + len);
+
+      space -= header + len;
+      n_payloads++;
+      obj_offset += len;
+      if (obj_offset == object_size) {
+        gint i;
+
+        /* the index entries of this object know its packets now */
+        for (i = w->index ? w->index->len - 1 : -1; i >= 0; i--) {
+          AsfIndexEntry *entry = &g_array_index (w->index, AsfIndexEntry, i);
+
+          if (entry->count != 0 || entry->packet != obj_first_packet)
+            break;
+          entry->count = w->n_packets - obj_first_packet + 1;
+        }
+
+        obj++;
+        obj_offset = 0;
+        if (w->func && obj < n_objects)
+          load_object (w, obj);
+      }
+      if (!multiple)
+        break;
+    }
+
+    if (multiple)
+      w->buf->data[start + PACKET_HEADER_SIZE] |= n_payloads;
+    w->buf->data[padding_pos] = space & 0xff;
+    w->buf->data[padding_pos + 1] = space >> 8;
+    g_byte_array_set_size (w->buf, start + gen->packet_size);
+    memset (w->buf->data + start + gen->packet_size - space, 0, space);
+    w->n_packets++;
+
+    if (!w->func)
+      g_byte_array_set_size (w->buf, 0);
+    else if (!asf_writer_flush (w))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+put_header (AsfWriter * w)
+{
+  const MediaGenAsf *gen = w->gen;
+  GByteArray *a = w->buf;
+  guint stream_size, header_size, n_objects, n;
+  guint64 duration, data_size, index_size;
+  guint32 bitrate;
+
+  stream_size = STREAM_OBJECT_SIZE;
+  if (gen->span > 1)
+    stream_size += CORRECTION_DATA_SIZE;
+  header_size = HEADER_OBJECT_SIZE + FILE_OBJECT_SIZE +
+      gen->n_streams * stream_size;
+  n_objects = 1 + gen->n_streams;
+  if (gen->ext_stream_props) {
+    header_size += HEADER_EXT_SIZE;
+    n_objects++;
+  }
+
+  data_size = DATA_OBJECT_SIZE + w->n_packets * gen->packet_size;
+  index_size = 0;
+  if (gen->simple_index)
+    index_size = SIMPLE_INDEX_SIZE +
+        SIMPLE_INDEX_ENTRY_SIZE * get_n_index_entries (gen);
+
+  /* in 100 ns units, the play duration includes the preroll */
+  duration = get_duration (gen) * 10000;
+  bitrate = (guint64) get_object_size (gen) * 8 * 1000 /
+      MAX (gen->object_duration, 1);
+
+  put_guid (a, guid_header);
+  put_u64 (a, header_size);
+  put_u32 (a, n_objects);
+  put_u8 (a, 0x01);
+  put_u8 (a, 0x02);
+
+  put_guid (a, guid_file);
+  put_u64 (a, FILE_OBJECT_SIZE);
+  put_guid (a, guid_file_id);
+  if (gen->broadcast) {
+    /* size, creation date, packet count, play and send duration */
+    put_u64 (a, 0);
+    put_u64 (a, 0);
+    put_u64 (a, 0);
+    put_u64 (a, 0);
+    put_u64 (a, 0);
+  } else {
+    put_u64 (a, header_size + data_size + index_size);
+    put_u64 (a, 0);
+    put_u64 (a, w->n_packets);
+    put_u64 (a, duration + (guint64) gen->preroll * 10000);
+    put_u64 (a, duration);
+  }
+  put_u64 (a, gen->preroll);
+  /* broadcast or seekable */
+  put_u32 (a, gen->broadcast ? 0x01 : 0x02);
+  put_u32 (a, gen->packet_size);
+  put_u32 (a, gen->packet_size);
+  put_u32 (a, bitrate * gen->n_streams);
+
+  for (n = 1; n <= gen->n_streams; n++) {
+    put_guid (a, guid_stream);
+    put_u64 (a, stream_size);
+    put_guid (a, guid_stream_audio);
+    put_guid (a, gen->span > 1 ? guid_correction_on : guid_correction_off);
+    put_u64 (a, 0);
+    put_u32 (a, 18);
+    put_u32 (a, gen->span > 1 ? CORRECTION_DATA_SIZE : 0);
+    put_u16 (a, n);
+    put_u32 (a, 0);
+    /* WAVEFORMATEX for 16 bit PCM */
+    put_u16 (a, 0x0001);
+    put_u16 (a, 2);
+    put_u32 (a, 44100);
+    put_u32 (a, bitrate / 8);
+    put_u16 (a, 4);
+    put_u16 (a, 16);
+    put_u16 (a, 0);
+    if (gen->span > 1) {
+      /* span, packet and chunk size, one byte of silence data */
+      put_u8 (a, gen->span);
+      put_u16 (a, gen->ds_packet_size);
+      put_u16 (a, gen->ds_chunk_size);
+      put_u16 (a, 1);
+      put_u8 (a, 0);
+    }
+  }
+
+  if (gen->ext_stream_props) {
+    put_guid (a, guid_header_ext);
+    put_u64 (a, HEADER_EXT_SIZE);
+    put_guid (a, guid_header_ext_reserved);
+    put_u16 (a, 6);
+    put_u32 (a, EXT_STREAM_PROPS_SIZE);
+
+    /* no stream names, payload extensions or hidden stream object */
+    put_guid (a, guid_ext_stream_props);
+    put_u64 (a, EXT_STREAM_PROPS_SIZE);
+    put_u64 (a, 0);
+    put_u64 (a, get_duration (gen));
+    put_u32 (a, bitrate);
+    put_u32 (a, 0);
+    put_u32 (a, 0);
+    put_u32 (a, bitrate);
+    put_u32 (a, 0);
+    put_u32 (a, 0);
+    put_u32 (a, get_object_size (gen));
+    put_u32 (a, 0);
+    put_u16 (a, 1);
+    put_u16 (a, 0);
+    put_u64 (a, (guint64) gen->object_duration * 10000);
+    put_u16 (a, 0);
+    put_u16 (a, 0);
+  }
+
+  g_assert (a->len == header_size);
+
+  put_guid (a, guid_data);
+  put_u64 (a, data_size);
+  put_guid (a, guid_file_id);
+  put_u64 (a, gen->broadcast ? 0 : w->n_packets);
+  put_u8 (a, 0x01);
+  put_u8 (a, 0x01);
+}
+
+static void
+put_simple_index (AsfWriter * w)
+{
+  GByteArray *a = w->buf;
+  guint16 max_count = 0;
+  guint i;
+
+  g_assert (w->index->len == get_n_index_entries (w->gen));
+
+  for (i = 0; i < w->index->len; i++)
+    max_count = MAX (max_count, g_array_index (w->index, AsfIndexEntry,
+            i).count);
+
+  put_guid (a, guid_simple_index);
+  put_u64 (a, SIMPLE_INDEX_SIZE + SIMPLE_INDEX_ENTRY_SIZE * w->index->len);
+  put_guid (a, guid_file_id);
+  put_u64 (a, (guint64) INDEX_INTERVAL * 10000);
+  put_u32 (a, max_count);
+  put_u32 (a, w->index->len);
+  for (i = 0; i < w->index->len; i++) {
+    AsfIndexEntry *entry = &g_array_index (w->index, AsfIndexEntry, i);
+
+    put_u32 (a, entry->packet);
+    put_u16 (a, entry->count);
+  }
+}
+
+void
+media_gen_asf_init (MediaGenAsf * gen)
+{
+  memset (gen, 0, sizeof (MediaGenAsf));
+
+  /* 44.1 kHz stereo in objects of 10 ms */
+  gen->packet_size = 8192;
+  gen->object_size = 1764;
+  gen->object_duration = 10;
+  gen->n_objects = 6000;
+  gen->n_streams = 1;
+}
+
+static gboolean
+media_gen_asf_is_valid (const MediaGenAsf * gen)
+{
+  guint header = PACKET_HEADER_SIZE + 1 + PAYLOAD_HEADER_SIZE + 2;
+
+  if (gen->packet_size <= header || gen->packet_size > G_MAXUINT16)
+    return FALSE;
+  if (get_object_size (gen) == 0)
+    return FALSE;
+  /* the index and the extended properties describe a single stream */
+  if (gen->n_streams == 0 || gen->n_streams > 2)
+    return FALSE;
+  if (gen->n_streams > 1 && (gen->simple_index || gen->ext_stream_props))
+    return FALSE;
+  if (gen->span > 1) {
+    if (gen->span > G_MAXUINT8 || gen->ds_packet_size > G_MAXUINT16)
+      return FALSE;
+    /* else asfdemux disables descrambling */
+    if (gen->ds_chunk_size == 0 || gen->ds_packet_size % gen->ds_chunk_size
+        || gen->ds_packet_size / gen->ds_chunk_size <= 1)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+guint64
+media_gen_asf_get_n_packets (const MediaGenAsf * gen)
+{
+  AsfWriter w = { gen, NULL, NULL, };
+
+  g_return_val_if_fail (media_gen_asf_is_valid (gen), 0);
+
+  w.buf = g_byte_array_sized_new (gen->packet_size);
+  write_packets (&w);
+  g_byte_array_unref (w.buf);
+
+  return w.n_packets;
+}
+
+/* Writes the header, the data object and the optional simple index. The
+ * packets are laid out twice, once to count them for the headers and once
+ * to write them. */
+gboolean
+media_gen_asf_write (const MediaGenAsf * gen, MediaGenWriteFunc func,
+    gpointer user_data)
+{
+  AsfWriter w = { gen, func, user_data, };
+  gboolean ret;
+
+  g_return_val_if_fail (media_gen_asf_is_valid (gen), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  w.buf = g_byte_array_sized_new (MAX (gen->packet_size, 1024));
+  w.n_packets = media_gen_asf_get_n_packets (gen);
+  w.object = g_malloc (get_object_size (gen));
+  if (gen->span > 1)
+    w.plain = g_malloc (get_object_size (gen));
+  if (gen->simple_index)
+    w.index = g_array_new (FALSE, FALSE, sizeof (AsfIndexEntry));
+
+  put_header (&w);
+  ret = asf_writer_flush (&w) && write_packets (&w);
+
+  if (ret && w.index) {
+    put_simple_index (&w);
+    ret = asf_writer_flush (&w);
+  }
+
+  if (w.index)
+    g_array_free (w.index, TRUE);
+  g_free (w.plain);
+  g_free (w.object);
+  g_byte_array_unref (w.buf);
+
+  return ret;
+}
@@ -0,0 +1,533 @@
+/* GStreamer
+ *
+ * Synthetic RealMedia streams for the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mediagen.h"
+
+#include <string.h>
+
+#define RMF_CHUNK_SIZE 18
+#define PROP_CHUNK_SIZE 50
+#define RA4_HEADER_SIZE 73
+#define DATA_HEADER_SIZE 18
+#define INDX_HEADER_SIZE 20
+#define INDX_ENTRY_SIZE 14
+#define VIDO_HEADER_SIZE 34
+#define PACKET_HEADER_SIZE 12
+/* header byte, sequence, frame length, offset and frame number */
+#define FRAGMENT_HEADER_SIZE (1 + 1 + 4 + 4 + 1)
+
+#define VIDEO_WIDTH 320
+#define VIDEO_HEIGHT 240
+
+static const gchar audio_stream_name[] = "Audio Stream";
+static const gchar audio_mime_type[] = "audio/x-pn-realaudio";
+static const gchar video_stream_name[] = "Video Stream";
+static const gchar video_mime_type[] = "video/x-pn-realvideo";
+
+static const MediaGenRm presets[] = {
+  /* each packet is one byte-swapped AC-3 frame */
+  {"dnet", 4, 768, 1, 768, 48000, 2, 32},
+  /* 16 packets interleaved in leaves of 160 bytes, 64 kbit/s */
+  {"cook", 4, 640, 16, 160, 44100, 2, 1280},
+  /* 12 packets interleaved in leaves of 384 bytes, 132 kbit/s */
+  {"atrc", 5, 768, 12, 384, 44100, 2, 558},
+  /* 16 kbit/s, rmdemux takes the leaf size from the flavor */
+  {"sipr", 3, 240, 6, 20, 16000, 1, 720},
+  /* frames of 8 fragments of 1400 bytes at 25 fps */
+  {"RV30", 0, 1400, 8, 0, 0, 0, 40},
+  {"RV40", 0, 1400, 8, 0, 0, 0, 40},
+};
+
+/* the nibble blocks that sipr swaps, 96 blocks per interleaving block */
+static const guint8 sipr_swap_index[38][2] = {
+  {0, 63}, {1, 22}, {2, 44}, {3, 90},
+  {5, 81}, {7, 31}, {8, 86}, {9, 58},
+  {10, 36}, {12, 68}, {13, 39}, {14, 73},
+  {15, 53}, {16, 69}, {17, 57}, {19, 88},
+  {20, 34}, {21, 71}, {24, 46}, {25, 94},
+  {26, 54}, {28, 75}, {29, 50}, {32, 70},
+  {33, 92}, {35, 74}, {38, 85}, {40, 56},
+  {42, 87}, {43, 65}, {45, 59}, {48, 79},
+  {49, 93}, {51, 89}, {55, 95}, {61, 76},
+  {67, 83}, {77, 80}
+};
+
+static void
+put_data (GByteArray * a, const void *data, guint size)
+{
+  g_byte_array_append (a, data, size);
+}
+
+static void
+put_u8 (GByteArray * a, guint8 val)
+{
+  g_byte_array_append (a, &val, 1);
+}
+
+static void
+put_u16 (GByteArray * a, guint16 val)
+{
+  val = GUINT16_TO_BE (val);
+  g_byte_array_append (a, (const guint8 *) &val, 2);
+}
+
+static void
+put_u32 (GByteArray * a, guint32 val)
+{
+  val = GUINT32_TO_BE (val);
+  g_byte_array_append (a, (const guint8 *) &val, 4);
+}
+
+static void
+put_zero (GByteArray * a, guint size)
+{
+  guint start = a->len;
+
+  g_byte_array_set_size (a, start + size);
+  memset (a->data + start, 0, size);
+}
+
+static void
+put_chunk_header (GByteArray * a, const gchar * id, guint32 size)
+{
+  put_data (a, id, 4);
+  put_u32 (a, size);
+  put_u16 (a, 0);
+}
+
+static gboolean
+is_video (const MediaGenRm * gen)
+{
+  return gen->fourcc[0] == 'R' && gen->fourcc[1] == 'V';
+}
+
+/* the size of a packet in the data chunk, headers included */
+static guint32
+get_packet_length (const MediaGenRm * gen)
+{
+  if (is_video (gen))
+    return PACKET_HEADER_SIZE + FRAGMENT_HEADER_SIZE + gen->packet_size;
+
+  return PACKET_HEADER_SIZE + gen->packet_size;
+}
+
+static guint
+get_mdpr_size (const MediaGenRm * gen)
+{
+  if (is_video (gen))
+    return 10 + 2 + 7 * 4 + 1 + strlen (video_stream_name) + 1 +
+        strlen (video_mime_type) + 4 + VIDO_HEADER_SIZE;
+
+  return 10 + 2 + 7 * 4 + 1 + strlen (audio_stream_name) + 1 +
+      strlen (audio_mime_type) + 4 + RA4_HEADER_SIZE;
+}
+
+static guint64
+get_n_index_entries (const MediaGenRm * gen)
+{
+  if (!gen->index || gen->n_blocks == 0)
+    return 0;
+
+  return (gen->n_blocks - 1) * gen->block_duration / gen->index_interval + 1;
+}
+
+/* RealAudio 4 type specific data of the MDPR chunk, or the header of a .ra
+ * file with @data_size bytes of packets */
+static void
+put_ra4_header (GByteArray * a, const MediaGenRm * gen, guint32 data_size)
+{
+  put_data (a, ".ra\375", 4);
+  put_u16 (a, 4);
+  put_u16 (a, 0);
+  put_data (a, ".ra4", 4);
+  put_u32 (a, data_size);
+  put_u16 (a, 4);
+  put_u32 (a, RA4_HEADER_SIZE - 16);
+  put_u16 (a, gen->flavor);
+  put_u32 (a, gen->packet_size);
+  put_zero (a, 12);
+  put_u16 (a, gen->height);
+  put_u16 (a, gen->packet_size);
+  put_u16 (a, gen->leaf_size);
+  put_u16 (a, 0);
+  put_u16 (a, gen->rate);
+  put_u16 (a, 0);
+  put_u16 (a, 16);
+  put_u16 (a, gen->channels);
+  put_u8 (a, 4);
+  put_data (a, "Int4", 4);
+  put_u8 (a, 4);
+  put_data (a, gen->fourcc, 4);
+  put_zero (a, 3);
+  /* no codec data, in a .ra file no title, author, copyright and comment */
+  put_u32 (a, 0);
+}
+
+/* RealVideo type specific data of the MDPR chunk, without codec data */
+static void
+put_vido_header (GByteArray * a, const MediaGenRm * gen)
+{
+  put_u32 (a, VIDO_HEADER_SIZE);
+  put_data (a, "VIDO", 4);
+  put_data (a, gen->fourcc, 4);
+  put_u16 (a, VIDEO_WIDTH);
+  put_u16 (a, VIDEO_HEIGHT);
+  put_u16 (a, 12);
+  put_u32 (a, 0);
+  /* frame rate in 16.16 fixed point */
+  put_u16 (a, 1000 / gen->block_duration);
+  put_u16 (a, 0);
+  put_u32 (a, 0);
+  put_u32 (a, 0);
+}
+
+static void
+put_header (GByteArray * a, const MediaGenRm * gen)
+{
+  guint64 n_packets = gen->n_blocks * gen->height;
+  guint32 max_packet = get_packet_length (gen);
+  const gchar *stream_name, *mime_type;
+  guint32 duration = gen->n_blocks * gen->block_duration;
+  guint32 bitrate, data_offset, index_offset = 0;
+  guint64 data_size;
+
+  bitrate = (guint64) gen->height * gen->packet_size * 8 * 1000 /
+      gen->block_duration;
+  data_offset = RMF_CHUNK_SIZE + PROP_CHUNK_SIZE + get_mdpr_size (gen);
+  data_size = DATA_HEADER_SIZE + n_packets * max_packet;
+  if (gen->index)
+    index_offset = data_offset + data_size;
+
+  put_chunk_header (a, ".RMF", RMF_CHUNK_SIZE);
+  put_u32 (a, 0);
+  put_u32 (a, gen->index ? 4 : 3);
+
+  put_chunk_header (a, "PROP", PROP_CHUNK_SIZE);
+  put_u32 (a, bitrate);
+  put_u32 (a, bitrate);
+  put_u32 (a, max_packet);
+  put_u32 (a, max_packet);
+  put_u32 (a, n_packets);
+  put_u32 (a, duration);
+  put_u32 (a, 0);
+  put_u32 (a, index_offset);
+  put_u32 (a, data_offset);
+  put_u16 (a, 1);
+  put_u16 (a, 0);
+
+  if (is_video (gen)) {
+    stream_name = video_stream_name;
+    mime_type = video_mime_type;
+  } else {
+    stream_name = audio_stream_name;
+    mime_type = audio_mime_type;
+  }
+
+  put_chunk_header (a, "MDPR", get_mdpr_size (gen));
+  put_u16 (a, 0);
+  put_u32 (a, bitrate);
+  put_u32 (a, bitrate);
+  put_u32 (a, max_packet);
+  put_u32 (a, max_packet);
+  put_u32 (a, 0);
+  put_u32 (a, 0);
+  put_u32 (a, duration);
+  put_u8 (a, strlen (stream_name));
+  put_data (a, stream_name, strlen (stream_name));
+  put_u8 (a, strlen (mime_type));
+  put_data (a, mime_type, strlen (mime_type));
+  if (is_video (gen)) {
+    put_u32 (a, VIDO_HEADER_SIZE);
+    put_vido_header (a, gen);
+  } else {
+    put_u32 (a, RA4_HEADER_SIZE);
+    put_ra4_header (a, gen, 0);
+  }
+
+  g_assert (a->len == data_offset);
+
+  put_chunk_header (a, "DATA", data_size);
+  put_u32 (a, n_packets);
+  put_u32 (a, 0);
+}
+
+/* one entry per interval, pointing at the first block at or after it */
+static void
+put_index (GByteArray * a, const MediaGenRm * gen)
+{
+  guint64 n_entries = get_n_index_entries (gen);
+  guint32 data_offset, block_size;
+  guint64 i;
+
+  data_offset = RMF_CHUNK_SIZE + PROP_CHUNK_SIZE + get_mdpr_size (gen);
+  block_size = gen->height * get_packet_length (gen);
+
+  put_chunk_header (a, "INDX", INDX_HEADER_SIZE + n_entries * INDX_ENTRY_SIZE);
+  put_u32 (a, n_entries);
+  put_u16 (a, 0);
+  /* no next index */
+  put_u32 (a, 0);
+
+  for (i = 0; i < n_entries; i++) {
+    guint64 block;
+
+    block = (i * gen->index_interval + gen->block_duration - 1) /
+        gen->block_duration;
+
+    put_u16 (a, 0);
+    put_u32 (a, block * gen->block_duration);
+    put_u32 (a, data_offset + DATA_HEADER_SIZE + block * block_size);
+    put_u32 (a, block * gen->height);
+  }
+}
+
+static guint
+get_nibble (const guint8 * data, guint n)
+{
+  return (n & 1) ? data[n >> 1] >> 4 : data[n >> 1] & 0x0f;
+}
+
+static void
+set_nibble (guint8 * data, guint n, guint val)
+{
+  if (n & 1)
+    data[n >> 1] = (data[n >> 1] & 0x0f) | (val << 4);
+  else
+    data[n >> 1] = (data[n >> 1] & 0xf0) | val;
+}
+
+/* the swaps are their own inverse, so this is what rmdemux does too */
+static void
+swap_sipr_nibbles (guint8 * data, gsize size)
+{
+  guint n, i, bs = size * 2 / 96;
+
+  for (n = 0; n < G_N_ELEMENTS (sipr_swap_index); n++) {
+    guint idx1 = bs * sipr_swap_index[n][0];
+    guint idx2 = bs * sipr_swap_index[n][1];
+
+    for (i = 0; i < bs; i++) {
+      guint tmp = get_nibble (data, idx1 + i);
+
+      set_nibble (data, idx1 + i, get_nibble (data, idx2 + i));
+      set_nibble (data, idx2 + i, tmp);
+    }
+  }
+}
+
+/* Numbers with the two top bits clear take four bytes. The last fragment
+ * has the size of its data in place of the offset. */
+static void
+put_fragment_header (GByteArray * a, const MediaGenRm * gen, guint64 n,
+    guint p)
+{
+  gboolean last = p + 1 == gen->height;
+
+  put_u8 (a, last ? 0x80 : 0x00);
+  put_u8 (a, p + 1);
+  put_u32 (a, gen->height * gen->packet_size);
+  put_u32 (a, last ? gen->packet_size : p * gen->packet_size);
+  put_u8 (a, n & 0xff);
+}
+
+/* lays out the @height packets of block @n in @out the way rmdemux puts
+ * them back together again */
+static void
+scramble_block (const MediaGenRm * gen, guint64 n, guint8 * plain,
+    guint8 * out)
+{
+  gsize size = gen->height * gen->packet_size;
+  guint p, x, i;
+
+  media_gen_fill_payload (plain, size, n);
+
+  if (!strcmp (gen->fourcc, "dnet")) {
+    for (i = 0; i + 1 < size; i += 2) {
+      out[i] = plain[i + 1];
+      out[i + 1] = plain[i];
+    }
+  } else if (!strcmp (gen->fourcc, "cook") || !strcmp (gen->fourcc, "atrc")) {
+    guint h = gen->height, leaf = gen->leaf_size;
+
+    for (p = 0; p < h; p++) {
+      for (x = 0; x < gen->packet_size / leaf; x++) {
+        guint idx = h * x + ((h + 1) / 2) * (p % 2) + (p / 2);
+
+        memcpy (out + p * gen->packet_size + x * leaf, plain + idx * leaf,
+            leaf);
+      }
+    }
+  } else {
+    swap_sipr_nibbles (plain, size);
+    memcpy (out, plain, size);
+  }
+}
+
+gboolean
+media_gen_rm_init (MediaGenRm * gen, const gchar * fourcc)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (presets); i++) {
+    if (!strcmp (presets[i].fourcc, fourcc)) {
+      *gen = presets[i];
+      gen->n_blocks = 1000;
+      gen->index_interval = 1000;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+static gboolean
+media_gen_rm_is_valid (const MediaGenRm * gen)
+{
+  if (gen->height == 0 || gen->packet_size == 0 || gen->block_duration == 0)
+    return FALSE;
+  if (get_packet_length (gen) > G_MAXUINT16)
+    return FALSE;
+  if (gen->index && gen->index_interval == 0)
+    return FALSE;
+
+  if (is_video (gen))
+    return (!strcmp (gen->fourcc, "RV30") || !strcmp (gen->fourcc, "RV40"))
+        && gen->height <= 127 && gen->block_duration <= 1000;
+
+  if (!strcmp (gen->fourcc, "dnet"))
+    return gen->height == 1;
+  if (!strcmp (gen->fourcc, "cook") || !strcmp (gen->fourcc, "atrc"))
+    return gen->leaf_size > 0 && gen->packet_size % gen->leaf_size == 0;
+  if (!strcmp (gen->fourcc, "sipr"))
+    return gen->flavor <= 3;
+
+  return FALSE;
+}
+
+/* Writes the headers, the data chunk and the optional index. */
+gboolean
+media_gen_rm_write (const MediaGenRm * gen, MediaGenWriteFunc func,
+    gpointer user_data)
+{
+  GByteArray *buf;
+  guint8 *plain, *block;
+  gboolean ret;
+  guint64 n;
+  guint p;
+
+  g_return_val_if_fail (media_gen_rm_is_valid (gen), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  buf = g_byte_array_sized_new (gen->height * get_packet_length (gen));
+  plain = g_malloc (gen->height * gen->packet_size);
+  block = g_malloc (gen->height * gen->packet_size);
+
+  put_header (buf, gen);
+  ret = func (buf->data, buf->len, user_data);
+
+  for (n = 0; ret && n < gen->n_blocks; n++) {
+    g_byte_array_set_size (buf, 0);
+    if (is_video (gen))
+      media_gen_fill_payload (block, gen->height * gen->packet_size, n);
+    else
+      scramble_block (gen, n, plain, block);
+
+    for (p = 0; p < gen->height; p++) {
+      put_u16 (buf, 0);
+      put_u16 (buf, get_packet_length (gen));
+      put_u16 (buf, 0);
+      put_u32 (buf, n * gen->block_duration);
+      put_u8 (buf, 0);
+      /* the first packet of an interleaving block is a keyframe, video
+       * frames are all keyframes */
+      put_u8 (buf, p == 0 || is_video (gen) ? 2 : 0);
+      if (is_video (gen))
+        put_fragment_header (buf, gen, n, p);
+      put_data (buf, block + p * gen->packet_size, gen->packet_size);
+    }
+    ret = func (buf->data, buf->len, user_data);
+  }
+
+  if (ret && gen->index) {
+    g_byte_array_set_size (buf, 0);
+    put_index (buf, gen);
+    ret = func (buf->data, buf->len, user_data);
+  }
+
+  g_free (block);
+  g_free (plain);
+  g_byte_array_unref (buf);
+
+  return ret;
+}
+
+static gboolean
+media_gen_ra_is_valid (const MediaGenRm * gen)
+{
+  if (is_video (gen) || gen->height == 0 || gen->packet_size == 0)
+    return FALSE;
+  if ((guint64) gen->n_blocks * gen->height * gen->packet_size > G_MAXUINT32)
+    return FALSE;
+
+  /* rademux byte-swaps every dnet packet on its own */
+  if (!strcmp (gen->fourcc, "dnet"))
+    return gen->packet_size % 2 == 0;
+
+  return media_gen_rm_is_valid (gen);
+}
+
+/* Writes the .ra header and the packets, without any framing. */
+gboolean
+media_gen_ra_write (const MediaGenRm * gen, MediaGenWriteFunc func,
+    gpointer user_data)
+{
+  GByteArray *buf;
+  guint8 *plain, *block;
+  gsize block_size;
+  gboolean ret;
+  guint64 n;
+
+  g_return_val_if_fail (media_gen_ra_is_valid (gen), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  block_size = gen->height * gen->packet_size;
+  buf = g_byte_array_new ();
+  plain = g_malloc (block_size);
+  block = g_malloc (block_size);
+
+  put_ra4_header (buf, gen, gen->n_blocks * block_size);
+  g_assert (buf->len == RA4_HEADER_SIZE);
+  ret = func (buf->data, buf->len, user_data);
+
+  for (n = 0; ret && n < gen->n_blocks; n++) {
+    scramble_block (gen, n, plain, block);
+    ret = func (block, block_size, user_data);
+  }
+
+  g_free (block);
+  g_free (plain);
+  g_byte_array_unref (buf);
+
+  return ret;
+}
@@ -0,0 +1,53 @@
+/* GStreamer
+ *
+ * Synthetic ASF and RealMedia streams for the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mediagen.h"
+
+gboolean
+media_gen_write_byte_array (const guint8 * data, gsize size,
+    gpointer byte_array)
+{
+  g_byte_array_append (byte_array, data, size);
+
+  return TRUE;
+}
+
+gboolean
+media_gen_write_file (const guint8 * data, gsize size, gpointer file)
+{
+  return fwrite (data, 1, size, file) == size;
+}
+
+void
+media_gen_fill_payload (guint8 * data, gsize size, guint64 n)
+{
+  guint32 state = (guint32) (n * 2654435761u) | 1;
+  gsize i;
+
+  /* noise, so misplaced chunks do not go unnoticed */
+  for (i = 0; i < size; i++) {
+    state = state * 1103515245 + 12345;
+    data[i] = state >> 16;
+  }
+}
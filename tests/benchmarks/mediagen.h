@@ -0,0 +1,151 @@
+/* GStreamer
+ *
+ * Synthetic ASF, RealMedia and AC-3 streams for the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __MEDIA_GEN_H__
+#define __MEDIA_GEN_H__
+
+#include <stdio.h>
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The generators write the file front to back through this function, a
+ * few kB at a time, so files of any size can be produced without keeping
+ * them in memory. Returning FALSE aborts the generator. */
+typedef gboolean (*MediaGenWriteFunc) (const guint8 * data, gsize size,
+                                       gpointer user_data);
+
+gboolean     media_gen_write_byte_array (const guint8 * data, gsize size,
+                                         gpointer byte_array);
+
+gboolean     media_gen_write_file       (const guint8 * data, gsize size,
+                                         gpointer file);
+
+/* The payload of media object or interleaving block @n, which the demuxers
+ * should output again after descrambling */
+void         media_gen_fill_payload     (guint8 * data, gsize size,
+                                         guint64 n);
+
+/* error correction data, flags, padding length, send time, duration */
+#define MEDIA_GEN_ASF_PACKET_HEADER_SIZE (3 + 2 + 2 + 4 + 2)
+/* stream, object number, offset into object, replicated data */
+#define MEDIA_GEN_ASF_PAYLOAD_HEADER_SIZE (1 + 1 + 4 + 1 + 8)
+
+typedef struct _MediaGenAsf MediaGenAsf;
+
+/* One 16 bit PCM audio stream, cut into media objects of @object_size
+ * bytes and @object_duration ms each. The presentation times of the
+ * objects are offset by @preroll ms, as in files written for streaming.
+ * A @broadcast stream has neither a duration nor a packet count.
+ *
+ * With @n_streams 2 a second such stream follows, the objects of the
+ * streams take turns and @n_objects counts those of one stream. The
+ * presentation times of the first stream are @stream_offset ms later
+ * than those of the second stream's objects sent after them.
+ *
+ * With @span > 1 the objects are scrambled the way asfdemux undoes it:
+ * every object is @span rows of @ds_packet_size bytes, the chunks of
+ * @ds_chunk_size bytes are stored column by column, and @object_size is
+ * ignored. */
+struct _MediaGenAsf
+{
+  guint packet_size;
+  guint object_size;
+  guint object_duration;
+  guint64 n_objects;
+
+  /* as many payloads per packet as fit, else exactly one */
+  gboolean multiple_payloads;
+  /* a simple index object after the data, one entry per second */
+  gboolean simple_index;
+  /* an extended stream properties object in a header extension */
+  gboolean ext_stream_props;
+
+  guint preroll;
+  gboolean broadcast;
+
+  guint n_streams;
+  guint stream_offset;
+
+  guint span;
+  guint ds_packet_size;
+  guint ds_chunk_size;
+};
+
+void         media_gen_asf_init         (MediaGenAsf * gen);
+
+guint64      media_gen_asf_get_n_packets (const MediaGenAsf * gen);
+
+gboolean     media_gen_asf_write        (const MediaGenAsf * gen,
+                                         MediaGenWriteFunc func,
+                                         gpointer user_data);
+
+typedef struct _MediaGenRm MediaGenRm;
+
+/* One RealAudio 4 stream. Every interleaving block of @height packets of
+ * @packet_size bytes is scrambled the way rmdemux undoes it for @fourcc:
+ * dnet is byte-swapped, cook and atrc are interleaved in leaves of
+ * @leaf_size bytes and sipr has its nibble blocks swapped.
+ *
+ * Or, for RV30 and RV40, one RealVideo stream of frames that are cut into
+ * @height fragments of @packet_size bytes, one fragment per packet. */
+struct _MediaGenRm
+{
+  gchar fourcc[5];
+  guint16 flavor;
+  guint32 packet_size;
+  guint16 height;
+  guint16 leaf_size;
+  guint16 rate;
+  guint16 channels;
+  guint32 block_duration;       /* ms */
+  guint64 n_blocks;
+
+  /* an INDX chunk after the data, one entry per @index_interval ms */
+  gboolean index;
+  guint32 index_interval;
+};
+
+gboolean     media_gen_rm_init          (MediaGenRm * gen,
+                                         const gchar * fourcc);
+
+gboolean     media_gen_rm_write         (const MediaGenRm * gen,
+                                         MediaGenWriteFunc func,
+                                         gpointer user_data);
+
+/* The same RealAudio 4 stream as a RealAudio file, the packets follow the
+ * header without any framing. As rademux undoes the byte swapping of every
+ * dnet packet on its own, dnet blocks can have any @height here, which
+ * makes rademux seek to the start of the blocks. */
+gboolean     media_gen_ra_write         (const MediaGenRm * gen,
+                                         MediaGenWriteFunc func,
+                                         gpointer user_data);
+
+/* 48 kHz, 192 kbit/s */
+#define MEDIA_GEN_AC3_FRAME_SIZE 768
+
+/* One AC-3 frame of silence, 3/2 with LFE (5.1) with @surround, else
+ * stereo */
+void         media_gen_ac3_frame        (guint8 * frame, gboolean surround);
+
+G_END_DECLS
+
+#endif /* __MEDIA_GEN_H__ */
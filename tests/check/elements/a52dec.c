@@ -0,0 +1,187 @@
+/* GStreamer
+ *
+ * unit test for a52dec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* the stream generator of the benchmarks */
+#include "mediagen.h"
+
+#define N_FRAMES 32
+/* 6 blocks of 256 samples per frame */
+#define FRAME_SAMPLES 1536
+
+static GstPad *mysrcpad, *mysinkpad;
+static GList *caps_list;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-ac3")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw")
+    );
+
+static GstPadProbeReturn
+caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (event, &caps);
+    caps_list = g_list_append (caps_list, gst_caps_ref (caps));
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstElement *
+setup_a52dec (guint threads)
+{
+  GstElement *dec;
+  GstCaps *caps;
+
+  dec = gst_check_setup_element ("a52dec");
+  g_object_set (dec, "threads", threads, NULL);
+
+  mysrcpad = gst_check_setup_src_pad (dec, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (dec, &sinktemplate);
+  gst_pad_add_probe (mysinkpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      caps_probe, NULL, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  caps = gst_caps_from_string ("audio/x-ac3");
+  gst_check_setup_events (mysrcpad, dec, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_set_state (dec,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return dec;
+}
+
+static void
+cleanup_a52dec (GstElement * dec)
+{
+  gst_element_set_state (dec, GST_STATE_NULL);
+
+  gst_check_drop_buffers ();
+  g_list_free_full (caps_list, (GDestroyNotify) gst_caps_unref);
+  caps_list = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (dec);
+  gst_check_teardown_sink_pad (dec);
+  gst_check_teardown_element (dec);
+}
+
+/* decodes stereo or 5.1 frames with @threads threads and checks that the
+ * output was negotiated once, with @channels channels */
+static void
+decode_frames (guint threads, gboolean surround, gint channels)
+{
+  GstElement *dec;
+  GstStructure *s;
+  guint8 frame[MEDIA_GEN_AC3_FRAME_SIZE];
+  gint out_channels = 0;
+  GList *l;
+  guint i;
+  gsize size = 0;
+
+  dec = setup_a52dec (threads);
+
+  media_gen_ac3_frame (frame, surround);
+  for (i = 0; i < N_FRAMES; i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_wrapped (g_memdup (frame, sizeof (frame)),
+        sizeof (frame));
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buf), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* the threaded jobs must not switch layouts on the way */
+  fail_unless_equals_int (g_list_length (caps_list), 1);
+  s = gst_caps_get_structure (caps_list->data, 0);
+  fail_unless (gst_structure_get_int (s, "channels", &out_channels));
+  fail_unless_equals_int (out_channels, channels);
+
+  for (l = buffers; l; l = l->next)
+    size += gst_buffer_get_size (l->data);
+  fail_unless (size > 0);
+  fail_unless_equals_int (size % (FRAME_SAMPLES * channels), 0);
+
+  cleanup_a52dec (dec);
+}
+
+GST_START_TEST (test_stereo)
+{
+  decode_frames (1, FALSE, 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stereo_threads)
+{
+  decode_frames (4, FALSE, 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_surround)
+{
+  decode_frames (1, TRUE, 6);
+}
+
+GST_END_TEST;
+
+/* the frames queued before the first job finished used to be decoded to
+ * stereo */
+GST_START_TEST (test_surround_threads)
+{
+  decode_frames (4, TRUE, 6);
+}
+
+GST_END_TEST;
+
+static Suite *
+a52dec_suite (void)
+{
+  Suite *s = suite_create ("a52dec");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_stereo);
+  tcase_add_test (tc_chain, test_stereo_threads);
+  tcase_add_test (tc_chain, test_surround);
+  tcase_add_test (tc_chain, test_surround_threads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (a52dec);
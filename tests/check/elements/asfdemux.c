@@ -0,0 +1,292 @@
+/* GStreamer
+ *
+ * unit test for asfdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* the stream generator of the benchmarks */
+#include "mediagen.h"
+
+#define PREROLL 1000            /* ms */
+#define OBJECT_DURATION 20      /* ms */
+#define OBJECT_SIZE 3528
+#define N_OBJECTS 75
+/* exactly one object per packet */
+#define PACKET_SIZE (MEDIA_GEN_ASF_PACKET_HEADER_SIZE + \
+    MEDIA_GEN_ASF_PAYLOAD_HEADER_SIZE + OBJECT_SIZE)
+/* the second stream's timestamps run this far behind the first's */
+#define STREAM_OFFSET 100       /* ms */
+
+static GstPad *mysrcpad, *mysinkpads[2];
+static guint n_pads;
+/* in total and per sink pad */
+static guint n_received, n_pad_received[2];
+static GstClockTime first_pts[2];
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-ms-asf")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* a live source without latency of its own */
+static gboolean
+src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    gst_query_set_latency (query, TRUE, 0, GST_CLOCK_TIME_NONE);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  guint idx = GPOINTER_TO_UINT (gst_pad_get_element_private (pad));
+
+  n_received++;
+  if (n_pad_received[idx]++ == 0)
+    first_pts[idx] = GST_BUFFER_PTS (buf);
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static void
+pad_added (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  GstPad *sinkpad;
+
+  fail_unless (n_pads < G_N_ELEMENTS (mysinkpads));
+
+  sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_element_private (sinkpad, GUINT_TO_POINTER (n_pads));
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  mysinkpads[n_pads++] = sinkpad;
+}
+
+static GstElement *
+setup_asfdemux (gboolean low_latency)
+{
+  GstElement *demux;
+  GstCaps *caps;
+  guint i;
+
+  n_pads = 0;
+  n_received = 0;
+  for (i = 0; i < G_N_ELEMENTS (mysinkpads); i++) {
+    n_pad_received[i] = 0;
+    first_pts[i] = GST_CLOCK_TIME_NONE;
+  }
+
+  demux = gst_check_setup_element ("asfdemux");
+  g_object_set (demux, "low-latency", low_latency, NULL);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  gst_pad_set_query_function (mysrcpad, src_query);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  caps = gst_caps_from_string ("video/x-ms-asf");
+  gst_check_setup_events (mysrcpad, demux, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return demux;
+}
+
+static void
+cleanup_asfdemux (GstElement * demux)
+{
+  guint i;
+
+  gst_element_set_state (demux, GST_STATE_NULL);
+
+  for (i = 0; i < n_pads; i++) {
+    gst_pad_set_active (mysinkpads[i], FALSE);
+    gst_object_unref (mysinkpads[i]);
+    mysinkpads[i] = NULL;
+  }
+  gst_check_teardown_src_pad (demux);
+  gst_check_teardown_element (demux);
+}
+
+/* a broadcast stream, as received from a live server */
+static GByteArray *
+create_broadcast_stream (guint n_streams, guint * header_size)
+{
+  MediaGenAsf gen;
+  GByteArray *data;
+  guint n_packets = n_streams * N_OBJECTS;
+
+  media_gen_asf_init (&gen);
+  gen.packet_size = PACKET_SIZE;
+  gen.object_size = OBJECT_SIZE;
+  gen.object_duration = OBJECT_DURATION;
+  gen.n_objects = N_OBJECTS;
+  gen.preroll = PREROLL;
+  gen.broadcast = TRUE;
+  gen.n_streams = n_streams;
+  gen.stream_offset = STREAM_OFFSET;
+
+  data = g_byte_array_new ();
+  fail_unless (media_gen_asf_write (&gen, media_gen_write_byte_array, data));
+  fail_unless_equals_int (media_gen_asf_get_n_packets (&gen), n_packets);
+
+  /* the header and data objects, everything before the first packet */
+  *header_size = data->len - n_packets * PACKET_SIZE;
+
+  return data;
+}
+
+static GstBuffer *
+copy_bytes (GByteArray * data, guint offset, guint size)
+{
+  return gst_buffer_new_wrapped (g_memdup (data->data + offset, size), size);
+}
+
+/* pushes the stream packet by packet and returns the number of packets it
+ * took to get the first buffer out */
+static guint
+push_broadcast_stream (guint n_streams, GstClockTime * latency)
+{
+  GByteArray *data;
+  GstQuery *query;
+  guint header_size, i, first_out = 0;
+  gboolean live;
+
+  data = create_broadcast_stream (n_streams, &header_size);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, copy_bytes (data, 0,
+              header_size)), GST_FLOW_OK);
+
+  for (i = 0; i < n_streams * N_OBJECTS; i++) {
+    fail_unless_equals_int (gst_pad_push (mysrcpad, copy_bytes (data,
+                header_size + i * PACKET_SIZE, PACKET_SIZE)), GST_FLOW_OK);
+    if (first_out == 0 && n_received > 0)
+      first_out = i + 1;
+  }
+  fail_unless_equals_int (n_pads, n_streams);
+
+  query = gst_query_new_latency ();
+  fail_unless (gst_pad_peer_query (mysinkpads[0], query));
+  gst_query_parse_latency (query, &live, latency, NULL);
+  fail_unless (live);
+  gst_query_unref (query);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  for (i = 0; i < n_streams; i++)
+    fail_unless_equals_int (n_pad_received[i], N_OBJECTS);
+
+  g_byte_array_unref (data);
+
+  return first_out;
+}
+
+GST_START_TEST (test_broadcast_preroll)
+{
+  GstElement *demux;
+  GstClockTime latency;
+  guint first_out;
+
+  demux = setup_asfdemux (FALSE);
+  first_out = push_broadcast_stream (1, &latency);
+
+  /* nothing comes out before the preroll is queued up */
+  GST_INFO ("first buffer after %u packets", first_out);
+  fail_unless (first_out * OBJECT_DURATION > PREROLL);
+  fail_unless_equals_uint64 (latency, PREROLL * GST_MSECOND);
+  fail_unless_equals_uint64 (first_pts[0], 0);
+
+  cleanup_asfdemux (demux);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_broadcast_low_latency)
+{
+  GstElement *demux;
+  GstClockTime latency;
+  guint first_out;
+
+  demux = setup_asfdemux (TRUE);
+  first_out = push_broadcast_stream (1, &latency);
+
+  /* every packet is pushed as soon as it is complete */
+  GST_INFO ("first buffer after %u packets", first_out);
+  fail_unless_equals_int (first_out, 1);
+  fail_unless_equals_uint64 (latency, 0);
+  fail_unless_equals_uint64 (first_pts[0], 0);
+
+  cleanup_asfdemux (demux);
+}
+
+GST_END_TEST;
+
+/* The first stream's first packet comes before any of the second stream
+ * but is presented later. Starting the streams from it alone would map
+ * both to 0 and lose the offset between them. */
+GST_START_TEST (test_broadcast_low_latency_two_streams)
+{
+  GstElement *demux;
+  GstClockTime latency;
+  guint first_out;
+
+  demux = setup_asfdemux (TRUE);
+  first_out = push_broadcast_stream (2, &latency);
+
+  /* waits for one payload of each stream */
+  GST_INFO ("first buffer after %u packets", first_out);
+  fail_unless_equals_int (first_out, 2);
+  fail_unless_equals_uint64 (latency, 0);
+  fail_unless_equals_uint64 (first_pts[0], STREAM_OFFSET * GST_MSECOND);
+  fail_unless_equals_uint64 (first_pts[1], 0);
+
+  cleanup_asfdemux (demux);
+}
+
+GST_END_TEST;
+
+static Suite *
+asfdemux_suite (void)
+{
+  Suite *s = suite_create ("asfdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_broadcast_preroll);
+  tcase_add_test (tc_chain, test_broadcast_low_latency);
+  tcase_add_test (tc_chain, test_broadcast_low_latency_two_streams);
+
+  return s;
+}
+
+GST_CHECK_MAIN (asfdemux);
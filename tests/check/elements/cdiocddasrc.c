@@ -0,0 +1,177 @@
+/* GStreamer
+ *
+ * unit test for cdiocddasrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* The tests run against a BIN/CUE image, which libcdio opens like a drive */
+
+#define SECTOR_SIZE 2352
+#define NUM_SECTORS 300         /* 4 seconds */
+
+static gchar *tmpdir;
+static gchar *cue_file;
+static gchar *bin_file;
+static gint16 *image_data;
+
+/* A slow triangle wave, so the drive endianness detection of the element
+ * settles on host endianness for the little-endian image data */
+static void
+create_image (void)
+{
+  const gsize n_samples = NUM_SECTORS * SECTOR_SIZE / sizeof (gint16);
+  gint16 *le_data;
+  gchar *cue;
+  gsize i;
+
+  tmpdir = g_dir_make_tmp ("cdiocddasrc-XXXXXX", NULL);
+  fail_unless (tmpdir != NULL);
+
+  bin_file = g_build_filename (tmpdir, "test.bin", NULL);
+  cue_file = g_build_filename (tmpdir, "test.cue", NULL);
+
+  image_data = g_new (gint16, n_samples);
+  le_data = g_new (gint16, n_samples);
+  for (i = 0; i < n_samples; i++) {
+    gint phase = (i / 2) % 400;
+
+    image_data[i] = (phase < 200 ? phase : 400 - phase) * 80 - 8000;
+    le_data[i] = GINT16_TO_LE (image_data[i]);
+  }
+  fail_unless (g_file_set_contents (bin_file, (const gchar *) le_data,
+          n_samples * sizeof (gint16), NULL));
+  g_free (le_data);
+
+  cue = g_strdup_printf ("FILE \"%s\" BINARY\n"
+      "  TRACK 01 AUDIO\n" "    INDEX 01 00:00:00\n", bin_file);
+  fail_unless (g_file_set_contents (cue_file, cue, -1, NULL));
+  g_free (cue);
+}
+
+static void
+remove_image (void)
+{
+  g_unlink (cue_file);
+  g_unlink (bin_file);
+  g_rmdir (tmpdir);
+  g_free (cue_file);
+  g_free (bin_file);
+  g_free (tmpdir);
+  g_free (image_data);
+}
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    GByteArray * data)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  g_byte_array_append (data, map.data, map.size);
+  gst_buffer_unmap (buf, &map);
+}
+
+static GByteArray *
+read_image (gint sectors_per_read, gboolean read_ahead)
+{
+  GstElement *pipeline, *src, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  GByteArray *data;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_check_setup_element ("cdiocddasrc");
+  sink = gst_check_setup_element ("fakesink");
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  g_object_set (src, "device", cue_file, "track", 1,
+      "sectors-per-read", sectors_per_read, "read-ahead", read_ahead, NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+
+  data = g_byte_array_new ();
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), data);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return data;
+}
+
+static void
+check_read_image (gint sectors_per_read, gboolean read_ahead)
+{
+  GByteArray *data;
+
+  GST_INFO ("reading image, %d sectors per read, read-ahead %d",
+      sectors_per_read, read_ahead);
+
+  data = read_image (sectors_per_read, read_ahead);
+  fail_unless_equals_int (data->len, NUM_SECTORS * SECTOR_SIZE);
+  fail_unless (memcmp (data->data, image_data, data->len) == 0);
+  g_byte_array_unref (data);
+}
+
+GST_START_TEST (test_read_single_sectors)
+{
+  check_read_image (1, FALSE);
+  check_read_image (1, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_read_batched)
+{
+  check_read_image (16, FALSE);
+  check_read_image (16, TRUE);
+  /* doesn't divide the track length evenly */
+  check_read_image (7, TRUE);
+  check_read_image (64, TRUE);
+}
+
+GST_END_TEST;
+
+static Suite *
+cdiocddasrc_suite (void)
+{
+  Suite *s = suite_create ("cdiocddasrc");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_unchecked_fixture (tc_chain, create_image, remove_image);
+  tcase_add_test (tc_chain, test_read_single_sectors);
+  tcase_add_test (tc_chain, test_read_batched);
+
+  return s;
+}
+
+GST_CHECK_MAIN (cdiocddasrc);
@@ -0,0 +1,274 @@
+/* GStreamer
+ *
+ * unit test for dvdsubparse
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <string.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("subpicture/x-dvd, parsed=(boolean)true")
+    );
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("subpicture/x-dvd")
+    );
+
+static GstElement *
+setup_dvdsubparse (void)
+{
+  GstElement *parse;
+  GstCaps *caps;
+
+  parse = gst_check_setup_element ("dvdsubparse");
+  mysrcpad = gst_check_setup_src_pad (parse, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (parse, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  caps = gst_caps_from_string ("subpicture/x-dvd");
+  gst_check_setup_events (mysrcpad, parse, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_set_state (parse,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return parse;
+}
+
+static void
+cleanup_dvdsubparse (GstElement * parse)
+{
+  gst_check_drop_buffers ();
+  gst_element_set_state (parse, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (parse);
+  gst_check_teardown_sink_pad (parse);
+  gst_check_teardown_element (parse);
+}
+
+/* A subpicture packet only needs a correct size for the parser */
+static guint8 *
+make_packet (guint size, guint8 seed)
+{
+  guint8 *data = g_malloc (size);
+  guint i;
+
+  GST_WRITE_UINT16_BE (data, size);
+  for (i = 2; i < size; i++)
+    data[i] = seed + i;
+
+  return data;
+}
+
+static GstBuffer *
+make_fragment (const guint8 * data, guint size, GstClockTime ts)
+{
+  GstBuffer *buf;
+
+  buf = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_fill (buf, 0, data, size);
+  GST_BUFFER_TIMESTAMP (buf) = ts;
+
+  return buf;
+}
+
+static void
+check_output (GstBuffer * buf, const guint8 * data, guint size,
+    GstClockTime ts)
+{
+  fail_unless_equals_int (gst_buffer_get_size (buf), size);
+  fail_unless (gst_buffer_memcmp (buf, 0, data, size) == 0);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf), ts);
+}
+
+static gboolean
+sink_query_allocation (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION)
+    return TRUE;
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+/* pushes a packet in three fragments, downstream gets it in @n_memory
+ * memories */
+static void
+check_fragmented (gboolean answer_allocation, guint n_memory)
+{
+  GstElement *parse;
+  guint8 *data;
+
+  parse = setup_dvdsubparse ();
+  if (answer_allocation)
+    gst_pad_set_query_function (mysinkpad, sink_query_allocation);
+
+  data = make_packet (3000, 1);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          make_fragment (data, 1000, GST_SECOND)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          make_fragment (data + 1000, 1000, GST_CLOCK_TIME_NONE)),
+      GST_FLOW_OK);
+  fail_unless (buffers == NULL);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          make_fragment (data + 2000, 1000, GST_CLOCK_TIME_NONE)),
+      GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_output (buffers->data, data, 3000, GST_SECOND);
+  fail_unless_equals_int (gst_buffer_n_memory (buffers->data), n_memory);
+
+  g_free (data);
+  cleanup_dvdsubparse (parse);
+}
+
+GST_START_TEST (test_fragmented)
+{
+  check_fragmented (FALSE, 1);
+}
+
+GST_END_TEST;
+
+/* downstream that answers the allocation query gets the fragments as they
+ * are */
+GST_START_TEST (test_fragmented_no_merge)
+{
+  check_fragmented (TRUE, 3);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_multiple_per_buffer)
+{
+  GstElement *parse;
+  guint8 *data;
+  guint8 *packets[3];
+  guint sizes[3] = { 100, 2000, 53 };
+  guint i, offset;
+
+  parse = setup_dvdsubparse ();
+
+  /* three complete packets and the start of a fourth in one buffer */
+  data = g_malloc0 (2253);
+  for (i = 0, offset = 0; i < 3; i++) {
+    packets[i] = make_packet (sizes[i], i);
+    memcpy (data + offset, packets[i], sizes[i]);
+    offset += sizes[i];
+  }
+  GST_WRITE_UINT16_BE (data + offset, 100);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          make_fragment (data, 2200, GST_SECOND)), GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  check_output (g_list_nth_data (buffers, 0), packets[0], sizes[0],
+      GST_SECOND);
+  check_output (g_list_nth_data (buffers, 1), packets[1], sizes[1],
+      GST_CLOCK_TIME_NONE);
+  check_output (g_list_nth_data (buffers, 2), packets[2], sizes[2],
+      GST_CLOCK_TIME_NONE);
+
+  /* the remainder of the fourth packet completes it */
+  gst_check_drop_buffers ();
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          make_fragment (data + 2200, 53, GST_CLOCK_TIME_NONE)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_output (buffers->data, data + offset, 100, GST_CLOCK_TIME_NONE);
+
+  for (i = 0; i < 3; i++)
+    g_free (packets[i]);
+  g_free (data);
+  cleanup_dvdsubparse (parse);
+}
+
+GST_END_TEST;
+
+#define N_PACKETS 20000
+#define N_FRAGMENTS 4
+
+/* Not a real benchmark, but gives an idea of the parse throughput with
+ * GST_DEBUG=check:4 */
+GST_START_TEST (test_parse_throughput)
+{
+  GstElement *parse;
+  GstBuffer *fragments[N_FRAGMENTS];
+  guint8 *data;
+  guint size = 4 * 1024, frag_size = size / N_FRAGMENTS;
+  gint64 start, elapsed;
+  guint i, j, count = 0;
+
+  parse = setup_dvdsubparse ();
+
+  data = make_packet (size, 0);
+  for (j = 0; j < N_FRAGMENTS; j++)
+    fragments[j] = make_fragment (data + j * frag_size, frag_size,
+        j == 0 ? 0 : GST_CLOCK_TIME_NONE);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_PACKETS; i++) {
+    for (j = 0; j < N_FRAGMENTS; j++) {
+      GstBuffer *buf = gst_buffer_copy (fragments[j]);
+
+      if (j == 0)
+        GST_BUFFER_TIMESTAMP (buf) = i * GST_SECOND;
+      fail_unless_equals_int (gst_pad_push (mysrcpad, buf), GST_FLOW_OK);
+    }
+    count += g_list_length (buffers);
+    gst_check_drop_buffers ();
+  }
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  fail_unless_equals_int (count, N_PACKETS);
+  GST_INFO ("parsed %u packets of %u fragments in %" G_GINT64_FORMAT
+      " us, %.0f packets/s", N_PACKETS, N_FRAGMENTS, elapsed,
+      N_PACKETS * (gdouble) G_USEC_PER_SEC / elapsed);
+
+  for (j = 0; j < N_FRAGMENTS; j++)
+    gst_buffer_unref (fragments[j]);
+  g_free (data);
+  cleanup_dvdsubparse (parse);
+}
+
+GST_END_TEST;
+
+static Suite *
+dvdsubparse_suite (void)
+{
+  Suite *s = suite_create ("dvdsubparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_fragmented);
+  tcase_add_test (tc_chain, test_fragmented_no_merge);
+  tcase_add_test (tc_chain, test_multiple_per_buffer);
+  tcase_add_test (tc_chain, test_parse_throughput);
+
+  return s;
+}
+
+GST_CHECK_MAIN (dvdsubparse);
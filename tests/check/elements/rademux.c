@@ -0,0 +1,285 @@
+/* GStreamer
+ *
+ * unit test for rademux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* the stream generator of the benchmarks */
+#include "mediagen.h"
+
+#include <string.h>
+
+#define PACKET_SIZE 768
+#define SAMPLE_RATE 48000
+#define HEIGHT 4
+#define N_BLOCKS 50
+#define N_PACKETS (N_BLOCKS * HEIGHT)
+/* 1536 samples per dnet packet */
+#define PACKET_DURATION (1536 * GST_SECOND / SAMPLE_RATE)
+#define BLOCK_DURATION (HEIGHT * PACKET_DURATION)
+
+static GstPad *mysrcpad, *mysinkpad;
+static GByteArray *file;
+
+static GMutex lock;
+static GCond cond;
+static gboolean have_eos;
+static GstSegment segment;
+static GstBuffer *first_buffer;
+static guint n_received;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-pn-realaudio")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* A RealAudio 4 dnet file, interleaved in blocks of HEIGHT packets */
+static GByteArray *
+make_file (void)
+{
+  GByteArray *a = g_byte_array_new ();
+  MediaGenRm gen;
+
+  fail_unless (media_gen_rm_init (&gen, "dnet"));
+  fail_unless_equals_int (gen.packet_size, PACKET_SIZE);
+  fail_unless_equals_int (gen.rate, SAMPLE_RATE);
+  gen.height = HEIGHT;
+  gen.n_blocks = N_BLOCKS;
+  fail_unless (media_gen_ra_write (&gen, media_gen_write_byte_array, a));
+
+  return a;
+}
+
+static GstFlowReturn
+src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  if (offset >= file->len)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, file->len - offset);
+  *buffer = gst_buffer_new_wrapped (g_memdup (file->data + offset, length),
+      length);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_SCHEDULING:
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      return TRUE;
+    case GST_QUERY_DURATION:
+      gst_query_set_duration (query, GST_FORMAT_BYTES, file->len);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  g_mutex_lock (&lock);
+  if (n_received++ == 0)
+    first_buffer = buf;
+  else
+    gst_buffer_unref (buf);
+  g_mutex_unlock (&lock);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  g_mutex_lock (&lock);
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &segment);
+      break;
+    case GST_EVENT_EOS:
+      have_eos = TRUE;
+      g_cond_signal (&cond);
+      break;
+    default:
+      break;
+  }
+  g_mutex_unlock (&lock);
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+pad_added (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  fail_unless (mysinkpad == NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, sink_chain);
+  gst_pad_set_event_function (mysinkpad, sink_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static void
+reset_received (void)
+{
+  have_eos = FALSE;
+  n_received = 0;
+  gst_buffer_replace (&first_buffer, NULL);
+}
+
+static void
+wait_for_eos (void)
+{
+  g_mutex_lock (&lock);
+  while (!have_eos)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+}
+
+static GstElement *
+setup_rademux (void)
+{
+  GstElement *demux;
+
+  file = make_file ();
+  reset_received ();
+
+  demux = gst_check_setup_element ("rademux");
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  gst_pad_set_getrange_function (mysrcpad, src_getrange);
+  gst_pad_set_query_function (mysrcpad, src_query);
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return demux;
+}
+
+static void
+cleanup_rademux (GstElement * demux)
+{
+  gst_element_set_state (demux, GST_STATE_NULL);
+
+  if (mysinkpad) {
+    gst_pad_set_active (mysinkpad, FALSE);
+    gst_object_unref (mysinkpad);
+    mysinkpad = NULL;
+  }
+  gst_check_teardown_src_pad (demux);
+  gst_check_teardown_element (demux);
+
+  reset_received ();
+  g_byte_array_unref (file);
+}
+
+static void
+do_seek (GstElement * demux, GstClockTime position, GstSeekFlags flags)
+{
+  GstPad *srcpad;
+
+  reset_received ();
+
+  srcpad = gst_element_get_static_pad (demux, "src");
+  fail_unless (gst_pad_send_event (srcpad, gst_event_new_seek (1.0,
+              GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH | flags, GST_SEEK_TYPE_SET,
+              position, GST_SEEK_TYPE_NONE, -1)));
+  gst_object_unref (srcpad);
+
+  wait_for_eos ();
+}
+
+/* checks that the output starts at the first packet of a block */
+static void
+check_block_start (guint block)
+{
+  guint8 payload[HEIGHT * PACKET_SIZE];
+  GstMapInfo map;
+
+  fail_unless (first_buffer != NULL);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (first_buffer),
+      block * BLOCK_DURATION);
+
+  media_gen_fill_payload (payload, sizeof (payload), block);
+  gst_buffer_map (first_buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, PACKET_SIZE);
+  fail_unless (memcmp (map.data, payload, PACKET_SIZE) == 0);
+  gst_buffer_unmap (first_buffer, &map);
+
+  fail_unless_equals_int (n_received, N_PACKETS - block * HEIGHT);
+}
+
+GST_START_TEST (test_seek_to_block)
+{
+  GstElement *demux;
+
+  demux = setup_rademux ();
+  wait_for_eos ();
+  fail_unless_equals_int (n_received, N_PACKETS);
+
+  /* in the middle of the third packet of block 7 */
+  do_seek (demux, 7 * BLOCK_DURATION + 5 * PACKET_DURATION / 2,
+      GST_SEEK_FLAG_NONE);
+  check_block_start (7);
+  /* the decoder clips the start of the block */
+  fail_unless_equals_uint64 (segment.start,
+      7 * BLOCK_DURATION + 5 * PACKET_DURATION / 2);
+
+  do_seek (demux, 12 * BLOCK_DURATION + PACKET_DURATION,
+      GST_SEEK_FLAG_KEY_UNIT);
+  check_block_start (12);
+  fail_unless_equals_uint64 (segment.start, 12 * BLOCK_DURATION);
+
+  /* past the end, to the start of the last block */
+  do_seek (demux, 10 * GST_SECOND, GST_SEEK_FLAG_KEY_UNIT);
+  check_block_start (N_BLOCKS - 1);
+
+  cleanup_rademux (demux);
+}
+
+GST_END_TEST;
+
+static Suite *
+rademux_suite (void)
+{
+  Suite *s = suite_create ("rademux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_seek_to_block);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rademux);
@@ -0,0 +1,236 @@
+/* GStreamer
+ *
+ * unit test for the RDT packet parsing of the realmedia plugin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <string.h>
+
+/* the RDT helpers are not exported by the plugin */
+#include "../../../gst/realmedia/gstrdtbuffer.c"
+
+/* writes a data packet to @data and returns its length */
+static guint
+write_data_packet (guint8 * data, gboolean with_length, gboolean reliable,
+    guint16 stream_id, guint16 seq, guint8 flags, guint32 timestamp,
+    const guint8 * payload, guint payload_size)
+{
+  guint8 short_id = MIN (stream_id, 31);
+  gboolean asm_expansion = (flags & 0x3f) == 63;
+  guint header, length;
+
+  length = 3 + (with_length ? 2 : 0) + 5 + (short_id == 31 ? 2 : 0) +
+      (reliable ? 2 : 0) + (asm_expansion ? 2 : 0) + payload_size;
+
+  data[0] = (with_length ? 0x80 : 0) | (reliable ? 0x40 : 0) | (short_id << 1);
+  GST_WRITE_UINT16_BE (&data[1], seq);
+  header = 3;
+  if (with_length) {
+    GST_WRITE_UINT16_BE (&data[header], length);
+    header += 2;
+  }
+  data[header] = flags;
+  GST_WRITE_UINT32_BE (&data[header + 1], timestamp);
+  header += 5;
+  if (short_id == 31) {
+    GST_WRITE_UINT16_BE (&data[header], stream_id);
+    header += 2;
+  }
+  if (reliable) {
+    GST_WRITE_UINT16_BE (&data[header], 1);
+    header += 2;
+  }
+  if (asm_expansion) {
+    GST_WRITE_UINT16_BE (&data[header], 100);
+    header += 2;
+  }
+  memcpy (&data[header], payload, payload_size);
+
+  return length;
+}
+
+static void
+check_data_packet (GstRDTPacket * packet, guint16 stream_id, guint16 seq,
+    guint8 flags, guint32 timestamp, const guint8 * payload,
+    guint payload_size)
+{
+  guint8 *data;
+  guint size;
+
+  fail_unless (GST_RDT_IS_DATA_TYPE (gst_rdt_packet_get_type (packet)));
+  fail_unless_equals_int (gst_rdt_packet_data_get_stream_id (packet),
+      stream_id);
+  fail_unless_equals_int (gst_rdt_packet_data_get_seq (packet), seq);
+  fail_unless_equals_int (gst_rdt_packet_data_get_flags (packet), flags);
+  fail_unless_equals_int (gst_rdt_packet_data_get_timestamp (packet),
+      timestamp);
+
+  data = gst_rdt_packet_data_map (packet, &size);
+  fail_unless_equals_int (size, payload_size);
+  fail_unless (memcmp (data, payload, size) == 0);
+  gst_rdt_packet_data_unmap (packet);
+}
+
+GST_START_TEST (test_data_packets)
+{
+  static const guint8 payload1[] = { 1, 2, 3, 4, 5 };
+  static const guint8 payload2[] = { 6, 7, 8 };
+  static const guint8 payload3[] = { 9, 10, 11, 12 };
+  guint8 *data;
+  guint size = 0;
+  GstBuffer *buf;
+  GstRDTPacket packet;
+
+  data = g_malloc (64);
+  size += write_data_packet (data + size, TRUE, FALSE, 0, 1, 0x01, 1000,
+      payload1, sizeof (payload1));
+  size += write_data_packet (data + size, TRUE, FALSE, 1, 2, 0x45, 2000,
+      payload2, sizeof (payload2));
+  /* without a length, the packet takes the rest of the buffer */
+  size += write_data_packet (data + size, FALSE, FALSE, 0, 3, 0x00, 3000,
+      payload3, sizeof (payload3));
+  buf = gst_buffer_new_wrapped (data, size);
+
+  fail_unless_equals_int (gst_rdt_buffer_get_packet_count (buf), 3);
+
+  fail_unless (gst_rdt_buffer_get_first_packet (buf, &packet));
+  check_data_packet (&packet, 0, 1, 0x01, 1000, payload1, sizeof (payload1));
+  fail_unless (gst_rdt_packet_move_to_next (&packet));
+  check_data_packet (&packet, 1, 2, 0x45, 2000, payload2, sizeof (payload2));
+  fail_unless (gst_rdt_packet_move_to_next (&packet));
+  check_data_packet (&packet, 0, 3, 0x00, 3000, payload3, sizeof (payload3));
+  fail_if (gst_rdt_packet_move_to_next (&packet));
+  /* the walk is over, there is nothing left to unmap */
+  gst_rdt_packet_unmap (&packet);
+
+  /* a walk that stops early */
+  fail_unless (gst_rdt_buffer_get_first_packet (buf, &packet));
+  check_data_packet (&packet, 0, 1, 0x01, 1000, payload1, sizeof (payload1));
+  gst_rdt_packet_unmap (&packet);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_data_packet_expansions)
+{
+  static const guint8 payload[] = { 0xde, 0xad, 0xbe, 0xef };
+  guint8 *data;
+  guint size;
+  GstBuffer *buf;
+  GstRDTPacket packet;
+
+  /* stream_id_expansion, total_reliable and asm_rule_number_expansion */
+  data = g_malloc (64);
+  size = write_data_packet (data, TRUE, TRUE, 40, 0xfe00, 0x3f, 0xdeadbeef,
+      payload, sizeof (payload));
+  buf = gst_buffer_new_wrapped (data, size);
+
+  fail_unless (gst_rdt_buffer_get_first_packet (buf, &packet));
+  check_data_packet (&packet, 40, 0xfe00, 0x3f, 0xdeadbeef, payload,
+      sizeof (payload));
+  fail_if (gst_rdt_packet_move_to_next (&packet));
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_truncated_header)
+{
+  static const guint8 payload[] = { 0 };
+  guint8 *data;
+  guint size;
+  GstBuffer *buf;
+  GstRDTPacket packet;
+
+  data = g_malloc (64);
+  size = write_data_packet (data, FALSE, FALSE, 0, 1, 0x00, 1000, payload,
+      sizeof (payload));
+
+  /* cut the packet in the middle of the timestamp */
+  buf = gst_buffer_new_wrapped (data, size - 4);
+  fail_if (gst_rdt_buffer_get_first_packet (buf, &packet));
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+#define N_PACKETS 64
+#define PAYLOAD_SIZE 200
+#define N_ITERATIONS 20000
+
+GST_START_TEST (test_parse_throughput)
+{
+  guint8 payload[PAYLOAD_SIZE] = { 0, };
+  guint8 *data;
+  guint i, size = 0, count = 0;
+  guint32 sum = 0;
+  gint64 start, elapsed;
+  GstBuffer *buf;
+  GstRDTPacket packet;
+
+  data = g_malloc (N_PACKETS * (PAYLOAD_SIZE + 12));
+  for (i = 0; i < N_PACKETS; i++)
+    size += write_data_packet (data + size, TRUE, FALSE, i % 2, i, 0x01,
+        i * 10, payload, PAYLOAD_SIZE);
+  buf = gst_buffer_new_wrapped (data, size);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ITERATIONS; i++) {
+    gboolean more;
+
+    more = gst_rdt_buffer_get_first_packet (buf, &packet);
+    while (more) {
+      sum += gst_rdt_packet_data_get_seq (&packet);
+      sum += gst_rdt_packet_data_get_stream_id (&packet);
+      sum += gst_rdt_packet_data_get_timestamp (&packet);
+      sum += gst_rdt_packet_data_get_flags (&packet);
+      count++;
+      more = gst_rdt_packet_move_to_next (&packet);
+    }
+  }
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  fail_unless_equals_int (count, N_PACKETS * N_ITERATIONS);
+  GST_INFO ("parsed %u packets in %" G_GINT64_FORMAT " us, %.1f ns/packet "
+      "(checksum %u)", count, elapsed, elapsed * 1000.0 / count, sum);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+static Suite *
+rdtbuffer_suite (void)
+{
+  Suite *s = suite_create ("rdtbuffer");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_data_packets);
+  tcase_add_test (tc_chain, test_data_packet_expansions);
+  tcase_add_test (tc_chain, test_truncated_header);
+  tcase_add_test (tc_chain, test_parse_throughput);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rdtbuffer);
@@ -0,0 +1,189 @@
+/* GStreamer
+ *
+ * unit test for the skew estimation of the RDT jitterbuffer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* the jitterbuffer is not exported by the plugin */
+#include "../../../gst/realmedia/gstrdtbuffer.c"
+#include "../../../gst/realmedia/rdtjitterbuffer.c"
+
+/* packets of 20 ms, with a clock-rate of 1000 */
+#define PACKET_MS 20
+#define PACKET_DURATION (PACKET_MS * GST_MSECOND)
+
+/* the receiver clock runs 500 ppm fast */
+#define DRIFT_PER_PACKET (PACKET_DURATION / 2000)
+/* the route changes at this packet and adds this much delay */
+#define STEP_PACKET 1500
+#define STEP_DELAY (30 * GST_MSECOND)
+#define N_PACKETS 3000
+#define MAX_JITTER (10 * GST_MSECOND)
+#define TOLERANCE (5 * GST_MSECOND)
+
+GST_START_TEST (test_window_min)
+{
+  RDTJitterBuffer *jbuf;
+  GRand *rand;
+  gint64 deltas[1000];
+  GstClockTime first = 0;
+  guint i, j, size = 16;
+
+  jbuf = rdt_jitter_buffer_new ();
+  g_object_set (jbuf, "window-size", size, "window-time",
+      (guint64) 3600 * GST_SECOND, NULL);
+
+  rand = g_rand_new_with_seed (1);
+  for (i = 0; i < G_N_ELEMENTS (deltas); i++) {
+    GstClockTime time;
+    gint64 min = G_MAXINT64;
+
+    time = GST_SECOND + i * PACKET_DURATION +
+        g_rand_int_range (rand, 0, 50) * GST_MSECOND;
+    if (i == 0)
+      first = time;
+    deltas[i] = (gint64) (time - first) - (gint64) (i * PACKET_DURATION);
+
+    calculate_skew (jbuf, i * PACKET_MS, time, 1000);
+
+    /* the minimum of the last measurements, all of them while filling */
+    for (j = (i >= size ? i - size + 1 : 0); j <= i; j++)
+      min = MIN (min, deltas[j]);
+
+    fail_unless (jbuf->window_len <= size);
+    fail_unless_equals_int64 (jbuf->window[jbuf->window_head].delta, min);
+  }
+  g_rand_free (rand);
+
+  g_object_unref (jbuf);
+}
+
+GST_END_TEST;
+
+/* runs the drift trace and returns after how many packets the skew followed
+ * the route change */
+static guint
+run_drift_trace (RDTJitterBuffer * jbuf)
+{
+  GRand *rand;
+  guint i, converged = 0;
+
+  rand = g_rand_new_with_seed (42);
+  for (i = 0; i < N_PACKETS; i++) {
+    GstClockTime time;
+    gint64 drift;
+
+    drift = i * DRIFT_PER_PACKET + (i >= STEP_PACKET ? STEP_DELAY : 0);
+    time = GST_SECOND + i * PACKET_DURATION + drift;
+    if (i > 0)
+      time += g_rand_int_range (rand, 0, MAX_JITTER / GST_USECOND) *
+          GST_USECOND;
+
+    calculate_skew (jbuf, i * PACKET_MS, time, 1000);
+
+    /* follows the drift of the clock */
+    if (i == STEP_PACKET - 1)
+      fail_unless (ABS (jbuf->skew - drift) < TOLERANCE,
+          "skew %" G_GINT64_FORMAT " drift %" G_GINT64_FORMAT, jbuf->skew,
+          drift);
+
+    if (i >= STEP_PACKET) {
+      if (ABS (jbuf->skew - drift) >= TOLERANCE)
+        converged = 0;
+      else if (converged == 0)
+        converged = i - STEP_PACKET + 1;
+    }
+  }
+  g_rand_free (rand);
+
+  fail_unless (converged > 0, "skew did not converge");
+
+  return converged;
+}
+
+GST_START_TEST (test_drift)
+{
+  RDTJitterBuffer *jbuf;
+  guint slow, fast, small;
+
+  jbuf = rdt_jitter_buffer_new ();
+  slow = run_drift_trace (jbuf);
+
+  /* a lighter averaging follows faster, setting it starts again */
+  g_object_set (jbuf, "skew-weight", 8, NULL);
+  fast = run_drift_trace (jbuf);
+
+  /* and a smaller window faster still */
+  g_object_set (jbuf, "window-time", (guint64) 500 * GST_MSECOND, NULL);
+  small = run_drift_trace (jbuf);
+
+  GST_INFO ("converged after %u, %u and %u packets", slow, fast, small);
+
+  /* the old minimum has to leave the 2 second window first */
+  fail_unless (slow > 2 * GST_SECOND / PACKET_DURATION);
+  fail_unless (fast < slow / 2);
+  fail_unless (small < fast);
+
+  g_object_unref (jbuf);
+}
+
+GST_END_TEST;
+
+/* Increasing deltas, the minimum leaves the window with every packet. A
+ * linear search for the new minimum makes this quadratic in the window
+ * size. */
+GST_START_TEST (test_window_cost)
+{
+  RDTJitterBuffer *jbuf;
+  gint64 start, elapsed;
+  guint i;
+
+  jbuf = rdt_jitter_buffer_new ();
+  g_object_set (jbuf, "window-size", G_MAXUINT16, "window-time",
+      (guint64) 3600 * GST_SECOND, NULL);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 100000; i++)
+    calculate_skew (jbuf, i * PACKET_MS,
+        GST_SECOND + i * (PACKET_DURATION + GST_USECOND), 1000);
+  elapsed = g_get_monotonic_time () - start;
+
+  GST_INFO ("100000 packets in %" G_GINT64_FORMAT " us", elapsed);
+  fail_unless_equals_int (jbuf->window_len, G_MAXUINT16);
+
+  g_object_unref (jbuf);
+}
+
+GST_END_TEST;
+
+static Suite *
+rdtjitterbuffer_suite (void)
+{
+  Suite *s = suite_create ("rdtjitterbuffer");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_window_min);
+  tcase_add_test (tc_chain, test_drift);
+  tcase_add_test (tc_chain, test_window_cost);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rdtjitterbuffer);
@@ -0,0 +1,430 @@
+/* GStreamer
+ *
+ * unit test for rdtmanager
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+
+#include <string.h>
+
+#define PACKET_SIZE 100
+
+static GstPad *mysrcpad, *mysinkpad, *myrtcpsinkpad;
+
+static GMutex lock;
+static GCond cond;
+static guint n_received;
+/* the sequence numbers of the buffers and whether they were marked DISCONT */
+static guint16 received_seqs[16];
+static gboolean received_discont[16];
+static GstStructure *lost;
+/* makes the sink hold on to the first buffer */
+static gboolean block_sink;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rdt")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstCaps *
+request_pt_map (GstElement * manager, guint session, guint pt,
+    gpointer user_data)
+{
+  return gst_caps_from_string ("application/x-rdt, clock-rate=(int)1000");
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstMapInfo map;
+
+  g_mutex_lock (&lock);
+  if (n_received < G_N_ELEMENTS (received_seqs)) {
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    received_seqs[n_received] = GST_READ_UINT16_BE (map.data + 1);
+    gst_buffer_unmap (buf, &map);
+    received_discont[n_received] = GST_BUFFER_IS_DISCONT (buf);
+  }
+  n_received++;
+  g_cond_broadcast (&cond);
+  while (block_sink)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (gst_event_has_name (event, "GstRDTPacketLost")) {
+    g_mutex_lock (&lock);
+    fail_unless (lost == NULL);
+    lost = gst_structure_copy (gst_event_get_structure (event));
+    g_mutex_unlock (&lock);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+pad_added (GstElement * manager, GstPad * pad, gpointer user_data)
+{
+  fail_unless (mysinkpad == NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, sink_chain);
+  gst_pad_set_event_function (mysinkpad, sink_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static GstElement *
+setup_rdtmanager (void)
+{
+  GstElement *manager;
+  GstPad *sinkpad;
+  GstCaps *caps;
+
+  n_received = 0;
+  block_sink = FALSE;
+
+  manager = gst_check_setup_element ("rdtmanager");
+  g_signal_connect (manager, "request-pt-map", G_CALLBACK (request_pt_map),
+      NULL);
+  g_signal_connect (manager, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  sinkpad = gst_element_get_request_pad (manager, "recv_rtp_sink_0");
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  fail_unless (gst_element_set_state (manager,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string ("application/x-rdt, clock-rate=(int)1000");
+  gst_check_setup_events (mysrcpad, manager, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  return manager;
+}
+
+static void
+cleanup_rdtmanager (GstElement * manager)
+{
+  g_mutex_lock (&lock);
+  block_sink = FALSE;
+  g_cond_broadcast (&cond);
+  g_mutex_unlock (&lock);
+
+  gst_element_set_state (manager, GST_STATE_NULL);
+
+  if (mysinkpad) {
+    gst_pad_set_active (mysinkpad, FALSE);
+    gst_object_unref (mysinkpad);
+    mysinkpad = NULL;
+  }
+  if (myrtcpsinkpad) {
+    gst_pad_set_active (myrtcpsinkpad, FALSE);
+    gst_object_unref (myrtcpsinkpad);
+    myrtcpsinkpad = NULL;
+  }
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_object_unref (mysrcpad);
+  mysrcpad = NULL;
+  gst_check_teardown_element (manager);
+
+  if (lost) {
+    gst_structure_free (lost);
+    lost = NULL;
+  }
+}
+
+static void
+wait_for_received (guint n)
+{
+  g_mutex_lock (&lock);
+  while (n_received < n)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+}
+
+/* pushes a data packet of stream 0 with a timestamp of @ts ms that arrives at
+ * @arrival */
+static void
+push_packet (guint16 seq, guint32 ts, GstClockTime arrival)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  map.data[0] = 0x80;
+  GST_WRITE_UINT16_BE (map.data + 1, seq);
+  GST_WRITE_UINT16_BE (map.data + 3, PACKET_SIZE);
+  GST_WRITE_UINT32_BE (map.data + 6, ts);
+  gst_buffer_unmap (buf, &map);
+  GST_BUFFER_PTS (buf) = arrival;
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, buf), GST_FLOW_OK);
+}
+
+static GstStructure *
+get_session_stats (GstElement * manager)
+{
+  GstStructure *stats, *result;
+  const GValue *sessions;
+
+  g_object_get (manager, "stats", &stats, NULL);
+  sessions = gst_structure_get_value (stats, "sessions");
+  fail_unless_equals_int (gst_value_array_get_size (sessions), 1);
+  result = gst_structure_copy (gst_value_get_structure
+      (gst_value_array_get_value (sessions, 0)));
+  gst_structure_free (stats);
+
+  return result;
+}
+
+static void
+check_stats_uint64 (const GstStructure * s, const gchar * field,
+    guint64 expected)
+{
+  guint64 val;
+
+  fail_unless (gst_structure_get_uint64 (s, field, &val), "no %s", field);
+  fail_unless_equals_uint64 (val, expected);
+}
+
+GST_START_TEST (test_stats)
+{
+  static const guint16 seqs[] = { 1, 2, 4, 5, 3, 5, 0, 7 };
+  GstElement *manager;
+  GstStructure *stats;
+  GstMessage *msg;
+  GstBus *bus;
+  guint64 jitter;
+  guint i, depth;
+
+  manager = setup_rdtmanager ();
+  bus = gst_bus_new ();
+  gst_element_set_bus (manager, bus);
+  g_object_set (manager, "stats-interval", 100, NULL);
+
+  /* the first packet goes out and the sink keeps it, the others stay in the
+   * jitterbuffer */
+  block_sink = TRUE;
+  push_packet (0, 0, 100 * GST_MSECOND);
+  wait_for_received (1);
+
+  /* a 3 that is out of order, a second 5, a 0 that is late and no 6. Packet
+   * 4 arrives 16 ms after the others */
+  for (i = 0; i < G_N_ELEMENTS (seqs); i++) {
+    GstClockTime arrival = (100 + 20 * (i + 1)) * GST_MSECOND;
+
+    if (seqs[i] == 4)
+      arrival += 16 * GST_MSECOND;
+    push_packet (seqs[i], seqs[i] * 20, arrival);
+  }
+
+  stats = get_session_stats (manager);
+  GST_INFO ("%" GST_PTR_FORMAT, stats);
+  check_stats_uint64 (stats, "packets-received", 7);
+  check_stats_uint64 (stats, "bytes-received", 7 * PACKET_SIZE);
+  check_stats_uint64 (stats, "packets-lost", 1);
+  check_stats_uint64 (stats, "packets-late", 1);
+  check_stats_uint64 (stats, "packets-duplicate", 1);
+  check_stats_uint64 (stats, "packets-reordered", 1);
+  fail_unless (gst_structure_get_uint (stats, "max-reorder-depth", &depth));
+  fail_unless_equals_int (depth, 2);
+  fail_unless (gst_structure_get_uint64 (stats, "jitter", &jitter));
+  fail_unless (jitter > 0 && jitter < 16 * GST_MSECOND);
+  gst_structure_free (stats);
+
+  /* posted after 100 ms of data */
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  fail_unless (gst_structure_has_name (gst_message_get_structure (msg),
+          "application/x-rdt-session-stats"));
+  gst_message_unref (msg);
+
+  gst_element_set_bus (manager, NULL);
+  gst_object_unref (bus);
+  cleanup_rdtmanager (manager);
+}
+
+GST_END_TEST;
+
+/* releases the next packet at @deadline ms */
+static void
+crank_deadline (GstTestClock * clock, guint deadline)
+{
+  GstClockID id;
+
+  gst_test_clock_wait_for_next_pending_id (clock, &id);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id),
+      deadline * GST_MSECOND);
+  gst_clock_id_unref (id);
+  fail_unless (gst_test_clock_crank (clock));
+}
+
+GST_START_TEST (test_deadline)
+{
+  GstElement *manager;
+  GstClock *clock;
+  GstStructure *stats;
+  guint seqnum, count;
+  guint64 timestamp;
+
+  manager = setup_rdtmanager ();
+  clock = gst_test_clock_new ();
+  gst_element_set_clock (manager, clock);
+  g_object_set (manager, "latency", 100, "do-lost", TRUE, NULL);
+
+  /* 2 is missing */
+  push_packet (0, 0, 0);
+  push_packet (1, 20, 20 * GST_MSECOND);
+  push_packet (3, 60, 60 * GST_MSECOND);
+
+  /* every packet waits for latency after it was received */
+  crank_deadline (GST_TEST_CLOCK (clock), 100);
+  wait_for_received (1);
+  fail_unless_equals_int (received_seqs[0], 0);
+  crank_deadline (GST_TEST_CLOCK (clock), 120);
+  wait_for_received (2);
+  fail_unless_equals_int (received_seqs[1], 1);
+  fail_unless (lost == NULL);
+
+  /* 2 did not arrive before 3 was due */
+  crank_deadline (GST_TEST_CLOCK (clock), 160);
+  wait_for_received (3);
+  fail_unless_equals_int (received_seqs[2], 3);
+  fail_unless (received_discont[2]);
+
+  fail_unless (lost != NULL);
+  fail_unless (gst_structure_get_uint (lost, "seqnum", &seqnum));
+  fail_unless_equals_int (seqnum, 2);
+  fail_unless (gst_structure_get_uint (lost, "count", &count));
+  fail_unless_equals_int (count, 1);
+  fail_unless (gst_structure_get_uint64 (lost, "timestamp", &timestamp));
+  fail_unless_equals_uint64 (timestamp, 60 * GST_MSECOND);
+
+  /* and is dropped when it comes after all */
+  push_packet (2, 40, 170 * GST_MSECOND);
+  stats = get_session_stats (manager);
+  check_stats_uint64 (stats, "packets-received", 3);
+  check_stats_uint64 (stats, "packets-lost", 1);
+  check_stats_uint64 (stats, "packets-late", 1);
+  gst_structure_free (stats);
+  fail_unless_equals_int (n_received, 3);
+
+  cleanup_rdtmanager (manager);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+static GList *reports;
+
+static GstFlowReturn
+rtcp_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  reports = g_list_append (reports, buf);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_reports)
+{
+  GstElement *manager;
+  GstPad *rtcpsrc;
+  GstMapInfo map;
+  guint16 seq;
+
+  manager = setup_rdtmanager ();
+  g_object_set (manager, "report-interval", 1000, NULL);
+
+  rtcpsrc = gst_element_get_request_pad (manager, "rtcp_src_0");
+  myrtcpsinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (myrtcpsinkpad, rtcp_sink_chain);
+  gst_pad_set_active (myrtcpsinkpad, TRUE);
+  fail_unless (gst_pad_link (rtcpsrc, myrtcpsinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (rtcpsrc);
+
+  /* 6 is missing, a report is due when 10 arrives */
+  for (seq = 0; seq <= 10; seq++) {
+    if (seq != 6)
+      push_packet (seq, seq * 100, seq * 100 * GST_MSECOND);
+  }
+  fail_unless_equals_int (g_list_length (reports), 2);
+
+  /* the ACK for 0 to 10 */
+  gst_buffer_map (reports->data, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 13);
+  fail_unless_equals_int (map.data[0], 0xc0);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 1), 0xff02);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 3), 13);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 5), 0);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 7), 10);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 9), 11);
+  fail_unless_equals_int (map.data[11], 0x02);
+  fail_unless_equals_int (map.data[12], 0x00);
+  gst_buffer_unmap (reports->data, &map);
+
+  /* the latency report with the timestamp of 10 */
+  gst_buffer_map (reports->next->data, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 9);
+  fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 1), 0xff08);
+  fail_unless_equals_int (GST_READ_UINT32_BE (map.data + 5), 1000);
+  gst_buffer_unmap (reports->next->data, &map);
+
+  g_list_free_full (reports, (GDestroyNotify) gst_buffer_unref);
+  reports = NULL;
+
+  cleanup_rdtmanager (manager);
+}
+
+GST_END_TEST;
+
+static Suite *
+rdtmanager_suite (void)
+{
+  Suite *s = suite_create ("rdtmanager");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_stats);
+  tcase_add_test (tc_chain, test_reports);
+  tcase_add_test (tc_chain, test_deadline);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rdtmanager);
@@ -0,0 +1,326 @@
+/* GStreamer
+ *
+ * unit test for rmdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* the stream generator of the benchmarks */
+#include "mediagen.h"
+
+#include <string.h>
+
+#define N_BLOCKS 8
+#define CHUNK_SIZE 4096
+/* a bit more than three cook packets, so that a packet straddles the end of
+ * every window */
+#define READ_AHEAD 2000
+
+static GstPad *mysrcpad, *mysinkpad;
+/* everything the audio pad pushed, in order */
+static GByteArray *received;
+
+/* the file that the source pad serves in pull mode */
+static GByteArray *pull_file;
+static GMutex eos_lock;
+static GCond eos_cond;
+static gboolean have_eos;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/vnd.rn-realmedia")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  g_byte_array_append (received, map.data, map.size);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    g_mutex_lock (&eos_lock);
+    have_eos = TRUE;
+    g_cond_signal (&eos_cond);
+    g_mutex_unlock (&eos_lock);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+pad_added (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  fail_unless (mysinkpad == NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, sink_chain);
+  gst_pad_set_event_function (mysinkpad, sink_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static GstElement *
+setup_rmdemux (void)
+{
+  GstElement *demux;
+  GstCaps *caps;
+
+  mysinkpad = NULL;
+  received = g_byte_array_new ();
+
+  demux = gst_check_setup_element ("rmdemux");
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  caps = gst_caps_from_string ("application/vnd.rn-realmedia");
+  gst_check_setup_events (mysrcpad, demux, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return demux;
+}
+
+static void
+cleanup_rmdemux (GstElement * demux)
+{
+  gst_element_set_state (demux, GST_STATE_NULL);
+
+  if (mysinkpad) {
+    gst_pad_set_active (mysinkpad, FALSE);
+    gst_object_unref (mysinkpad);
+    mysinkpad = NULL;
+  }
+  g_byte_array_unref (received);
+  received = NULL;
+  pull_file = NULL;
+
+  gst_check_teardown_src_pad (demux);
+  gst_check_teardown_element (demux);
+}
+
+static gboolean
+src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) != GST_QUERY_SCHEDULING)
+    return gst_pad_query_default (pad, parent, query);
+
+  gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+  gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  if (offset >= pull_file->len)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, pull_file->len - offset);
+  *buffer = gst_buffer_new_wrapped (g_memdup (pull_file->data + offset,
+          length), length);
+
+  return GST_FLOW_OK;
+}
+
+/* rmdemux pulling @file through a source pad that only does pull mode, in
+ * windows of @read_ahead bytes */
+static GstElement *
+setup_rmdemux_pull (GByteArray * file, guint read_ahead)
+{
+  GstElement *demux;
+
+  mysinkpad = NULL;
+  received = g_byte_array_new ();
+  pull_file = file;
+  have_eos = FALSE;
+
+  demux = gst_check_setup_element ("rmdemux");
+  g_object_set (demux, "read-ahead", read_ahead, NULL);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  mysrcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  gst_pad_set_query_function (mysrcpad, src_query);
+  gst_pad_set_getrange_function (mysrcpad, src_getrange);
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE,
+      "could not set to playing");
+  fail_unless_equals_int (GST_PAD_MODE (mysrcpad), GST_PAD_MODE_PULL);
+
+  return demux;
+}
+
+static void
+wait_for_eos (void)
+{
+  g_mutex_lock (&eos_lock);
+  while (!have_eos)
+    g_cond_wait (&eos_cond, &eos_lock);
+  g_mutex_unlock (&eos_lock);
+}
+
+/* every block of @gen has to come out as the payload it was made from */
+static void
+check_received (const MediaGenRm * gen)
+{
+  guint8 *payload;
+  gsize block_size;
+  guint64 n;
+
+  block_size = gen->height * gen->packet_size;
+  fail_unless_equals_int (received->len, N_BLOCKS * block_size);
+
+  payload = g_malloc (block_size);
+  for (n = 0; n < N_BLOCKS; n++) {
+    media_gen_fill_payload (payload, block_size, n);
+    fail_unless (memcmp (received->data + n * block_size, payload,
+            block_size) == 0, "block %u of %s differs", (guint) n,
+        gen->fourcc);
+  }
+  g_free (payload);
+}
+
+/* Pushes N_BLOCKS scrambled interleaving blocks of @fourcc in chunks and
+ * checks that every block comes out as the payload it was made from. */
+static void
+check_descramble (const gchar * fourcc)
+{
+  GstElement *demux;
+  GByteArray *file;
+  MediaGenRm gen;
+  guint offset;
+
+  fail_unless (media_gen_rm_init (&gen, fourcc));
+  gen.n_blocks = N_BLOCKS;
+
+  file = g_byte_array_new ();
+  fail_unless (media_gen_rm_write (&gen, media_gen_write_byte_array, file));
+
+  demux = setup_rmdemux ();
+
+  for (offset = 0; offset < file->len; offset += CHUNK_SIZE) {
+    guint size = MIN (CHUNK_SIZE, file->len - offset);
+
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_new_wrapped (g_memdup (file->data + offset, size),
+                size)), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  fail_unless (mysinkpad != NULL);
+
+  check_received (&gen);
+
+  cleanup_rmdemux (demux);
+  g_byte_array_unref (file);
+}
+
+GST_START_TEST (test_descramble_dnet)
+{
+  check_descramble ("dnet");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_descramble_cook)
+{
+  check_descramble ("cook");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_descramble_atrc)
+{
+  check_descramble ("atrc");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_descramble_sipr)
+{
+  check_descramble ("sipr");
+}
+
+GST_END_TEST;
+
+/* the packets that straddle the end of a read-ahead window are read again
+ * at the start of the next one */
+GST_START_TEST (test_pull_read_ahead)
+{
+  GstElement *demux;
+  GByteArray *file;
+  MediaGenRm gen;
+
+  fail_unless (media_gen_rm_init (&gen, "cook"));
+  gen.n_blocks = N_BLOCKS;
+
+  file = g_byte_array_new ();
+  fail_unless (media_gen_rm_write (&gen, media_gen_write_byte_array, file));
+
+  demux = setup_rmdemux_pull (file, READ_AHEAD);
+  wait_for_eos ();
+  fail_unless (mysinkpad != NULL);
+
+  check_received (&gen);
+
+  cleanup_rmdemux (demux);
+  g_byte_array_unref (file);
+}
+
+GST_END_TEST;
+
+static Suite *
+rmdemux_suite (void)
+{
+  Suite *s = suite_create ("rmdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_descramble_dnet);
+  tcase_add_test (tc_chain, test_descramble_cook);
+  tcase_add_test (tc_chain, test_descramble_atrc);
+  tcase_add_test (tc_chain, test_descramble_sipr);
+  tcase_add_test (tc_chain, test_pull_read_ahead);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rmdemux);
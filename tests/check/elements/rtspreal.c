@@ -0,0 +1,635 @@
+/* GStreamer
+ *
+ * unit test for the ASM rule selection of rtspreal
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtsp/gstrtspconnection.h>
+#include <gst/rtsp/gstrtspextension.h>
+#include <gst/sdp/gstsdpmessage.h>
+
+#include <string.h>
+
+#define PACKET_SIZE 500
+
+/* the server offers three bitrates of every stream */
+#define RULEBOOK \
+  "#($Bandwidth < 67959),TimestampDelivery=T,DropByN=T,priority=9;" \
+  "#($Bandwidth >= 67959) && ($Bandwidth < 167959),AverageBandwidth=67959," \
+      "Priority=9;" \
+  "#($Bandwidth >= 67959) && ($Bandwidth < 167959),AverageBandwidth=0," \
+      "Priority=5;" \
+  "#($Bandwidth >= 167959) && ($Bandwidth < 267959)," \
+      "AverageBandwidth=167959,Priority=9;" \
+  "#($Bandwidth >= 167959) && ($Bandwidth < 267959),AverageBandwidth=0," \
+      "Priority=5;" \
+  "#($Bandwidth >= 267959),AverageBandwidth=267959,Priority=9;" \
+  "#($Bandwidth >= 267959),AverageBandwidth=0,Priority=5;"
+
+#define SDP_HEADER(n_streams) \
+  "v=0\r\n" \
+  "o=- 1 1 IN IP4 127.0.0.1\r\n" \
+  "s=rtspreal test\r\n" \
+  "c=IN IP4 127.0.0.1\r\n" \
+  "t=0 0\r\n" \
+  "a=IsRealDataType:integer;1\r\n" \
+  "a=StreamCount:integer;" n_streams "\r\n"
+
+#define SDP_MEDIA(id, opaque_data) \
+  "m=audio 0 RTP/AVP 101\r\n" \
+  "a=rtpmap:101 x-pn-realaudio/1000\r\n" \
+  "a=control:streamid=" id "\r\n" \
+  "a=AvgBitRate:integer;67959\r\n" \
+  "a=MaxBitRate:integer;267959\r\n" \
+  "a=StreamName:string;\"audio\"\r\n" \
+  "a=mimetype:string;\"audio/x-pn-realaudio\"\r\n" \
+  "a=ASMRuleBook:string;\"" RULEBOOK "\"\r\n" \
+  "a=OpaqueData:buffer;\"" opaque_data "\"\r\n"
+
+#define SDP(opaque_data) \
+  SDP_HEADER ("1") SDP_MEDIA ("0", opaque_data)
+
+/* the rules of every bitrate have the same type specific data */
+#define OPAQUE_DATA "AAAAAA=="
+
+/* an MLTI table where the rules of 67959 bits/s use codec 0 and the others
+ * codec 1, with "AAAA" and "BBBB" as type specific data */
+#define MLTI_OPAQUE_DATA "TUxUSQAHAAAAAAAAAAEAAQABAAEAAgAAAARBQUFBAAAABEJCQkI="
+
+static GstPad *mysrcpads[2], *mysinkpads[2];
+static guint n_srcpads, n_sinkpads;
+/* the bodies of the set-parameter requests of rdtmanager */
+static GAsyncQueue *parameters;
+
+/* the stand-in server, it logs the requests it gets to the queue */
+static GSocket *listen_socket;
+static GThread *server_thread;
+static GAsyncQueue *server_log;
+static const gchar *server_sdp;
+
+static GstRTSPConnection *client;
+static GstRTSPUrl *url;
+static GstCaps *stream_caps;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rdt")
+    );
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static void
+server_handle_request (GstRTSPConnection * conn, GstRTSPMessage * request)
+{
+  GstRTSPMessage response = { 0 };
+  GstRTSPMethod method;
+  const gchar *uri;
+  gchar *value = NULL;
+
+  gst_rtsp_message_parse_request (request, &method, &uri, NULL);
+  gst_rtsp_message_init_response (&response, GST_RTSP_STS_OK, NULL, request);
+
+  switch (method) {
+    case GST_RTSP_OPTIONS:
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_SERVER,
+          "RealServer Version 6.1.3.970 (linux-2.0-libc6-i386)");
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_REAL_CHALLENGE1,
+          "3a5f4e8c0b2c7d6e9f1a2b3c4d5e6f70");
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_PUBLIC,
+          "OPTIONS, DESCRIBE, SETUP, PLAY, SET_PARAMETER, TEARDOWN");
+      break;
+    case GST_RTSP_DESCRIBE:
+      gst_rtsp_message_get_header (request, GST_RTSP_HDR_BANDWIDTH, &value, 0);
+      g_async_queue_push (server_log, g_strdup_printf ("DESCRIBE %s",
+              GST_STR_NULL (value)));
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_CONTENT_TYPE,
+          "application/sdp");
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_ETAG, "rtspreal");
+      gst_rtsp_message_set_body (&response, (const guint8 *) server_sdp,
+          strlen (server_sdp));
+      break;
+    case GST_RTSP_SET_PARAMETER:
+    {
+      guint8 *body;
+      guint size;
+
+      /* the rules are moved to the Subscribe header by rtspreal */
+      gst_rtsp_message_get_body (request, &body, &size);
+      fail_unless_equals_int (size, 0);
+
+      gst_rtsp_message_get_header (request, GST_RTSP_HDR_SUBSCRIBE, &value, 0);
+      g_async_queue_push (server_log, g_strdup_printf ("SET_PARAMETER %s",
+              GST_STR_NULL (value)));
+      break;
+    }
+    default:
+      gst_rtsp_message_unset (&response);
+      gst_rtsp_message_init_response (&response,
+          GST_RTSP_STS_METHOD_NOT_ALLOWED, NULL, request);
+      break;
+  }
+
+  fail_unless_equals_int (gst_rtsp_connection_send (conn, &response, NULL),
+      GST_RTSP_OK);
+  gst_rtsp_message_unset (&response);
+}
+
+static gpointer
+server_func (gpointer user_data)
+{
+  GstRTSPConnection *conn;
+  GSocket *socket;
+  GstRTSPMessage request = { 0 };
+
+  socket = g_socket_accept (listen_socket, NULL, NULL);
+  fail_unless (socket != NULL);
+  fail_unless_equals_int (gst_rtsp_connection_create_from_socket (socket,
+          "127.0.0.1", 0, NULL, &conn), GST_RTSP_OK);
+  g_object_unref (socket);
+
+  /* until the client goes away */
+  while (gst_rtsp_connection_receive (conn, &request, NULL) == GST_RTSP_OK) {
+    if (request.type == GST_RTSP_MESSAGE_REQUEST)
+      server_handle_request (conn, &request);
+    gst_rtsp_message_unset (&request);
+  }
+  gst_rtsp_message_unset (&request);
+
+  gst_rtsp_connection_free (conn);
+
+  return NULL;
+}
+
+static void
+start_server (void)
+{
+  GInetAddress *inet;
+  GSocketAddress *addr, *bound;
+  gchar *str;
+
+  listen_socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  fail_unless (listen_socket != NULL);
+
+  inet = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (inet, 0);
+  fail_unless (g_socket_bind (listen_socket, addr, TRUE, NULL));
+  fail_unless (g_socket_listen (listen_socket, NULL));
+  g_object_unref (addr);
+  g_object_unref (inet);
+
+  bound = g_socket_get_local_address (listen_socket, NULL);
+  str = g_strdup_printf ("rtsp://127.0.0.1:%u/test.rm",
+      g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound)));
+  g_object_unref (bound);
+  fail_unless_equals_int (gst_rtsp_url_parse (str, &url), GST_RTSP_OK);
+  g_free (str);
+
+  server_log = g_async_queue_new_full (g_free);
+  server_thread = g_thread_new ("rtsp-server", server_func, NULL);
+}
+
+static void
+stop_server (void)
+{
+  g_thread_join (server_thread);
+  g_object_unref (listen_socket);
+  g_async_queue_unref (server_log);
+  gst_rtsp_url_free (url);
+}
+
+/* the next request the server got, without waiting */
+static void
+check_server_log (const gchar * expected)
+{
+  gchar *str = g_async_queue_try_pop (server_log);
+
+  fail_unless_equals_string (str, expected);
+  g_free (str);
+}
+
+/* what rtspsrc does to send a request of an extension */
+static GstRTSPResult
+send_cb (GstRTSPExtension * ext, GstRTSPMessage * request,
+    GstRTSPMessage * response, gpointer user_data)
+{
+  GstRTSPResult res;
+
+  if ((res = gst_rtsp_connection_send (client, request, NULL)) < 0)
+    return res;
+
+  return gst_rtsp_connection_receive (client, response, NULL);
+}
+
+static void
+client_request (GstRTSPExtension * ext, GstRTSPMethod method,
+    const gchar * body, GstRTSPMessage * response)
+{
+  GstRTSPMessage request = { 0 };
+  gchar *req_url;
+
+  req_url = gst_rtsp_url_get_request_uri (url);
+  gst_rtsp_message_init_request (&request, method, req_url);
+  g_free (req_url);
+  if (body) {
+    gst_rtsp_message_add_header (&request, GST_RTSP_HDR_CONTENT_TYPE,
+        "text/parameters");
+    gst_rtsp_message_set_body (&request, (const guint8 *) body,
+        strlen (body));
+  }
+
+  fail_unless_equals_int (gst_rtsp_extension_before_send (ext, &request),
+      GST_RTSP_OK);
+  fail_unless_equals_int (send_cb (ext, &request, response, NULL),
+      GST_RTSP_OK);
+  fail_unless_equals_int (gst_rtsp_extension_after_send (ext, &request,
+          response), GST_RTSP_OK);
+
+  gst_rtsp_message_unset (&request);
+}
+
+/* OPTIONS, DESCRIBE of @sdp and the initial subscription, like rtspsrc */
+static GstElement *
+setup_rtspreal (const gchar * sdp_text)
+{
+  GstElement *real;
+  GstRTSPExtension *ext;
+  GstRTSPMessage response = { 0 };
+  GstSDPMessage *sdp;
+  GstStructure *props;
+  guint8 *body;
+  guint size;
+
+  server_sdp = sdp_text;
+  start_server ();
+
+  fail_unless_equals_int (gst_rtsp_connection_create (url, &client),
+      GST_RTSP_OK);
+  fail_unless_equals_int (gst_rtsp_connection_connect (client, NULL),
+      GST_RTSP_OK);
+
+  real = gst_element_factory_make ("rtspreal", NULL);
+  fail_unless (real != NULL);
+  ext = GST_RTSP_EXTENSION (real);
+  g_signal_connect (real, "send", G_CALLBACK (send_cb), NULL);
+
+  client_request (ext, GST_RTSP_OPTIONS, NULL, &response);
+  gst_rtsp_message_unset (&response);
+
+  client_request (ext, GST_RTSP_DESCRIBE, NULL, &response);
+  check_server_log ("DESCRIBE 10485800");
+  gst_rtsp_message_get_body (&response, &body, &size);
+  gst_sdp_message_new (&sdp);
+  fail_unless_equals_int (gst_sdp_message_parse_buffer (body, size, sdp),
+      GST_SDP_OK);
+  gst_rtsp_message_unset (&response);
+
+  props = gst_structure_new_empty ("application/x-unknown");
+  gst_rtsp_extension_parse_sdp (ext, sdp, props);
+  fail_unless (gst_structure_has_field (props, "config"));
+  fail_unless (gst_structure_has_field (props, "x-real-context"));
+  stream_caps = gst_caps_new_full (props, NULL);
+  gst_sdp_message_free (sdp);
+
+  fail_unless_equals_int (gst_rtsp_extension_stream_select (ext, url),
+      GST_RTSP_OK);
+
+  return real;
+}
+
+static void
+cleanup_rtspreal (GstElement * real)
+{
+  gst_object_unref (real);
+  gst_caps_replace (&stream_caps, NULL);
+
+  /* makes the server thread stop */
+  gst_rtsp_connection_free (client);
+  client = NULL;
+  stop_server ();
+}
+
+/* stands in for rtspsrc, the parent of rdtmanager, which queues the
+ * set-parameter requests and sends them from its own thread */
+typedef GstBin TestRTSPSrc;
+typedef GstBinClass TestRTSPSrcClass;
+
+GType test_rtsp_src_get_type (void);
+G_DEFINE_TYPE (TestRTSPSrc, test_rtsp_src, GST_TYPE_BIN);
+
+static gboolean
+test_rtsp_src_set_parameter (TestRTSPSrc * src, const gchar * name,
+    const gchar * value, const gchar * content_type, GstPromise * promise)
+{
+  g_async_queue_push (parameters, g_strdup_printf ("%s: %s\r\n", name,
+          value));
+
+  return TRUE;
+}
+
+static void
+test_rtsp_src_class_init (TestRTSPSrcClass * klass)
+{
+  g_signal_new_class_handler ("set-parameter", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (test_rtsp_src_set_parameter), NULL, NULL, NULL,
+      G_TYPE_BOOLEAN, 4, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+      GST_TYPE_PROMISE);
+}
+
+static void
+test_rtsp_src_init (TestRTSPSrc * src)
+{
+}
+
+static GstCaps *
+request_pt_map (GstElement * manager, guint session, guint pt,
+    gpointer user_data)
+{
+  return gst_caps_ref (stream_caps);
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static void
+pad_added (GstElement * manager, GstPad * pad, gpointer user_data)
+{
+  GstPad *sinkpad;
+
+  fail_unless (n_sinkpads < G_N_ELEMENTS (mysinkpads));
+
+  sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  mysinkpads[n_sinkpads++] = sinkpad;
+}
+
+/* rdtmanager with a session for each of @n_streams streams, in a stand-in
+ * for rtspsrc */
+static GstElement *
+setup_rdtmanager (guint n_streams)
+{
+  GstElement *src, *manager;
+  guint i;
+
+  parameters = g_async_queue_new_full (g_free);
+  src = g_object_new (test_rtsp_src_get_type (), NULL);
+  manager = gst_element_factory_make ("rdtmanager", NULL);
+  fail_unless (manager != NULL);
+  gst_bin_add (GST_BIN (src), manager);
+  g_signal_connect (manager, "request-pt-map", G_CALLBACK (request_pt_map),
+      NULL);
+  g_signal_connect (manager, "pad-added", G_CALLBACK (pad_added), NULL);
+
+  fail_unless (n_streams <= G_N_ELEMENTS (mysrcpads));
+  for (i = 0; i < n_streams; i++) {
+    GstPad *sinkpad;
+    gchar *name;
+
+    mysrcpads[i] = gst_pad_new_from_static_template (&srctemplate, "src");
+    name = g_strdup_printf ("recv_rtp_sink_%u", i);
+    sinkpad = gst_element_get_request_pad (manager, name);
+    g_free (name);
+    fail_unless (gst_pad_link (mysrcpads[i], sinkpad) == GST_PAD_LINK_OK);
+    gst_object_unref (sinkpad);
+    gst_pad_set_active (mysrcpads[i], TRUE);
+  }
+  n_srcpads = n_streams;
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE,
+      "could not set to playing");
+  for (i = 0; i < n_streams; i++)
+    gst_check_setup_events_with_stream_id (mysrcpads[i], manager,
+        stream_caps, GST_FORMAT_TIME, i == 0 ? "stream-0" : "stream-1");
+
+  return src;
+}
+
+static void
+cleanup_rdtmanager (GstElement * src)
+{
+  guint i;
+
+  gst_element_set_state (src, GST_STATE_NULL);
+
+  for (i = 0; i < n_sinkpads; i++) {
+    gst_pad_set_active (mysinkpads[i], FALSE);
+    gst_object_unref (mysinkpads[i]);
+    mysinkpads[i] = NULL;
+  }
+  n_sinkpads = 0;
+  for (i = 0; i < n_srcpads; i++) {
+    gst_pad_set_active (mysrcpads[i], FALSE);
+    gst_object_unref (mysrcpads[i]);
+    mysrcpads[i] = NULL;
+  }
+  n_srcpads = 0;
+  gst_object_unref (src);
+  g_async_queue_unref (parameters);
+  parameters = NULL;
+}
+
+/* pushes RDT data packets that arrive at @bitrate on every stream for
+ * @duration, starting at *@time */
+static void
+push_packets (guint bitrate, GstClockTime duration, GstClockTime * time,
+    guint16 * seq)
+{
+  GstClockTime interval, end = *time + duration;
+
+  interval = gst_util_uint64_scale (PACKET_SIZE, 8 * GST_SECOND, bitrate);
+
+  for (; *time < end; *time += interval) {
+    guint i;
+
+    for (i = 0; i < n_srcpads; i++) {
+      GstBuffer *buf;
+      GstMapInfo map;
+
+      buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+      gst_buffer_map (buf, &map, GST_MAP_WRITE);
+      memset (map.data, 0, map.size);
+      /* the stream and the length follows */
+      map.data[0] = 0x80 | (i << 1);
+      GST_WRITE_UINT16_BE (map.data + 1, *seq);
+      GST_WRITE_UINT16_BE (map.data + 3, PACKET_SIZE);
+      GST_WRITE_UINT32_BE (map.data + 6, GST_TIME_AS_MSECONDS (*time));
+      gst_buffer_unmap (buf, &map);
+      GST_BUFFER_PTS (buf) = *time;
+
+      fail_unless_equals_int (gst_pad_push (mysrcpads[i], buf), GST_FLOW_OK);
+    }
+    *seq = (*seq + 1) % 0xff00;
+  }
+}
+
+/* what rtspsrc does for the set-parameter requests of rdtmanager */
+static void
+send_parameters (GstRTSPExtension * ext)
+{
+  gchar *body;
+
+  while ((body = g_async_queue_try_pop (parameters))) {
+    GstRTSPMessage response = { 0 };
+
+    client_request (ext, GST_RTSP_SET_PARAMETER, body, &response);
+    gst_rtsp_message_unset (&response);
+    g_free (body);
+  }
+}
+
+GST_START_TEST (test_adaptive_rules)
+{
+  GstElement *real, *src;
+  GstClockTime time = 0;
+  guint16 seq = 0;
+
+  real = setup_rtspreal (SDP (OPAQUE_DATA));
+  check_server_log ("SET_PARAMETER stream=0;rule=5,stream=0;rule=6");
+
+  src = setup_rdtmanager (1);
+
+  /* the network can't do the 267959 bits/s of rules 5 and 6 */
+  push_packets (100000, 4 * GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log ("SET_PARAMETER stream=0;rule=1,stream=0;rule=2");
+  check_server_log (NULL);
+
+  /* it can now, the bandwidth is raised by half every 5 seconds, it takes
+   * two steps to get past 167959 */
+  push_packets (300000, 12 * GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log ("SET_PARAMETER stream=0;rule=3,stream=0;rule=4");
+  check_server_log (NULL);
+
+  cleanup_rdtmanager (src);
+  cleanup_rtspreal (real);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_not_adaptive)
+{
+  GstElement *real, *src;
+  GstClockTime time = 0;
+  guint16 seq = 0;
+
+  real = setup_rtspreal (SDP (OPAQUE_DATA));
+  check_server_log ("SET_PARAMETER stream=0;rule=5,stream=0;rule=6");
+  g_object_set (real, "adaptive", FALSE, NULL);
+
+  src = setup_rdtmanager (1);
+  push_packets (100000, 4 * GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log (NULL);
+
+  cleanup_rdtmanager (src);
+  cleanup_rtspreal (real);
+}
+
+GST_END_TEST;
+
+/* the decoder is set up for the codec of the rules we subscribed to first */
+GST_START_TEST (test_codec_switch)
+{
+  GstElement *real, *src;
+  GstClockTime time = 0;
+  guint16 seq = 0;
+
+  real = setup_rtspreal (SDP (MLTI_OPAQUE_DATA));
+  check_server_log ("SET_PARAMETER stream=0;rule=5,stream=0;rule=6");
+
+  src = setup_rdtmanager (1);
+
+  /* rules 1 and 2 would need codec 0 */
+  push_packets (100000, 4 * GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log (NULL);
+
+  /* rules 3 and 4 have codec 1 too */
+  push_packets (200000, 4 * GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log ("SET_PARAMETER stream=0;rule=3,stream=0;rule=4");
+  check_server_log (NULL);
+
+  cleanup_rdtmanager (src);
+  cleanup_rtspreal (real);
+}
+
+GST_END_TEST;
+
+/* the reports of all streams in an interval count once */
+GST_START_TEST (test_adaptive_two_streams)
+{
+  GstElement *real, *src;
+  GstClockTime time = 0;
+  guint16 seq = 0;
+
+  real = setup_rtspreal (SDP_HEADER ("2") SDP_MEDIA ("0", OPAQUE_DATA)
+      SDP_MEDIA ("1", OPAQUE_DATA));
+  check_server_log ("SET_PARAMETER stream=0;rule=5,stream=0;rule=6,"
+      "stream=1;rule=5,stream=1;rule=6");
+
+  src = setup_rdtmanager (2);
+
+  /* one bad interval is not enough */
+  push_packets (100000, 3 * GST_SECOND / 2, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log (NULL);
+
+  /* the second is, together the streams still get 167959 bits/s */
+  push_packets (100000, GST_SECOND, &time, &seq);
+  send_parameters (GST_RTSP_EXTENSION (real));
+  check_server_log ("SET_PARAMETER stream=0;rule=3,stream=0;rule=4,"
+      "stream=1;rule=3,stream=1;rule=4");
+  check_server_log (NULL);
+
+  cleanup_rdtmanager (src);
+  cleanup_rtspreal (real);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtspreal_suite (void)
+{
+  Suite *s = suite_create ("rtspreal");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_adaptive_rules);
+  tcase_add_test (tc_chain, test_not_adaptive);
+  tcase_add_test (tc_chain, test_codec_switch);
+  tcase_add_test (tc_chain, test_adaptive_two_streams);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtspreal);